@@ -0,0 +1,182 @@
+#include <chrono>
+#include <filesystem>
+#include <fsm/Builder.hpp>
+#include <fsm/ByteBuilder.hpp>
+#include <fsm/ParallelDriver.hpp>
+#include <fstream>
+#include <print>
+#include <random>
+#include <sstream>
+#include <string>
+
+/**
+ * Compares throughput of the regular fsm::Fsm ticked once per character
+ * (same machine as in examples/02-simple-fsm) with fsm::ByteFsm parsing
+ * the same generated CSV file, both on a single thread and split among
+ * all hardware threads with fsm::ParallelDriver.
+ *
+ * Usage: 01-csv-parsing [size in MB]
+ */
+
+struct CsvBlackboard : fsm::BlackboardBase
+{
+    std::string_view data;
+    size_t currentIdx = 0;
+    size_t wordStartIdx = 0;
+    size_t fieldCount = 0;
+    size_t fieldBytes = 0;
+};
+
+struct CsvByteBlackboard : fsm::ByteBlackboardBase
+{
+    size_t fieldCount = 0;
+    size_t fieldBytes = 0;
+};
+
+static std::filesystem::path generateCsvFile(size_t sizeInBytes)
+{
+    auto&& path = std::filesystem::temp_directory_path() / "fsm-bench.csv";
+    auto&& save = std::ofstream(path, std::ios::binary);
+
+    auto&& rng = std::mt19937(42);
+    auto&& wordLength = std::uniform_int_distribution<size_t>(1, 16);
+    auto&& letter = std::uniform_int_distribution<int>('a', 'z');
+
+    size_t written = 0;
+    while (written < sizeInBytes)
+    {
+        auto&& line = std::string {};
+        for (unsigned column = 0; column < 8; ++column)
+        {
+            if (column > 0) line += ',';
+            for (size_t i = wordLength(rng); i > 0; --i)
+                line += static_cast<char>(letter(rng));
+        }
+        line += '\n';
+
+        save << line;
+        written += line.size();
+    }
+
+    return path;
+}
+
+static std::string loadFile(const std::filesystem::path& path)
+{
+    auto&& load = std::ifstream(path, std::ios::binary);
+    auto&& buffer = std::stringstream();
+    buffer << load.rdbuf();
+    return buffer.str();
+}
+
+template<class Fn>
+static void measure(const char* name, size_t inputSize, Fn&& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto fieldCount = fn();
+    const auto duration = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start);
+
+    std::println(
+        "{:>8}: {:8.1f} MB/s ({} fields in {:.3f} s)",
+        name,
+        static_cast<double>(inputSize) / (1024.0 * 1024.0) / duration.count(),
+        fieldCount,
+        duration.count());
+}
+
+static size_t runRegularFsm(std::string_view data)
+{
+    auto&& isEof = [](const CsvBlackboard& bb)
+    { return bb.currentIdx >= bb.data.size(); };
+    auto&& isSeparator = [](const CsvBlackboard& bb)
+    { return bb.data[bb.currentIdx] == ','; };
+    auto&& isNewline = [](const CsvBlackboard& bb)
+    { return bb.data[bb.currentIdx] == '\n'; };
+    auto&& advanceChar = [](CsvBlackboard& bb) { ++bb.currentIdx; };
+    auto&& handleSeparator = [](CsvBlackboard& bb)
+    {
+        ++bb.fieldCount;
+        bb.fieldBytes += bb.currentIdx - bb.wordStartIdx;
+        ++bb.currentIdx;
+        bb.wordStartIdx = bb.currentIdx;
+    };
+
+    // clang-format off
+    auto&& machine = fsm::Builder<CsvBlackboard>()
+        .withErrorMachine()
+        .noGlobalEntryCondition()
+            .withEntryState("Start")
+                .exec(fsm::doNothing).andLoop()
+            .done()
+        .withMainMachine()
+            .withEntryState("Start")
+                .when(isEof).finish()
+                .orWhen(isSeparator).goToState("HandleSeparator")
+                .orWhen(isNewline).goToState("HandleSeparator")
+                .otherwiseExec(advanceChar).andLoop()
+            .withState("HandleSeparator")
+                .exec(handleSeparator).andGoToState("Start")
+            .done()
+        .build();
+    // clang-format on
+
+    auto&& blackboard = CsvBlackboard { .data = data };
+    while (!machine.isFinished(blackboard))
+        machine.tick(blackboard);
+
+    return blackboard.fieldCount;
+}
+
+static fsm::ByteFsm<CsvByteBlackboard> buildByteFsm()
+{
+    auto&& handleField = [](CsvByteBlackboard& bb, std::string_view field)
+    {
+        ++bb.fieldCount;
+        bb.fieldBytes += field.size();
+    };
+
+    // clang-format off
+    return fsm::ByteBuilder<CsvByteBlackboard>()
+        .withEntryState("Start")
+            .onAnyOf(",\n").exec(handleField).andLoop()
+            .otherwiseConsume()
+        .build();
+    // clang-format on
+}
+
+static size_t runByteFsm(std::string_view data)
+{
+    auto&& machine = buildByteFsm();
+    auto&& blackboard = CsvByteBlackboard {};
+    machine.process(blackboard, data);
+    machine.finish(blackboard);
+
+    return blackboard.fieldCount;
+}
+
+static size_t runParallelByteFsm(std::string_view data)
+{
+    auto&& machine = buildByteFsm();
+    auto&& driver = fsm::ParallelDriver(machine);
+    auto&& blackboards = driver.run(data, CsvByteBlackboard {});
+
+    size_t fieldCount = 0;
+    for (auto&& blackboard : blackboards)
+        fieldCount += blackboard.fieldCount;
+    return fieldCount;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t sizeInMb = argc > 1 ? std::stoul(argv[1]) : 64u;
+    const auto path = generateCsvFile(sizeInMb * 1024 * 1024);
+    const auto data = loadFile(path);
+    std::filesystem::remove(path);
+
+    std::println("Parsing {} bytes of CSV", data.size());
+    measure("Fsm", data.size(), [&] { return runRegularFsm(data); });
+    measure("ByteFsm", data.size(), [&] { return runByteFsm(data); });
+    measure(
+        "Parallel", data.size(), [&] { return runParallelByteFsm(data); });
+}
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <filesystem>
+#include <fsm/DefinitionLoader.hpp>
+#include <print>
+#include <string>
+
+/**
+ * Measures how long it takes to load a generated text definition
+ * with fsm::DefinitionLoader and to build the loaded machine, both
+ * from scratch and from the build cache.
+ *
+ * Usage: 02-definition-loading [number of states]
+ */
+
+struct Blackboard : fsm::BlackboardBase
+{
+    size_t counter = 0;
+};
+
+static constexpr size_t STATES_PER_MACHINE = 100;
+
+static std::string generateDefinition(size_t stateCount)
+{
+    auto&& definition = std::string {};
+    const auto machineCount =
+        (stateCount + STATES_PER_MACHINE - 1) / STATES_PER_MACHINE;
+
+    for (size_t machine = 0; machine < machineCount; ++machine)
+    {
+        definition += machine + 1 == machineCount
+                          ? std::string("main\n")
+                          : std::format("machine M{}\n", machine);
+
+        for (size_t state = 0; state < STATES_PER_MACHINE; ++state)
+        {
+            const auto next = (state + 1) % STATES_PER_MACHINE;
+            definition += std::format("    state S{}\n", state);
+            definition += std::format(
+                "        when isOdd 0x1 -> state S{}\n", next);
+            if (machine > 0 && state == 0)
+                definition += std::format(
+                    "        when isOdd -> machine M{} then S{}\n",
+                    machine - 1,
+                    next);
+            definition +=
+                std::format("        exec count -> state S{}\n", next);
+        }
+    }
+
+    return definition;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t stateCount = argc > 1 ? std::stoul(argv[1]) : 10'000u;
+    const auto definition = generateDefinition(stateCount);
+
+    auto&& registry = fsm::CallableRegistry<Blackboard>();
+    registry
+        .addCondition(
+            "isOdd", [](const Blackboard& bb) { return bb.counter % 2 == 1; })
+        .addAction("count", [](Blackboard& bb) { ++bb.counter; });
+
+    std::println(
+        "Loading {} states from {} bytes of definition",
+        stateCount,
+        definition.size());
+
+    const auto cacheDirectory =
+        std::filesystem::temp_directory_path() / "fsm-definition-benchmark";
+    std::filesystem::remove_all(cacheDirectory);
+
+    constexpr size_t REPEATS = 5;
+    double loadTime = 0.0;
+    double buildTime = 0.0;
+    double cachedBuildTime = 0.0;
+    for (size_t i = 0; i < REPEATS; ++i)
+    {
+        auto&& start = std::chrono::steady_clock::now();
+        auto&& builder =
+            fsm::DefinitionLoader<Blackboard>::load(definition, registry);
+        auto&& loaded = std::chrono::steady_clock::now();
+        auto&& machine = builder.build();
+        auto&& built = std::chrono::steady_clock::now();
+
+        // The first iteration fills the cache
+        auto&& cachedBuilder =
+            fsm::DefinitionLoader<Blackboard>::load(definition, registry);
+        auto&& cachedStart = std::chrono::steady_clock::now();
+        std::ignore =
+            cachedBuilder.withBuildCache(cacheDirectory, registry).build();
+        auto&& cachedBuilt = std::chrono::steady_clock::now();
+        if (i > 0)
+            cachedBuildTime += std::chrono::duration<double, std::milli>(
+                                   cachedBuilt - cachedStart)
+                                   .count();
+
+        auto&& blackboard = Blackboard {};
+        machine.tick(blackboard);
+
+        loadTime +=
+            std::chrono::duration<double, std::milli>(loaded - start).count();
+        buildTime +=
+            std::chrono::duration<double, std::milli>(built - loaded).count();
+    }
+
+    std::println("    Load: {:8.2f} ms", loadTime / REPEATS);
+    std::println("   Build: {:8.2f} ms", buildTime / REPEATS);
+    std::println("  Cached: {:8.2f} ms", cachedBuildTime / (REPEATS - 1));
+
+    std::filesystem::remove_all(cacheDirectory);
+}
@@ -0,0 +1,59 @@
+#include <fsm/ByteBuilder.hpp>
+#include <fsm/StreamDriver.hpp>
+#include <sstream>
+#include <print>
+
+struct CsvByteBlackboard : fsm::ByteBlackboardBase
+{
+    size_t lineCount = 0;
+};
+
+void handleWord(CsvByteBlackboard&, std::string_view word)
+{
+    std::println("Word: {}", word);
+}
+
+void handleLastWord(CsvByteBlackboard& bb, std::string_view word)
+{
+    handleWord(bb, word);
+    std::println("==Next line==");
+    ++bb.lineCount;
+}
+
+int main()
+{
+    // Each byte of the input is one transition of the machine. Bytes
+    // without any action (regular characters of a word) are collected
+    // into a token that is passed to the next action.
+    // clang-format off
+    auto&& machine = fsm::ByteBuilder<CsvByteBlackboard>()
+        .withEntryState("Start")
+            .on(',').exec(handleWord).andLoop()
+            .on('\n').exec(handleLastWord).andLoop()
+            .on('"').error() // Quotes are not supported
+            .otherwiseConsume()
+        .build();
+    // clang-format on
+
+    auto&& runMachine = [&machine](const std::string& data)
+    {
+        auto&& blackboard = CsvByteBlackboard {};
+
+        // Input is read in chunks, so it does not have to fit into memory.
+        // Any std::istream or file descriptor can be used as the source.
+        auto&& stream = std::istringstream(data);
+        auto&& driver = fsm::StreamDriver(machine, 8u);
+        driver.run(blackboard, stream);
+
+        std::println(
+            "ByteFsm\n  lines: {}\n  errored: {}\n",
+            blackboard.lineCount,
+            machine.isErrored(blackboard));
+    };
+
+    // This one should succeed
+    runMachine("abc,bcd,cde\nabc,bcd,cde\n");
+
+    // This one should fail
+    runMachine("abc,bcd,cde\nabc,\"b\"");
+}
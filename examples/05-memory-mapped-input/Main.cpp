@@ -0,0 +1,67 @@
+#include <CsvBlackboard.hpp>
+#include <CsvFunctions.hpp>
+#include <filesystem>
+#include <fsm/Builder.hpp>
+#include <fsm/MappedFile.hpp>
+#include <fstream>
+#include <print>
+
+int main()
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "fsm-example-input.csv";
+    {
+        auto&& save = std::ofstream(path, std::ios::binary);
+        save << "abc,bcd,cde\nabc,bcd,cde\n";
+    }
+
+    // clang-format off
+    auto&& machine = fsm::Builder<CsvBlackboard>()
+        .withErrorMachine()
+        .noGlobalEntryCondition()
+            .withEntryState("Start")
+                .exec(fsm::doNothing).andLoop()
+            .done()
+        .withMainMachine()
+            .withEntryState("Start")
+                .when(isEof).error()
+                .orWhen(isSeparator).goToState("HandleSeparator")
+                .orWhen(isNewline).goToState("HandleNewline")
+                .otherwiseExec(advanceChar).andLoop()
+            .withState("HandleSeparator")
+                .exec(handleSeparator).andGoToState("Start")
+            .withState("HandleNewline")
+                .exec([] (CsvBlackboard& bb) {
+                        handleSeparator(bb);
+                        handleNewline(bb);
+                    }).andGoToState("PostNewline")
+            .withState("PostNewline")
+                .when(isEof).finish()
+                .otherwiseExec(fsm::doNothing).andGoToState("Start")
+            .done()
+        .build();
+    // clang-format on
+
+    {
+        // The blackboard only views the mapped file, its contents
+        // are never copied
+        auto&& file = fsm::MappedFile(path);
+        const auto data = file.getData();
+        auto&& blackboard = CsvBlackboard {
+            .data = std::string_view(data.data(), data.size()),
+        };
+
+        while (!machine.isErrored(blackboard)
+               && !machine.isFinished(blackboard))
+        {
+            machine.tick(blackboard);
+        }
+
+        std::println(
+            "Fsm\n  finished: {}\n  errored: {}\n",
+            machine.isFinished(blackboard),
+            machine.isErrored(blackboard));
+    }
+
+    std::filesystem::remove(path);
+}
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <fsm/Types.hpp>
+#include <string_view>
 
 struct CsvBlackboard : fsm::BlackboardBase
 {
-    std::string data;
+    // Non-owning view of the input, for example of a fsm::MappedFile
+    std::string_view data;
     size_t currentIdx = 0;
     size_t wordStartIdx = 0;
 };
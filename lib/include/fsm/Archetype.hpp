@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cassert>
+#include <fsm/Error.hpp>
+#include <fsm/TickContext.hpp>
+#include <functional>
+#include <utility>
+
+namespace fsm
+{
+    /**
+     * \brief Constants shared by all agents of one kind
+     *
+     * Conditions and actions wrapped by fsm::withParams read the params
+     * of the archetype passed to the tick, like any other tick context.
+     * A single model thus serves any number of parameter sets while each
+     * set is stored only once and blackboards don't refer to it at all.
+     * Agents of one archetype are ticked together, possibly alongside
+     * other contexts.
+     *
+     * \code
+     * auto&& goblin = fsm::Archetype(MonsterParams { .aggroRange = 5 });
+     * auto&& troll = fsm::Archetype(MonsterParams { .aggroRange = 12 });
+     * machine.tickAll(goblins, world, goblin);
+     * machine.tickAll(trolls, world, troll);
+     * \endcode
+     */
+    template<class ParamsT>
+    class [[nodiscard]] Archetype final
+    {
+    public:
+        explicit Archetype(ParamsT params) : params(std::move(params)) {}
+
+        Archetype(Archetype&&) = default;
+        Archetype(const Archetype&) = delete;
+
+    public:
+        [[nodiscard]] constexpr const ParamsT& getParams() const noexcept
+        {
+            return params;
+        }
+
+    private:
+        ParamsT params;
+    };
+
+    namespace detail
+    {
+        template<class ParamsT>
+        void checkArchetype()
+        {
+            if (!currentTickContext<Archetype<ParamsT>>) [[unlikely]]
+                throw Error(
+                    "Tick was not passed the archetype required by a "
+                    "condition or action adapted by fsm::withParams");
+        }
+    } // namespace detail
+
+    /**
+     * \brief Params of the archetype passed to the tick that is
+     * currently running
+     *
+     * \throws fsm::Error if the running tick was not passed
+     * an fsm::Archetype<ParamsT>
+     */
+    template<class ParamsT>
+    [[nodiscard]] const ParamsT& getParams()
+    {
+        detail::checkArchetype<ParamsT>();
+        return detail::currentTickContext<Archetype<ParamsT>>->getParams();
+    }
+
+    namespace detail
+    {
+        // Checked once per tick like ContextBinding
+        template<class ParamsT, class Callable>
+        struct [[nodiscard]] ParamsBinding final
+        {
+            Callable callable;
+
+            template<class BbT>
+            auto operator()(BbT& blackboard) const -> decltype(std::invoke(
+                std::declval<const Callable&>(),
+                blackboard,
+                std::declval<const ParamsT&>()))
+            {
+                assert(currentTickContext<Archetype<ParamsT>>);
+                return std::invoke(
+                    callable,
+                    blackboard,
+                    currentTickContext<Archetype<ParamsT>>->getParams());
+            }
+
+            [[nodiscard]] static constexpr auto getContextCheck() noexcept
+            {
+                return &checkArchetype<ParamsT>;
+            }
+        };
+    } // namespace detail
+
+    /**
+     * \brief Adapt a condition taking (const BbT&, const ParamsT&) or an
+     * action taking (BbT&, const ParamsT&) for fsm::Builder
+     *
+     * The params are taken from the archetype passed to the tick,
+     * \see Archetype.
+     *
+     * \code
+     * .when(fsm::withParams<MonsterParams>(
+     *     [](const Blackboard& bb, const MonsterParams& params)
+     *     { return bb.playerDistance < params.aggroRange; }))
+     * \endcode
+     */
+    template<class ParamsT, class Callable>
+    [[nodiscard]] constexpr auto withParams(Callable&& callable)
+    {
+        return detail::ParamsBinding<ParamsT, std::decay_t<Callable>> {
+            std::forward<Callable>(callable)
+        };
+    }
+} // namespace fsm
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <fsm/detail/FramePool.hpp>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace fsm
+{
+    namespace detail
+    {
+        /**
+         * Time of the running tick, the clock is read at most once
+         * and only if a suspended behavior sleeps
+         */
+        class [[nodiscard]] TickClock final
+        {
+        public:
+            TickClock() noexcept = default;
+
+            explicit TickClock(
+                std::chrono::steady_clock::time_point now) noexcept
+                : cached(now)
+            {
+            }
+
+            TickClock(const TickClock&) = delete;
+
+        public:
+            [[nodiscard]] std::chrono::steady_clock::time_point now() const
+            {
+                if (!cached) cached = std::chrono::steady_clock::now();
+                return *cached;
+            }
+
+        private:
+            mutable std::optional<std::chrono::steady_clock::time_point> cached;
+        };
+
+        /**
+         * Event a suspended async behavior waits for
+         */
+        struct [[nodiscard]] AsyncWait final
+        {
+            enum class Kind
+            {
+                NextTick,
+                Deadline,
+                Predicate,
+            };
+
+            Kind kind = Kind::NextTick;
+            std::chrono::steady_clock::time_point deadline = {};
+            std::function<bool()> predicate;
+
+            // Fields the predicate reads (\see fsm::FieldMask), zero if
+            // the predicate is polled by every tick
+            std::uint64_t dependencies = 0;
+
+            [[nodiscard]] bool isOver(const TickClock& clock) const
+            {
+                switch (kind)
+                {
+                    using enum Kind;
+                case NextTick:
+                    return true;
+                case Deadline:
+                    return clock.now() >= deadline;
+                case Predicate:
+                    return predicate();
+                }
+                return true;
+            }
+        };
+    } // namespace detail
+
+    /**
+     * \brief Return type of coroutines used as state behaviors
+     *
+     * Such coroutine is started when its state executes the behavior
+     * and it is resumed by subsequent ticks until it returns. Only then
+     * is the default transition of the state taken. While the coroutine
+     * waits for fsm::nextTick, fsm::sleepFor or fsm::until, ticking the
+     * blackboard does nothing else than checking whether the wait is over
+     * and evaluating the global error condition and interrupts, which
+     * can preempt the wait.
+     *
+     * \see StateBuilderBeforePickingAnything::execAsync
+     */
+    class [[nodiscard]] AsyncBehavior final
+    {
+    public:
+        struct promise_type
+        {
+            [[nodiscard]] AsyncBehavior get_return_object() noexcept
+            {
+                return AsyncBehavior(Handle::from_promise(*this));
+            }
+
+            // Runs synchronously until the first co_await
+            std::suspend_never initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            std::suspend_always final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() noexcept
+            {
+                exception = std::current_exception();
+            }
+
+            [[nodiscard]] static void* operator new(size_t size)
+            {
+                return detail::FramePool::allocate(size);
+            }
+
+            static void operator delete(void* frame, size_t size) noexcept
+            {
+                detail::FramePool::deallocate(frame, size);
+            }
+
+            detail::AsyncWait wait;
+            std::exception_ptr exception;
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+    public:
+        AsyncBehavior() noexcept = default;
+
+        explicit AsyncBehavior(Handle handle) noexcept : handle(handle) {}
+
+        AsyncBehavior(AsyncBehavior&& other) noexcept
+            : handle(std::exchange(other.handle, {}))
+        {
+        }
+
+        AsyncBehavior(const AsyncBehavior&) = delete;
+
+        AsyncBehavior& operator=(AsyncBehavior&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+
+        AsyncBehavior& operator=(const AsyncBehavior&) = delete;
+
+        ~AsyncBehavior()
+        {
+            reset();
+        }
+
+    public:
+        /**
+         * Whether the coroutine was started and has not returned yet
+         */
+        [[nodiscard]] bool isRunning() const noexcept
+        {
+            return handle && !handle.done();
+        }
+
+        /**
+         * Whether the coroutine is suspended and the awaited
+         * event has not happened yet
+         */
+        [[nodiscard]] bool isWaiting(const detail::TickClock& clock) const
+        {
+            return isRunning() && !handle.promise().wait.isOver(clock);
+        }
+
+        /**
+         * Fields the awaited predicate depends on, zero unless
+         * the coroutine waits for fsm::until with dependencies
+         */
+        [[nodiscard]] std::uint64_t getWaitedFields() const noexcept
+        {
+            return isRunning() ? handle.promise().wait.dependencies : 0;
+        }
+
+        void resume()
+        {
+            handle.resume();
+        }
+
+        /**
+         * Destroy the coroutine frame. If the coroutine ended with
+         * an exception, it is rethrown.
+         */
+        void finish()
+        {
+            auto&& exception =
+                handle ? handle.promise().exception : std::exception_ptr {};
+            reset();
+            if (exception) std::rethrow_exception(exception);
+        }
+
+        void reset() noexcept
+        {
+            if (handle) std::exchange(handle, {}).destroy();
+        }
+
+    private:
+        Handle handle = {};
+    };
+
+    namespace detail
+    {
+        struct [[nodiscard]] WaitAwaiter final
+        {
+            AsyncWait wait;
+
+            [[nodiscard]] bool await_ready() const
+            {
+                return wait.kind != AsyncWait::Kind::NextTick
+                       && wait.isOver(TickClock());
+            }
+
+            void await_suspend(AsyncBehavior::Handle handle)
+            {
+                handle.promise().wait = std::move(wait);
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        /**
+         * Async behavior stored in the blackboard
+         *
+         * The coroutine refers to the blackboard it was started with,
+         * so it cannot follow the blackboard anywhere. Blackboards with
+         * this slot cannot be copied. Moving one, including by reallocation
+         * of a std::vector, does not carry the behavior over, the state
+         * restarts it the next time the moved-to blackboard is ticked.
+         * Reserve containers of agents up front to keep behaviors running.
+         */
+        class [[nodiscard]] AsyncBehaviorSlot final
+        {
+        public:
+            AsyncBehaviorSlot() noexcept = default;
+
+            AsyncBehaviorSlot(AsyncBehaviorSlot&&) noexcept {}
+
+            AsyncBehaviorSlot(const AsyncBehaviorSlot&) = delete;
+
+            AsyncBehaviorSlot& operator=(AsyncBehaviorSlot&&) noexcept
+            {
+                behavior.reset();
+                return *this;
+            }
+
+            AsyncBehaviorSlot& operator=(const AsyncBehaviorSlot&) = delete;
+
+        public:
+            AsyncBehavior behavior;
+        };
+
+        /**
+         * Trivial stand-in for AsyncBehavior in blackboards that
+         * cannot run async behaviors, \see PackedBlackboardBase
+         */
+        struct [[nodiscard]] NoAsyncBehavior final
+        {
+            [[nodiscard]] constexpr bool isRunning() const noexcept
+            {
+                return false;
+            }
+
+            [[nodiscard]] constexpr bool
+            isWaiting(const TickClock&) const noexcept
+            {
+                return false;
+            }
+
+            [[nodiscard]] constexpr std::uint64_t
+            getWaitedFields() const noexcept
+            {
+                return 0;
+            }
+
+            constexpr void resume() const noexcept {}
+
+            constexpr void finish() const noexcept {}
+
+            constexpr void reset() const noexcept {}
+
+            NoAsyncBehavior& operator=(AsyncBehavior&&) noexcept
+            {
+                // FinalBuilder::build rejects such machines
+                assert(false);
+                return *this;
+            }
+        };
+
+        struct [[nodiscard]] NoAsyncBehaviorSlot final
+        {
+            NoAsyncBehavior behavior;
+        };
+    } // namespace detail
+
+    /**
+     * Suspend the async behavior until the next tick
+     */
+    [[nodiscard]] inline detail::WaitAwaiter nextTick()
+    {
+        return detail::WaitAwaiter {};
+    }
+
+    /**
+     * Suspend the async behavior until the duration elapses. The behavior
+     * is resumed by the first tick after that. Ticks of a batch
+     * (\see Fsm::tickAll) compare the deadline with the time
+     * the batch started.
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] detail::WaitAwaiter
+    sleepFor(std::chrono::duration<Rep, Period> duration)
+    {
+        return detail::WaitAwaiter {
+            .wait = {
+                .kind = detail::AsyncWait::Kind::Deadline,
+                .deadline =
+                    std::chrono::steady_clock::now()
+                    + std::chrono::ceil<std::chrono::steady_clock::duration>(
+                        duration),
+            },
+        };
+    }
+
+    /**
+     * Suspend the async behavior until the predicate is true. The predicate
+     * is evaluated by each tick, the behavior is resumed by the first tick
+     * that sees it true. Does not suspend if the predicate is already true.
+     */
+    [[nodiscard]] inline detail::WaitAwaiter
+    until(std::function<bool()> predicate)
+    {
+        return detail::WaitAwaiter {
+            .wait = {
+                .kind = detail::AsyncWait::Kind::Predicate,
+                .predicate = std::move(predicate),
+            },
+        };
+    }
+
+    /**
+     * Suspend the async behavior until the predicate is true. Unlike
+     * the overload without dependencies, the agent is parked and the
+     * predicate is only re-evaluated after one of its dependencies
+     * is marked dirty (\see markDirty). Blackboards not deriving from
+     * TrackedBlackboard evaluate it on every tick.
+     *
+     * \param dependencies Fields the predicate reads, \see FieldMask
+     */
+    [[nodiscard]] inline detail::WaitAwaiter
+    until(std::function<bool()> predicate, std::uint64_t dependencies)
+    {
+        return detail::WaitAwaiter {
+            .wait = {
+                .kind = detail::AsyncWait::Kind::Predicate,
+                .predicate = std::move(predicate),
+                .dependencies = dependencies,
+            },
+        };
+    }
+} // namespace fsm
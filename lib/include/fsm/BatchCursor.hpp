@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+namespace fsm
+{
+    /**
+     * \brief Resumable position within a batch of blackboards
+     *
+     * Used by fsm::Fsm::tickWithBudget. Keep one cursor per batch and
+     * pass it into every call. Each call resumes with the blackboard
+     * that was not ticked by the previous call, so the blackboards
+     * are served in round-robin order even when the budget only allows
+     * ticking a part of the batch each frame.
+     */
+    struct [[nodiscard]] BatchCursor
+    {
+        // Index of the blackboard that will be ticked next
+        size_t nextIdx = 0;
+
+        // Number of ticks between two reads of the clock. The budget
+        // can be exceeded by at most this many ticks.
+        size_t clockCheckInterval = 32;
+
+        // Number of ticks performed by each call even when the budget
+        // is already depleted. Guarantees that every blackboard is ticked
+        // at least once per ceil(batch size / minTicksPerCall) calls.
+        size_t minTicksPerCall = 1;
+
+        // Incremented each time the cursor wraps around the batch
+        size_t completedPasses = 0;
+    };
+} // namespace fsm
@@ -1,13 +1,28 @@
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <fsm/CallableRegistry.hpp>
+#include <fsm/CompiledSubmachine.hpp>
 #include <fsm/Error.hpp>
 #include <fsm/Fsm.hpp>
+#include <fsm/OptimizationReport.hpp>
+#include <fsm/Profile.hpp>
 #include <fsm/Types.hpp>
+#include <fsm/detail/Analyzer.hpp>
+#include <fsm/detail/BuildCache.hpp>
 #include <fsm/detail/BuilderContext.hpp>
 #include <fsm/detail/BuilderContextHelper.hpp>
 #include <fsm/detail/Constants.hpp>
+#include <fsm/detail/Fingerprint.hpp>
 #include <fsm/detail/Helper.hpp>
+#include <fsm/detail/Layout.hpp>
+#include <fsm/detail/ModelSerializer.hpp>
+#include <fsm/detail/Optimizer.hpp>
 #include <fsm/exports/ExporterConcept.hpp>
+#include <optional>
+#include <sstream>
 
 namespace fsm::detail
 {
@@ -20,6 +35,18 @@ namespace fsm::detail
     template<BlackboardTypeConcept BbT>
     class MainBuilder;
 
+    template<BlackboardTypeConcept BbT, bool IsSubmachine, bool IsErrorMachine>
+    class StateBuilderBeforePickingAnything;
+
+    template<BlackboardTypeConcept BbT, bool IsSubmachine, bool IsErrorMachine>
+    class MachineBuilderPreEntryPoint;
+
+    template<BlackboardTypeConcept BbT>
+    class GlobalInterruptBuilder;
+
+    template<BlackboardTypeConcept BbT>
+    class GlobalInterruptBackTransitionBuilder;
+
     template<BlackboardTypeConcept BbT>
     class [[nodiscard]] FinalBuilder final
     {
@@ -44,24 +71,242 @@ namespace fsm::detail
             return *this;
         }
 
+        /**
+         * Enable the 'run to behavior' mode. In this mode, a single
+         * fsm::Fsm::tick keeps following conditional transitions until
+         * it executes a behavior, the machine finishes, or stepLimit
+         * transitions were taken.
+         *
+         * build() will throw if there is a cycle consisting only of
+         * conditional transitions, since such cycle could be followed
+         * without ever executing a behavior.
+         */
+        auto& runToBehavior(size_t stepLimit = 16)
+        {
+            if (stepLimit == 0)
+                throw Error("Step limit for runToBehavior must be positive");
+
+            context.microstepLimit = stepLimit;
+            return *this;
+        }
+
+        /**
+         * Simplify the FSM graph before it is compiled. States that can
+         * never be entered are removed, states that only pass the control
+         * flow further (no conditions, fsm::doNothing behavior and
+         * a transition to another state of the same machine) are collapsed
+         * and identical states within a machine are merged.
+         *
+         * States can only be recognized as identical if all their callables
+         * are plain function pointers or fsm::doNothing.
+         */
+        auto& optimize()
+        {
+            optimizationEnabled = true;
+            return *this;
+        }
+
+        /**
+         * Same as optimize(), but the list of removed and merged states
+         * is stored into the report during build().
+         */
+        auto& optimize(OptimizationReport& report)
+        {
+            optimizationReport = &report;
+            return optimize();
+        }
+
+        /**
+         * Lay out the compiled states according to runtime statistics
+         * collected by fsm::ProfilingLogger. States that are often ticked
+         * one after another end up next to each other in memory and
+         * the most ticked states are placed first.
+         *
+         * Conditions of states marked with withMutuallyExclusiveConditions
+         * are reordered so the most often hit condition is evaluated first.
+         *
+         * Neither change alters the behavior of the FSM. Logs still report
+         * conditions by their declaration index.
+         */
+        auto& withProfile(const Profile& runtimeProfile)
+        {
+            profile = runtimeProfile;
+            return *this;
+        }
+
+        /**
+         * Keep compiled models in a directory, keyed by the fingerprint
+         * of everything declared through the builder (machines, states,
+         * transitions, names of conditions and actions) and the build
+         * options. When the directory has a model with the same
+         * fingerprint, build() loads it instead of indexing and compiling
+         * the states. Otherwise the compiled model is saved there.
+         *
+         * All conditions and actions must be taken from the registry,
+         * which also binds the names of a loaded model. The optimization
+         * report (\see optimize) is not filled when the model is loaded.
+         *
+         * \throws fsm::Error from build() if the machine has a callable
+         * that is not taken from the registry, an async behavior, a switch
+         * or a world interrupt
+         */
+        auto& withBuildCache(
+            const std::filesystem::path& directory,
+            const CallableRegistry<BbT>& callableRegistry)
+        {
+            buildCache.emplace(directory);
+            registry = &callableRegistry;
+            return *this;
+        }
+
+        /**
+         * Declare a global interrupt. Global interrupts are evaluated
+         * in declaration order on each tick, after the global error
+         * condition and before anything else. A hit interrupt abandons
+         * the whole state stack and enters a submachine.
+         *
+         * While the agent is inside the submachine of an interrupt,
+         * neither that interrupt nor interrupts declared after it are
+         * evaluated. No interrupt is evaluated in the error machine.
+         */
+        auto withGlobalInterrupt(ConditionConcept<BbT> auto&& condition)
+        {
+            return GlobalInterruptBuilder<BbT>(
+                *this,
+                context,
+                GlobalInterruptContext<BbT> {
+                    .condition = std::move(condition),
+                });
+        }
+
+        /**
+         * Declare a global interrupt whose condition does not depend
+         * on the blackboard. fsm::Fsm::tickAll and fsm::Fsm::tickWithBudget
+         * evaluate such condition only once per batch and when no world
+         * interrupt is hit and there are no other global interrupts, agents
+         * of the batch skip the interrupt checks entirely.
+         *
+         * \see withGlobalInterrupt
+         */
+        auto withWorldInterrupt(WorldConditionConcept auto&& condition)
+        {
+            return GlobalInterruptBuilder<BbT>(
+                *this,
+                context,
+                GlobalInterruptContext<BbT> {
+                    .worldCondition = std::move(condition),
+                });
+        }
+
         /**
          * Construct the FSM model from builder definitions.
          */
         Fsm<BbT> build()
+        {
+            prepareStates();
+            if constexpr (PackedBlackboardTypeConcept<BbT>)
+                throwOnUnpackableMachine();
+
+            const auto fingerprint =
+                buildCache ? computeFingerprint() : std::uint64_t {};
+            if (buildCache)
+            {
+                if (auto&& model = loadCachedModel(fingerprint))
+                    return Fsm<BbT>(std::move(*model));
+            }
+
+            transformStates();
+
+            if (context.microstepLimit > 1)
+                throwOnConditionOnlyCycle();
+
+            auto&& index = createIndex();
+            detail::appendSharedMachinesToIndex(index, context);
+            if (!buildCache) return Fsm(index, std::move(context));
+
+            auto&& model = Compiler::compileModel(context, index);
+            buildCache->store(fingerprint, ModelSerializer::save(model));
+            return Fsm<BbT>(std::move(model));
+        }
+
+        /**
+         * Compile the main machine into a submachine that can be linked
+         * into other FSMs (\see MainBuilder::withSharedSubmachine).
+         * Options optimize() and withProfile() apply to it as well,
+         * restart() re-enters the submachine.
+         *
+         * \throws fsm::Error if the builder declares other machines
+         * than the main one
+         */
+        [[nodiscard]] std::shared_ptr<const CompiledSubmachine<BbT>>
+        buildSubmachine()
+        {
+            if (context.machines.size() != 1u)
+                throw Error(
+                    "Shared submachine must be built from a builder with "
+                    "only the main machine and no error machine");
+
+            prepareStates();
+            transformStates();
+
+            // Copied before the compilation moves the callables out
+            auto&& definition = MachineBuilderContext<BbT>(
+                context.machines.at(MAIN_MACHINE_NAME));
+            auto&& index = createIndex();
+            auto&& model = Compiler::compileModel(context, index);
+
+            auto&& stateNames =
+                *model.stateIdToName
+                | std::views::transform(
+                    [](const std::string& fullName) {
+                        return getMachineAndStateNameFromFullName(fullName)
+                            .second;
+                    })
+                | std::ranges::to<std::vector>();
+
+            return std::make_shared<const CompiledSubmachine<BbT>>(
+                std::move(definition),
+                std::move(stateNames),
+                std::move(model.states),
+                std::move(model.stateExtras),
+                std::move(model.machineInterrupts.front()));
+        }
+
+    private:
+        void prepareStates()
         {
             for (auto&& [_, machineContext] : context.machines)
             {
                 for (auto&& [__, stateContext] : machineContext.states)
                 {
                     replacePlaceholderTransitionsWithCorrectOnes(stateContext);
+                    numberConditionsInDeclarationOrder(stateContext);
                 }
             }
+        }
+
+        void transformStates()
+        {
+            if (optimizationEnabled)
+            {
+                auto&& report = Optimizer::optimize(context);
+                if (optimizationReport) *optimizationReport = std::move(report);
+            }
 
-            auto&& index = detail::createStateIndexFromBuilderContext(context);
-            return Fsm(index, std::move(context));
+            if (profile) detail::reorderExclusiveConditions(context, *profile);
+        }
+
+        [[nodiscard]] StateIndex createIndex() const
+        {
+            return profile ? detail::reorderStateIndexByProfile(
+                                 detail::createStateIndexFromBuilderContext(
+                                     context),
+                                 detail::getErrorStatesCount(context),
+                                 *profile)
+                           : detail::createStateIndexFromBuilderContext(
+                                 context);
         }
 
-    private:
         void replacePlaceholderTransitionsWithCorrectOnes(
             StateBuilderContext<BbT>& state)
         {
@@ -77,6 +322,124 @@ namespace fsm::detail
                     state.destination);
         }
 
+        [[nodiscard]] std::uint64_t computeFingerprint() const
+        {
+            auto&& fingerprint = Fingerprint();
+            if (!fingerprint.addContext(context))
+                throw Error(
+                    "Build cache can only be used when all conditions and "
+                    "actions are taken from fsm::CallableRegistry and there "
+                    "are no async behaviors, switches, world interrupts "
+                    "or shared submachines");
+
+            fingerprint.addU64(ModelSerializer::VERSION);
+            fingerprint.addU64(optimizationEnabled);
+            if (profile)
+            {
+                auto&& profileText = std::ostringstream();
+                profile->save(profileText);
+                fingerprint.addString(profileText.str());
+            }
+
+            return fingerprint.getValue();
+        }
+
+        /**
+         * \return Model from the cache, nothing if there is no entry
+         * or the entry cannot be loaded for any reason
+         */
+        [[nodiscard]] std::optional<CompiledModel<BbT>>
+        loadCachedModel(std::uint64_t fingerprint) const
+        {
+            auto&& file = buildCache->find(fingerprint);
+            if (!file) return std::nullopt;
+
+            try
+            {
+                return ModelSerializer::load(file->getData(), *registry);
+            }
+            catch (const std::exception&)
+            {
+                // Broken entry is rebuilt and overwritten
+                return std::nullopt;
+            }
+        }
+
+        static void
+        numberConditionsInDeclarationOrder(StateBuilderContext<BbT>& state)
+        {
+            for (size_t idx = 0; idx < state.conditions.size(); ++idx)
+                state.conditions[idx].declarationIdx = idx;
+        }
+
+        void throwOnConditionOnlyCycle() const
+        {
+            auto&& cycle = Analyzer::findConditionOnlyCycle(context);
+            if (cycle.empty()) return;
+
+            auto&& cycleLog = std::string {};
+            for (auto&& stateName : cycle)
+                cycleLog += std::format("{} -> ", stateName);
+            cycleLog += cycle.front();
+
+            throw Error(std::format(
+                "Conditional transitions form a cycle that would never "
+                "execute a behavior: {}",
+                cycleLog));
+        }
+
+        /**
+         * State stack of fsm::PackedBlackboardBase has a fixed capacity
+         * given by its index width and cannot hold async behaviors
+         */
+        void throwOnUnpackableMachine() const
+        {
+            using PackedStateStack = typename BbT::PackedStateStack;
+
+            auto&& depth = Analyzer::getMaxStackDepth(context);
+            if (!depth || *depth > PackedStateStack::CAPACITY)
+                throw Error(std::format(
+                    "Packed blackboard with {}-bit indices can hold at most "
+                    "{} nested states, but the machine can nest {}",
+                    PackedStateStack::INDEX_BITS,
+                    PackedStateStack::CAPACITY,
+                    depth ? std::to_string(*depth) : "indefinitely"));
+
+            size_t stateCount = 0;
+            for (auto&& [machineName, machineContext] : context.machines)
+            {
+                stateCount += machineContext.states.size();
+                for (auto&& [stateName, stateContext] : machineContext.states)
+                {
+                    if (stateContext.asyncAction)
+                        throw Error(std::format(
+                            "State {} has an async behavior, it cannot be "
+                            "used with a packed blackboard",
+                            createFullStateName(machineName, stateName)));
+                }
+            }
+
+            for (auto&& [machineName, submachine] : context.sharedMachines)
+            {
+                if (std::ranges::any_of(
+                        submachine->getStateExtras(),
+                        [](const CompiledStateExtras<BbT>& extras)
+                        { return extras.startAsyncBehavior != nullptr; }))
+                    throw Error(std::format(
+                        "Shared submachine {} has an async behavior, it "
+                        "cannot be used with a packed blackboard",
+                        machineName));
+            }
+
+            if (stateCount > PackedStateStack::MAX_INDEX)
+                throw Error(std::format(
+                    "Packed blackboard with {}-bit indices can index at most "
+                    "{} states, but the machine has {}",
+                    PackedStateStack::INDEX_BITS,
+                    PackedStateStack::MAX_INDEX,
+                    stateCount));
+        }
+
     private:
         void setPrimaryTransitionDestinationToMainEntryPoint(
             TransitionContext& destination)
@@ -94,6 +457,117 @@ namespace fsm::detail
 
     private:
         BuilderContext<BbT> context;
+        bool optimizationEnabled = false;
+        OptimizationReport* optimizationReport = nullptr;
+        std::optional<Profile> profile;
+        std::optional<BuildCache> buildCache;
+        const CallableRegistry<BbT>* registry = nullptr;
+    };
+
+    template<BlackboardTypeConcept BbT>
+    class [[nodiscard]] GlobalInterruptBuilder final
+    {
+    public:
+        constexpr GlobalInterruptBuilder(
+            FinalBuilder<BbT>& owner,
+            BuilderContext<BbT>& context,
+            GlobalInterruptContext<BbT>&& interrupt) noexcept
+            : owner(owner), context(context), interrupt(std::move(interrupt))
+        {
+        }
+
+        GlobalInterruptBuilder(GlobalInterruptBuilder&&) = delete;
+
+        GlobalInterruptBuilder(const GlobalInterruptBuilder&) = delete;
+
+    public:
+        /**
+         * Enter the entry state of a given submachine. Then specify
+         * what happens when the submachine finishes.
+         */
+        auto goToMachine(MachineId machineName)
+        {
+            if (!context.machines.contains(machineName))
+                throw Error(std::format(
+                    "Global interrupt targets machine called {} that is not "
+                    "defined",
+                    machineName.get()));
+
+            if (machineName.get() == MAIN_MACHINE_NAME
+                || machineName.get() == ERROR_MACHINE_NAME)
+                throw Error(
+                    "Global interrupt must target a submachine, use "
+                    "useGlobalEntryCondition to enter the error machine");
+
+            if (context.globalInterrupts.size() == MAX_GLOBAL_INTERRUPTS)
+                throw Error(std::format(
+                    "There can be at most {} global interrupts",
+                    MAX_GLOBAL_INTERRUPTS));
+
+            interrupt.targetMachine = machineName;
+            interrupt.destination.primary = createFullStateName(
+                machineName, context.machines.at(machineName).entryState);
+            return GlobalInterruptBackTransitionBuilder<BbT>(
+                owner, context, std::move(interrupt));
+        }
+
+    private:
+        FinalBuilder<BbT>& owner;
+        BuilderContext<BbT>& context;
+        GlobalInterruptContext<BbT> interrupt;
+    };
+
+    template<BlackboardTypeConcept BbT>
+    class [[nodiscard]] GlobalInterruptBackTransitionBuilder final
+    {
+    public:
+        constexpr GlobalInterruptBackTransitionBuilder(
+            FinalBuilder<BbT>& owner,
+            BuilderContext<BbT>& context,
+            GlobalInterruptContext<BbT>&& interrupt) noexcept
+            : owner(owner), context(context), interrupt(std::move(interrupt))
+        {
+        }
+
+        GlobalInterruptBackTransitionBuilder(
+            GlobalInterruptBackTransitionBuilder&&) = delete;
+
+        GlobalInterruptBackTransitionBuilder(
+            const GlobalInterruptBackTransitionBuilder&) = delete;
+
+    public:
+
+        /**
+         * When the submachine finishes, restart the FSM from the entry
+         * state of the main machine.
+         */
+        auto& thenRestart()
+        {
+            interrupt.destination.secondary = createFullStateName(
+                MAIN_MACHINE_NAME,
+                context.machines.at(MAIN_MACHINE_NAME).entryState);
+            return commit();
+        }
+
+        /**
+         * When the submachine finishes, the whole FSM finishes.
+         */
+        auto& thenFinish()
+        {
+            return commit();
+        }
+
+    private:
+        FinalBuilder<BbT>& commit()
+        {
+            context.globalInterrupts.push_back(std::move(interrupt));
+            return owner;
+        }
+
+    private:
+        FinalBuilder<BbT>& owner;
+        BuilderContext<BbT>& context;
+        GlobalInterruptContext<BbT> interrupt;
     };
 
     template<
@@ -113,10 +587,12 @@ namespace fsm::detail
         constexpr MachineBackTransitionBuilder(
             BuilderContext<BbT>&& context,
             MachineId targetMachineName,
-            ConditionConcept<BbT> auto&& condition) noexcept
+            ConditionConcept<BbT> auto&& condition,
+            FieldMask dependencies) noexcept
             : context(std::move(context))
             , targetMachineName(targetMachineName)
             , condition(std::move(condition))
+            , dependencies(dependencies)
         {
             assert(!BuildDefaultTransition);
         }
@@ -143,6 +619,11 @@ namespace fsm::detail
                 });
         }
 
+        /**
+         * When invoked submachine finishes, the currently-defined machine
+         * finishes too. Nothing of this machine is kept on the stack,
+         * so its interrupts are not checked while the submachine runs.
+         */
         auto thenFinish()
         {
             return invokeSubmachine(
@@ -170,6 +651,7 @@ namespace fsm::detail
                     ConditionalTransitionContext {
                         .condition = std::move(condition),
                         .destination = std::move(destination),
+                        .dependencies = dependencies,
                     });
                 return StateBuilder<BbT, IsSubmachine, false>(
                     std::move(context));
@@ -180,6 +662,7 @@ namespace fsm::detail
         BuilderContext<BbT> context;
         MachineId targetMachineName;
         Condition<BbT> condition;
+        FieldMask dependencies = 0;
     };
 
     template<BlackboardTypeConcept BbT, bool IsSubmachine>
@@ -320,8 +803,11 @@ namespace fsm::detail
     public:
         constexpr ConditionTransitionBuilder(
             BuilderContext<BbT>&& context,
-            ConditionConcept<BbT> auto&& condition) noexcept
-            : context(std::move(context)), condition(std::move(condition))
+            ConditionConcept<BbT> auto&& condition,
+            FieldMask dependencies) noexcept
+            : context(std::move(context))
+            , condition(std::move(condition))
+            , dependencies(dependencies)
         {
         }
 
@@ -336,7 +822,7 @@ namespace fsm::detail
         auto goToState(StateId name)
         {
             addConditionalTransitionToStateInCurrentMachine(
-                std::move(condition), name, context);
+                std::move(condition), dependencies, name, context);
             return StateBuilder<BbT, IsSubmachine, false>(std::move(context));
         }
 
@@ -358,7 +844,10 @@ namespace fsm::detail
                         machineName.get()));
 
             return MachineBackTransitionBuilder<BbT, IsSubmachine, false>(
-                std::move(context), machineName, std::move(condition));
+                std::move(context),
+                machineName,
+                std::move(condition),
+                dependencies);
         }
 
         /**
@@ -372,6 +861,7 @@ namespace fsm::detail
             getCurrentlyBuiltState(context).conditions.push_back(
                 ConditionalTransitionContext {
                     .condition = std::move(condition),
+                    .dependencies = dependencies,
                 });
             return StateBuilder<BbT, IsSubmachine, false>(std::move(context));
         }
@@ -388,13 +878,15 @@ namespace fsm::detail
                     "defined");
             }
 
-            addConditionalErrorTransition(std::move(condition), context);
+            addConditionalErrorTransition(
+                std::move(condition), dependencies, context);
             return StateBuilder<BbT, IsSubmachine, false>(std::move(context));
         }
 
     private:
         BuilderContext<BbT> context;
         Condition<BbT> condition;
+        FieldMask dependencies = 0;
     };
 
     template<BlackboardTypeConcept BbT>
@@ -403,8 +895,11 @@ namespace fsm::detail
     public:
         constexpr ConditionTransitionErrorBuilder(
             BuilderContext<BbT>&& context,
-            ConditionConcept<BbT> auto&& condition) noexcept
-            : context(std::move(context)), condition(std::move(condition))
+            ConditionConcept<BbT> auto&& condition,
+            FieldMask dependencies) noexcept
+            : context(std::move(context))
+            , condition(std::move(condition))
+            , dependencies(dependencies)
         {
         }
 
@@ -421,7 +916,7 @@ namespace fsm::detail
         auto goToState(StateId name)
         {
             addConditionalTransitionToStateInCurrentMachine(
-                std::move(condition), name, context);
+                std::move(condition), dependencies, name, context);
             return StateBuilder<BbT, false, true>(std::move(context));
         }
 
@@ -437,6 +932,7 @@ namespace fsm::detail
     private:
         BuilderContext<BbT> context;
         Condition<BbT> condition;
+        FieldMask dependencies = 0;
     };
 
     template<BlackboardTypeConcept BbT, bool IsSubmachine, bool IsErrorMachine>
@@ -454,17 +950,88 @@ namespace fsm::detail
         StateBuilderBase(const StateBuilderBase&) = delete;
 
     protected:
-        auto whenBaseImpl(ConditionConcept<BbT> auto&& condition)
+        template<SwitchableFieldConcept FieldT, class OwnerT>
+        auto switchOnBaseImpl(FieldT OwnerT::*field)
+        {
+            getCurrentlyBuiltState(context).switchSelector =
+                [field](const BbT& blackboard)
+            { return toSwitchKey(blackboard.*field); };
+            return StateBuilder<BbT, IsSubmachine, IsErrorMachine>(
+                std::move(context));
+        }
+
+        auto caseOfBaseImpl(std::int64_t value)
+        {
+            auto& machine = getCurrentlyBuiltMachine(context);
+            auto& state = getCurrentlyBuiltState(context);
+
+            if (!state.switchSelector
+                || state.conditions.size() != state.caseValues.size())
+                throw Error(std::format(
+                    "caseOf in state {} must directly follow switchOn or "
+                    "another caseOf",
+                    machine.currentlyBuiltState));
+
+            if (std::ranges::find(state.caseValues, value)
+                != state.caseValues.end())
+                throw Error(std::format(
+                    "Case {} is declared multiple times in state {}",
+                    value,
+                    machine.currentlyBuiltState));
+
+            state.caseValues.push_back(value);
+            return whenBaseImpl(
+                [selector = state.switchSelector, value](const BbT& blackboard)
+                { return selector(blackboard) == value; });
+        }
+
+        auto markConditionsExclusiveBaseImpl()
+        {
+            getCurrentlyBuiltState(context).conditionsAreExclusive = true;
+            return StateBuilderBeforePickingAnything<
+                BbT,
+                IsSubmachine,
+                IsErrorMachine>(std::move(context));
+        }
+
+        auto waitUntilBaseImpl(
+            ConditionConcept<BbT> auto&& condition, FieldMask dependencies)
+        {
+            auto& machine = getCurrentlyBuiltMachine(context);
+            auto& state = getCurrentlyBuiltState(context);
+
+            if (dependencies == 0)
+                throw Error(std::format(
+                    "Condition waited for in state {} must depend on at "
+                    "least one field",
+                    machine.currentlyBuiltState));
+
+            if (state.waitCondition)
+                throw Error(std::format(
+                    "State {} can only wait for a single condition",
+                    machine.currentlyBuiltState));
+
+            state.waitCondition = std::move(condition);
+            state.waitDependencies = dependencies;
+            return StateBuilderBeforePickingAnything<
+                BbT,
+                IsSubmachine,
+                IsErrorMachine>(std::move(context));
+        }
+
+        auto whenBaseImpl(
+            ConditionConcept<BbT> auto&& condition,
+            FieldMask dependencies = 0)
         {
             if constexpr (IsErrorMachine)
             {
                 return ConditionTransitionErrorBuilder<BbT>(
-                    std::move(context), std::move(condition));
+                    std::move(context), std::move(condition), dependencies);
             }
             else
             {
                 return ConditionTransitionBuilder<BbT, IsSubmachine>(
-                    std::move(context), std::move(condition));
+                    std::move(context), std::move(condition), dependencies);
             }
         }
 
@@ -483,6 +1050,12 @@ namespace fsm::detail
             }
         }
 
+        auto execAsyncBaseImpl(AsyncActionConcept<BbT> auto&& action)
+        {
+            getCurrentlyBuiltState(context).asyncAction = std::move(action);
+            return execBaseImpl(doNothing);
+        }
+
     private:
         BuilderContext<BbT> context;
     };
@@ -506,6 +1079,51 @@ namespace fsm::detail
             const StateBuilderBeforePickingAnything&) = delete;
 
     public:
+        /**
+         * Promise that at most one condition of this state can be true
+         * at any time. Conditions of such state can be reordered by
+         * withProfile according to how often they are hit.
+         */
+        auto withMutuallyExclusiveConditions()
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                markConditionsExclusiveBaseImpl();
+        }
+
+        /**
+         * Do not evaluate this state until the condition is true. Instead
+         * of being checked on every tick, the condition is only re-checked
+         * after one of its dependencies is marked dirty (\see markDirty).
+         * Until then, ticking the agent only evaluates the global error
+         * condition and the interrupts, which can preempt the wait.
+         * Blackboards not deriving from TrackedBlackboard re-check
+         * the condition on every tick.
+         *
+         * \param dependencies Fields the condition reads
+         */
+        auto waitUntil(
+            ConditionConcept<BbT> auto&& condition, FieldMask dependencies)
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                waitUntilBaseImpl(std::move(condition), dependencies);
+        }
+
+        /**
+         * Branch on the value of a single integral or enum field
+         * of the blackboard. Branches are declared with caseOf and they
+         * are evaluated before any orWhen conditions.
+         *
+         * Cases are compiled into a lookup table, so the dispatch takes
+         * the same time regardless of the number of cases.
+         */
+        template<SwitchableFieldConcept FieldT, class OwnerT>
+            requires std::derived_from<BbT, OwnerT>
+        auto switchOn(FieldT OwnerT::*field)
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                switchOnBaseImpl(field);
+        }
+
         /**
          * When ticked, check this condition.
          */
@@ -515,6 +1133,20 @@ namespace fsm::detail
                 whenBaseImpl(std::move(condition));
         }
 
+        /**
+         * When ticked, check this condition. The condition only reads
+         * the dependencies, so if it was false and none of them was marked
+         * dirty (\see markDirty, TrackedField) since, it is not evaluated
+         * again while the agent stays in this state. Dependencies are
+         * ignored unless the blackboard derives from TrackedBlackboard.
+         */
+        auto when(
+            ConditionConcept<BbT> auto&& condition, FieldMask dependencies)
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                whenBaseImpl(std::move(condition), dependencies);
+        }
+
         /**
          * When ticked, execute this action.
          */
@@ -523,6 +1155,25 @@ namespace fsm::detail
             return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
                 execBaseImpl(std::move(action));
         }
+
+        /**
+         * When ticked, run this coroutine. The coroutine can suspend
+         * itself with co_await fsm::nextTick(), fsm::sleepFor(duration)
+         * or fsm::until(predicate) and it is resumed by a later tick.
+         * The default transition is only taken after the coroutine returns.
+         *
+         * While suspended, the state is not evaluated at all, the tick
+         * only checks whether the awaited event happened. The global error
+         * condition and the interrupts are still evaluated and if any
+         * of them is hit, the coroutine is destroyed. Once resumed,
+         * the conditions are evaluated first and if any of them is hit,
+         * the coroutine is destroyed.
+         */
+        auto execAsync(AsyncActionConcept<BbT> auto&& action)
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                execAsyncBaseImpl(std::move(action));
+        }
     };
 
     template<BlackboardTypeConcept BbT, bool IsSubmachine, bool IsErrorMachine>
@@ -541,6 +1192,17 @@ namespace fsm::detail
         StateBuilder(const StateBuilder&) = delete;
 
     public:
+        /**
+         * Declare a branch of the switch, it is taken when the field passed
+         * to switchOn has this value. Must directly follow switchOn
+         * or another caseOf.
+         */
+        auto caseOf(SwitchableFieldConcept auto value)
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                caseOfBaseImpl(toSwitchKey(value));
+        }
+
         /**
          * Declare another condition for this state.
          */
@@ -550,6 +1212,17 @@ namespace fsm::detail
                 whenBaseImpl(std::move(condition));
         }
 
+        /**
+         * Declare another condition for this state that only reads
+         * the dependencies. \see StateBuilderBeforePickingAnything::when
+         */
+        auto orWhen(
+            ConditionConcept<BbT> auto&& condition, FieldMask dependencies)
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                whenBaseImpl(std::move(condition), dependencies);
+        }
+
         /**
          * Declare default action that is performed when no condition
          * is fulfilled.
@@ -559,6 +1232,16 @@ namespace fsm::detail
             return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
                 execBaseImpl(std::move(action));
         }
+
+        /**
+         * Declare default coroutine that is run when no condition
+         * is fulfilled. \see StateBuilderBeforePickingAnything::execAsync
+         */
+        auto otherwiseExecAsync(AsyncActionConcept<BbT> auto&& action)
+        {
+            return StateBuilderBase<BbT, IsSubmachine, IsErrorMachine>::
+                execAsyncBaseImpl(std::move(action));
+        }
     };
 
     template<BlackboardTypeConcept BbT, bool IsSubmachine, bool IsErrorMachine>
@@ -607,6 +1290,81 @@ namespace fsm::detail
         BuilderContext<BbT> context;
     };
 
+    template<BlackboardTypeConcept BbT, bool IsSubmachine>
+    class [[nodiscard]] InterruptTransitionBuilder final
+    {
+    public:
+        constexpr InterruptTransitionBuilder(
+            BuilderContext<BbT>&& context,
+            ConditionConcept<BbT> auto&& condition) noexcept
+            : context(std::move(context)), condition(std::move(condition))
+        {
+        }
+
+        InterruptTransitionBuilder(InterruptTransitionBuilder&&) = delete;
+
+        InterruptTransitionBuilder(const InterruptTransitionBuilder&) = delete;
+
+    public:
+        /**
+         * Abandon whatever the machine and its submachines are doing
+         * and transition into a state of the currently-defined machine.
+         * The interrupt is not evaluated while the machine is in that state.
+         */
+        auto goToState(StateId name)
+        {
+            return addInterrupt(TransitionContext {
+                .primary =
+                    createFullStateName(context.currentlyBuiltMachine, name),
+            });
+        }
+
+        /**
+         * Abandon whatever the machine and its submachines are doing
+         * and finish the currently-defined machine.
+         */
+        auto finish()
+        {
+            return addInterrupt(TransitionContext {});
+        }
+
+        /**
+         * Transition into entry state of the error machine.
+         */
+        auto error()
+        {
+            if (!context.machines.contains(ERROR_MACHINE_NAME))
+            {
+                throw Error(
+                    "You cannot call error() when no error machine was "
+                    "defined");
+            }
+
+            return addInterrupt(TransitionContext {
+                .primary = createFullStateName(
+                    ERROR_MACHINE_NAME,
+                    context.machines.at(ERROR_MACHINE_NAME).entryState),
+            });
+        }
+
+    private:
+        auto addInterrupt(TransitionContext&& destination)
+        {
+            auto& interrupts = getCurrentlyBuiltMachine(context).interrupts;
+            interrupts.push_back(ConditionalTransitionContext {
+                .condition = std::move(condition),
+                .destination = std::move(destination),
+                .declarationIdx = interrupts.size(),
+            });
+            return MachineBuilderPreEntryPoint<BbT, IsSubmachine, false>(
+                std::move(context));
+        }
+
+    private:
+        BuilderContext<BbT> context;
+        Condition<BbT> condition;
+    };
+
     template<BlackboardTypeConcept BbT, bool IsSubmachine, bool IsErrorMachine>
     class [[nodiscard]] MachineBuilderPreEntryPoint final
     {
@@ -645,6 +1403,26 @@ namespace fsm::detail
                 IsErrorMachine>(std::move(context));
         }
 
+        /**
+         * Declare a condition that is checked on each tick before the
+         * state of this machine or of any submachine it invoked is
+         * evaluated, as long as this machine has a state on the stack.
+         * Interrupts of outer machines are checked first, so each active
+         * machine checks its interrupts once per tick.
+         *
+         * Submachine invoked with goToMachine(name).thenFinish() leaves
+         * no return state, so the invoking machine is already finished
+         * and its interrupts are not checked while the submachine runs.
+         *
+         * This replaces copying the same condition into every state.
+         */
+        auto interruptWhen(ConditionConcept<BbT> auto&& condition)
+            requires(!IsErrorMachine)
+        {
+            return InterruptTransitionBuilder<BbT, IsSubmachine>(
+                std::move(context), std::move(condition));
+        }
+
     private:
         BuilderContext<BbT> context;
     };
@@ -685,6 +1463,32 @@ namespace fsm::detail
                 std::move(context));
         }
 
+        /**
+         * Link a submachine compiled by FinalBuilder::buildSubmachine
+         * under the given name. Other machines can transition into it
+         * like into a submachine declared by withSubmachine, but its
+         * states are not compiled again. The FSM refers to the states
+         * of the shared submachine and keeps it alive.
+         *
+         * FSMs with shared submachines cannot be saved (\see
+         * fsm::Fsm::saveModel) nor cached (\see
+         * FinalBuilder::withBuildCache).
+         */
+        auto& withSharedSubmachine(
+            MachineId name,
+            std::shared_ptr<const CompiledSubmachine<BbT>> submachine)
+        {
+            if (context.machines.contains(name))
+                throw Error(
+                    std::format(
+                        "Trying to redeclare machine with name {}",
+                        name.get()));
+
+            context.machines[name] = submachine->createDefinition(name);
+            context.sharedMachines[name] = std::move(submachine);
+            return *this;
+        }
+
         /**
          * Declare the main machine of the FSM. You won't be able to
          * declare any additional submachines after this point.
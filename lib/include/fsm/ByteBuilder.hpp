@@ -0,0 +1,285 @@
+#pragma once
+
+#include <format>
+#include <fsm/ByteFsm.hpp>
+#include <fsm/Error.hpp>
+#include <fsm/Types.hpp>
+#include <fsm/detail/ByteBuilderContext.hpp>
+#include <fsm/detail/NonEmptyString.hpp>
+#include <string_view>
+#include <vector>
+
+namespace fsm::detail
+{
+    template<ByteBlackboardTypeConcept BbT>
+    class ByteStateBuilder;
+
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] ByteMachineBuilder final
+    {
+    public:
+        explicit constexpr ByteMachineBuilder(
+            ByteBuilderContext<BbT>&& context) noexcept
+            : context(std::move(context))
+        {
+        }
+
+        ByteMachineBuilder(ByteMachineBuilder&&) = delete;
+
+        ByteMachineBuilder(const ByteMachineBuilder&) = delete;
+
+    public:
+        /**
+         * Declare a new state
+         */
+        auto withState(NonEmptyString<char> name)
+        {
+            if (context.states.contains(name))
+                throw Error(std::format(
+                    "Trying to redeclare byte state with name {}",
+                    name.get()));
+
+            context.currentlyBuiltState = name;
+            context.states[name] = {};
+            return ByteStateBuilder<BbT>(std::move(context));
+        }
+
+        /**
+         * Construct the byte machine from builder definitions.
+         */
+        ByteFsm<BbT> build()
+        {
+            return ByteFsm<BbT>(std::move(context));
+        }
+
+    private:
+        ByteBuilderContext<BbT> context;
+    };
+
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] ByteDefaultTransitionBuilder final
+    {
+    public:
+        constexpr ByteDefaultTransitionBuilder(
+            ByteBuilderContext<BbT>&& context,
+            std::vector<std::uint8_t>&& bytes,
+            ByteAction<BbT>&& action) noexcept
+            : context(std::move(context))
+            , bytes(std::move(bytes))
+            , action(std::move(action))
+        {
+        }
+
+        ByteDefaultTransitionBuilder(ByteDefaultTransitionBuilder&&) = delete;
+
+        ByteDefaultTransitionBuilder(const ByteDefaultTransitionBuilder&) =
+            delete;
+
+    public:
+        /**
+         * After executing the action, transition to a given state
+         */
+        auto andGoToState(NonEmptyString<char> name)
+        {
+            return andGoToStateImpl(name);
+        }
+
+        /**
+         * After executing the action, stay in the current state
+         */
+        auto andLoop()
+        {
+            return andGoToStateImpl(context.currentlyBuiltState);
+        }
+
+        /**
+         * After executing the action, transition to the error state
+         */
+        auto andError()
+        {
+            return andGoToStateImpl(BYTE_ERROR_STATE_NAME);
+        }
+
+    private:
+        auto andGoToStateImpl(const std::string& destination)
+        {
+            auto& transitions =
+                context.states.at(context.currentlyBuiltState).transitions;
+
+            for (auto&& byte : bytes)
+                transitions[byte] = ByteTransitionContext<BbT> {
+                    .destination = destination,
+                    .action = action,
+                };
+
+            return ByteStateBuilder<BbT>(std::move(context));
+        }
+
+    private:
+        ByteBuilderContext<BbT> context;
+        std::vector<std::uint8_t> bytes;
+        ByteAction<BbT> action;
+    };
+
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] ByteTransitionBuilder final
+    {
+    public:
+        constexpr ByteTransitionBuilder(
+            ByteBuilderContext<BbT>&& context,
+            std::vector<std::uint8_t>&& bytes) noexcept
+            : context(std::move(context)), bytes(std::move(bytes))
+        {
+        }
+
+        ByteTransitionBuilder(ByteTransitionBuilder&&) = delete;
+
+        ByteTransitionBuilder(const ByteTransitionBuilder&) = delete;
+
+    public:
+        /**
+         * Execute this action when the byte is read. The action receives
+         * the current token.
+         */
+        auto exec(ByteActionConcept<BbT> auto&& action)
+        {
+            return ByteDefaultTransitionBuilder<BbT>(
+                std::move(context), std::move(bytes), std::move(action));
+        }
+
+        /**
+         * Transition to a given state without executing any action.
+         * The byte becomes part of the current token.
+         */
+        auto goToState(NonEmptyString<char> name)
+        {
+            return ByteDefaultTransitionBuilder<BbT>(
+                       std::move(context), std::move(bytes), {})
+                .andGoToState(name);
+        }
+
+        /**
+         * Transition to the error state
+         */
+        auto error()
+        {
+            return ByteDefaultTransitionBuilder<BbT>(
+                       std::move(context), std::move(bytes), {})
+                .andError();
+        }
+
+    private:
+        ByteBuilderContext<BbT> context;
+        std::vector<std::uint8_t> bytes;
+    };
+
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] ByteStateBuilder final
+    {
+    public:
+        explicit constexpr ByteStateBuilder(
+            ByteBuilderContext<BbT>&& context) noexcept
+            : context(std::move(context))
+        {
+        }
+
+        ByteStateBuilder(ByteStateBuilder&&) = delete;
+
+        ByteStateBuilder(const ByteStateBuilder&) = delete;
+
+    public:
+        /**
+         * Declare a transition taken when a given byte is read
+         */
+        auto on(char byte)
+        {
+            return onAnyOf(std::string_view(&byte, 1u));
+        }
+
+        /**
+         * Declare a transition taken when any of the given bytes is read
+         */
+        auto onAnyOf(std::string_view bytes)
+        {
+            auto& state = context.states.at(context.currentlyBuiltState);
+            auto&& result = std::vector<std::uint8_t> {};
+
+            for (auto&& byte : bytes)
+            {
+                const auto value = static_cast<std::uint8_t>(byte);
+                if (state.transitions.contains(value))
+                    throw Error(std::format(
+                        "Byte {:#x} has multiple transitions in state {}",
+                        value,
+                        context.currentlyBuiltState));
+                result.push_back(value);
+            }
+
+            return ByteTransitionBuilder<BbT>(
+                std::move(context), std::move(result));
+        }
+
+        /**
+         * Execute this action when fsm::ByteFsm::finish is called while
+         * the machine is in this state. The action receives the rest
+         * of the current token.
+         */
+        auto atEndOfInputExec(ByteActionConcept<BbT> auto&& action)
+        {
+            context.states.at(context.currentlyBuiltState).endOfInputAction =
+                std::move(action);
+            return ByteStateBuilder<BbT>(std::move(context));
+        }
+
+        /**
+         * All other bytes keep the machine in this state and become part
+         * of the current token. Runs of such bytes are skipped in bulk.
+         */
+        auto otherwiseConsume()
+        {
+            return ByteMachineBuilder<BbT>(std::move(context));
+        }
+
+        /**
+         * All other bytes transition the machine into the error state
+         */
+        auto otherwiseError()
+        {
+            context.states.at(context.currentlyBuiltState).errorOnOtherBytes =
+                true;
+            return ByteMachineBuilder<BbT>(std::move(context));
+        }
+
+    private:
+        ByteBuilderContext<BbT> context;
+    };
+} // namespace fsm::detail
+
+namespace fsm
+{
+    /**
+     * \brief Builder for fsm::ByteFsm
+     */
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] ByteBuilder final
+    {
+    public:
+        ByteBuilder() = default;
+        ByteBuilder(ByteBuilder&&) = delete;
+        ByteBuilder(const ByteBuilder&) = delete;
+
+    public:
+        /**
+         * Declare the state the machine starts in
+         */
+        auto withEntryState(detail::NonEmptyString<char> name)
+        {
+            auto&& context = detail::ByteBuilderContext<BbT> {
+                .entryState = name,
+                .currentlyBuiltState = name,
+            };
+            context.states[name] = {};
+            return detail::ByteStateBuilder<BbT>(std::move(context));
+        }
+    };
+} // namespace fsm
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fsm/Types.hpp>
+#include <fsm/detail/ByteBuilderContext.hpp>
+#include <fsm/detail/ByteScanner.hpp>
+#include <fsm/detail/StateIndex.hpp>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace fsm
+{
+    /**
+     * \brief Finite state machine driven by bytes of the input
+     *
+     * Specialized machine for parsers and other character-driven logic.
+     * Each state maps every possible byte to a target state and optionally
+     * an action, compiled into a 256-entry table, so each byte costs
+     * a single table lookup. Runs of bytes that keep the machine in its
+     * current state without any action are skipped in bulk.
+     *
+     * Bytes that do not trigger an action form the current token. When
+     * an action is triggered, it receives the token collected so far
+     * (without the triggering byte) and the token is reset. Tokens can
+     * span multiple calls to \see process.
+     *
+     * Construct the machine with fsm::ByteBuilder.
+     */
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] ByteFsm final
+    {
+    public:
+        struct [[nodiscard]] WalkResult
+        {
+            size_t endStateIdx = 0;
+
+            // Position right after the last byte that would trigger
+            // an action, nullopt if there is no such byte
+            std::optional<size_t> lastTokenStart = std::nullopt;
+        };
+
+    public:
+        explicit ByteFsm(detail::ByteBuilderContext<BbT>&& context)
+        {
+            auto&& index = createIndex(context);
+            states.reserve(index.getSize());
+
+            for (auto&& name : index.getIndexedStateNames())
+                states.push_back(
+                    compileState(name, context.states.at(name), index));
+        }
+
+        ByteFsm(ByteFsm&&) = default;
+        ByteFsm(const ByteFsm&) = delete;
+
+    public:
+        /**
+         * Feed the next chunk of input to the machine. Processing stops
+         * early if the machine gets into the error state.
+         *
+         * \return Number of bytes consumed
+         */
+        size_t process(BbT& blackboard, std::string_view input) const
+        {
+            size_t pos = 0;
+            size_t tokenStart = 0;
+            auto stateIdx = blackboard.__byteStateIdx;
+
+            while (pos < input.size() && stateIdx != ERROR_STATE_IDX)
+            {
+                const auto& state = states[stateIdx];
+                pos = state.scanner.findStop(input, pos);
+                if (pos == input.size()) break;
+
+                const auto& transition =
+                    state.transitions[static_cast<std::uint8_t>(input[pos])];
+
+                if (transition.action != NO_ACTION)
+                {
+                    // Machine state must be visible to the action
+                    blackboard.__byteStateIdx = stateIdx;
+                    actions[transition.action](
+                        blackboard,
+                        getToken(blackboard, input, tokenStart, pos));
+                    blackboard.__pendingToken.clear();
+                    tokenStart = pos + 1;
+                }
+
+                stateIdx = transition.target;
+                ++pos;
+            }
+
+            blackboard.__byteStateIdx = stateIdx;
+            if (tokenStart < pos)
+                blackboard.__pendingToken.append(
+                    input.substr(tokenStart, pos - tokenStart));
+
+            return pos;
+        }
+
+        /**
+         * Signal the end of input. Executes the end of input action
+         * of the current state, if there is one, with the rest
+         * of the current token.
+         */
+        void finish(BbT& blackboard) const
+        {
+            if (!isErrored(blackboard))
+            {
+                const auto action =
+                    states[blackboard.__byteStateIdx].endOfInputAction;
+                if (action != NO_ACTION)
+                    actions[action](blackboard, blackboard.__pendingToken);
+            }
+
+            blackboard.__pendingToken.clear();
+        }
+
+        /**
+         * Follow the transitions for given input without executing any
+         * actions and without a blackboard. Used for speculative processing
+         * of input chunks from all possible start states.
+         */
+        [[nodiscard]] WalkResult
+        walk(size_t stateIdx, std::string_view input) const noexcept
+        {
+            auto&& result = WalkResult {};
+            size_t pos = 0;
+
+            while (pos < input.size() && stateIdx != ERROR_STATE_IDX)
+            {
+                const auto& state = states[stateIdx];
+                pos = state.scanner.findStop(input, pos);
+                if (pos == input.size()) break;
+
+                const auto& transition =
+                    state.transitions[static_cast<std::uint8_t>(input[pos])];
+                if (transition.action != NO_ACTION)
+                    result.lastTokenStart = pos + 1;
+
+                stateIdx = transition.target;
+                ++pos;
+            }
+
+            result.endStateIdx = stateIdx;
+            return result;
+        }
+
+        [[nodiscard]] constexpr size_t getStateCount() const noexcept
+        {
+            return states.size();
+        }
+
+        /**
+         * Check if the machine got into the error state.
+         */
+        [[nodiscard]] constexpr bool
+        isErrored(const BbT& blackboard) const noexcept
+        {
+            return blackboard.__byteStateIdx == ERROR_STATE_IDX;
+        }
+
+    private:
+        static constexpr std::uint32_t ERROR_STATE_IDX =
+            std::numeric_limits<std::uint32_t>::max();
+        static constexpr std::uint32_t NO_ACTION =
+            std::numeric_limits<std::uint32_t>::max();
+
+        struct CompiledByteTransition
+        {
+            std::uint32_t target = ERROR_STATE_IDX;
+            std::uint32_t action = NO_ACTION;
+        };
+
+        struct CompiledByteState
+        {
+            std::array<CompiledByteTransition, 256> transitions;
+            detail::ByteScanner scanner;
+            std::uint32_t endOfInputAction = NO_ACTION;
+        };
+
+    private:
+        [[nodiscard]] static detail::StateIndex
+        createIndex(const detail::ByteBuilderContext<BbT>& context)
+        {
+            auto&& index = detail::StateIndex();
+            index.addNameToIndex(context.entryState);
+
+            for (auto&& [name, _] : context.states)
+            {
+                if (name != context.entryState) index.addNameToIndex(name);
+            }
+
+            return index;
+        }
+
+        [[nodiscard]] CompiledByteState compileState(
+            const std::string& name,
+            detail::ByteStateBuilderContext<BbT>& state,
+            const detail::StateIndex& index)
+        {
+            const auto stateIdx =
+                static_cast<std::uint32_t>(index.getStateIndex(name));
+
+            auto&& result = CompiledByteState {};
+            result.transitions.fill(CompiledByteTransition {
+                .target = state.errorOnOtherBytes ? ERROR_STATE_IDX : stateIdx,
+            });
+
+            for (auto&& [byte, transition] : state.transitions)
+            {
+                result.transitions[byte] = CompiledByteTransition {
+                    .target = transition.destination
+                                      == detail::BYTE_ERROR_STATE_NAME
+                                  ? ERROR_STATE_IDX
+                                  : static_cast<std::uint32_t>(
+                                        index.getStateIndex(
+                                            transition.destination)),
+                    .action = addAction(std::move(transition.action)),
+                };
+            }
+
+            auto&& stopBytes = std::vector<std::uint8_t> {};
+            for (size_t byte = 0; byte < result.transitions.size(); ++byte)
+            {
+                const auto& transition = result.transitions[byte];
+                if (transition.target != stateIdx
+                    || transition.action != NO_ACTION)
+                    stopBytes.push_back(static_cast<std::uint8_t>(byte));
+            }
+
+            result.scanner = detail::ByteScanner(stopBytes);
+            result.endOfInputAction =
+                addAction(std::move(state.endOfInputAction));
+            return result;
+        }
+
+        [[nodiscard]] std::uint32_t addAction(detail::ByteAction<BbT>&& action)
+        {
+            if (!action) return NO_ACTION;
+
+            actions.push_back(std::move(action));
+            return static_cast<std::uint32_t>(actions.size() - 1);
+        }
+
+        [[nodiscard]] static std::string_view getToken(
+            BbT& blackboard,
+            std::string_view input,
+            size_t tokenStart,
+            size_t tokenEnd)
+        {
+            const auto tail = input.substr(tokenStart, tokenEnd - tokenStart);
+            if (blackboard.__pendingToken.empty()) return tail;
+
+            blackboard.__pendingToken.append(tail);
+            return blackboard.__pendingToken;
+        }
+
+    private:
+        std::vector<CompiledByteState> states;
+        std::vector<detail::ByteAction<BbT>> actions;
+    };
+} // namespace fsm
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/Types.hpp>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace fsm
+{
+    /**
+     * \brief Table of conditions and actions identified by name
+     *
+     * Callables taken from the registry remember their names, so a machine
+     * built with them can be saved (\see Fsm::saveModel). When the model
+     * is loaded (\see Fsm::loadModel), the names are bound back to
+     * the callables of the registry.
+     *
+     * \code
+     * auto&& registry = fsm::CallableRegistry<Blackboard>()
+     *     .addCondition("isHurt", isHurt)
+     *     .addAction("heal", heal);
+     *
+     * fsm::Builder<Blackboard>()
+     *     ...
+     *         .when(registry.getCondition("isHurt")).goToState("Heal")
+     *         .otherwiseExec(registry.getAction("heal")).andLoop()
+     * \endcode
+     */
+    template<BlackboardTypeConcept BbT>
+    class [[nodiscard]] CallableRegistry final
+    {
+    public:
+        using NamedCondition = detail::NamedCallable<detail::Condition<BbT>>;
+        using NamedAction = detail::NamedCallable<detail::Action<BbT>>;
+
+    public:
+        /**
+         * \throws fsm::Error if the name is already taken by a condition
+         */
+        CallableRegistry&
+        addCondition(std::string name, ConditionConcept<BbT> auto&& condition)
+        {
+            add(conditions,
+                std::move(name),
+                std::forward<decltype(condition)>(condition));
+            return *this;
+        }
+
+        /**
+         * \throws fsm::Error if the name is already taken by an action
+         */
+        CallableRegistry&
+        addAction(std::string name, ActionConcept<BbT> auto&& action)
+        {
+            add(actions,
+                std::move(name),
+                std::forward<decltype(action)>(action));
+            return *this;
+        }
+
+        /**
+         * \throws fsm::Error if there is no condition with the name
+         */
+        [[nodiscard]] NamedCondition getCondition(std::string_view name) const
+        {
+            return NamedCondition {
+                .name = std::string(name),
+                .callable = get(conditions, name, "Condition"),
+            };
+        }
+
+        /**
+         * \throws fsm::Error if there is no action with the name
+         */
+        [[nodiscard]] NamedAction getAction(std::string_view name) const
+        {
+            return NamedAction {
+                .name = std::string(name),
+                .callable = get(actions, name, "Action"),
+            };
+        }
+
+    private:
+        template<class Callable>
+        static void add(
+            std::map<std::string, Callable, std::less<>>& table,
+            std::string&& name,
+            auto&& callable)
+        {
+            if (table.contains(name))
+                throw Error(std::format("{} is already registered", name));
+            table.emplace(
+                std::move(name), std::forward<decltype(callable)>(callable));
+        }
+
+        template<class Callable>
+        [[nodiscard]] static const Callable& get(
+            const std::map<std::string, Callable, std::less<>>& table,
+            std::string_view name,
+            const char* kind)
+        {
+            auto&& itr = table.find(name);
+            if (itr == table.end())
+                throw Error(std::format("{} {} is not registered", kind, name));
+            return itr->second;
+        }
+
+    private:
+        std::map<std::string, detail::Condition<BbT>, std::less<>> conditions;
+        std::map<std::string, detail::Action<BbT>, std::less<>> actions;
+    };
+} // namespace fsm
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <fsm/Types.hpp>
+#include <fsm/detail/BuilderContext.hpp>
+#include <fsm/detail/CompiledContext.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fsm
+{
+    /**
+     * \brief Submachine compiled once and linked into many FSM models
+     *
+     * Created by fsm::FinalBuilder::buildSubmachine from a builder that
+     * only declares the main machine. Models link it with
+     * MainBuilder::withSharedSubmachine under a name of their choice
+     * and refer to its compiled states instead of copying them, so
+     * the conditions and actions exist only once in memory.
+     *
+     * The submachine is immutable and shared through std::shared_ptr,
+     * it lives as long as the last model that links it.
+     */
+    template<BlackboardTypeConcept BbT>
+    class [[nodiscard]] CompiledSubmachine final
+    {
+    public:
+        CompiledSubmachine(
+            detail::MachineBuilderContext<BbT>&& definition,
+            std::vector<std::string>&& stateNames,
+            std::vector<detail::CompiledState<BbT>>&& states,
+            std::vector<detail::CompiledStateExtras<BbT>>&& stateExtras,
+            std::vector<detail::CompiledConditionalTransition<BbT>>&&
+                interrupts)
+            : definition(withoutCallables(std::move(definition)))
+            , stateNames(std::move(stateNames))
+            , states(std::move(states))
+            , stateExtras(std::move(stateExtras))
+            , interrupts(std::move(interrupts))
+        {
+        }
+
+        CompiledSubmachine(CompiledSubmachine&&) = delete;
+        CompiledSubmachine(const CompiledSubmachine&) = delete;
+
+    public:
+        /**
+         * Definition of the submachine with transitions renamed
+         * to the machine it is linked as. It has no callables.
+         */
+        [[nodiscard]] detail::MachineBuilderContext<BbT>
+        createDefinition(const std::string& machineName) const
+        {
+            auto&& result = detail::MachineBuilderContext<BbT>(definition);
+            auto&& renameState = [&](std::string& fullName)
+            {
+                if (fullName.starts_with(LOCAL_PREFIX))
+                    fullName.replace(0, LOCAL_PREFIX.size(), machineName + ":");
+            };
+            auto&& rename = [&](detail::TransitionContext& destination)
+            {
+                renameState(destination.primary);
+                renameState(destination.secondary);
+            };
+
+            for (auto&& [_, state] : result.states)
+            {
+                for (auto&& condition : state.conditions)
+                    rename(condition.destination);
+                rename(state.destination);
+            }
+
+            for (auto&& interrupt : result.interrupts)
+                rename(interrupt.destination);
+
+            return result;
+        }
+
+        /**
+         * Names of the states without the machine name, in the order
+         * of their indices relative to the entry state
+         */
+        [[nodiscard]] constexpr const std::vector<std::string>&
+        getStateNames() const noexcept
+        {
+            return stateNames;
+        }
+
+        [[nodiscard]] constexpr const std::vector<detail::CompiledState<BbT>>&
+        getStates() const noexcept
+        {
+            return states;
+        }
+
+        /**
+         * Switches, wait conditions and async behaviors of the states,
+         * \see detail::CompiledState::extrasIdx
+         */
+        [[nodiscard]] constexpr const std::vector<
+            detail::CompiledStateExtras<BbT>>&
+        getStateExtras() const noexcept
+        {
+            return stateExtras;
+        }
+
+        /**
+         * Interrupts of the submachine, their transitions are relative
+         * to the entry state
+         */
+        [[nodiscard]] constexpr const std::vector<
+            detail::CompiledConditionalTransition<BbT>>&
+        getInterrupts() const noexcept
+        {
+            return interrupts;
+        }
+
+    private:
+        [[nodiscard]] static detail::MachineBuilderContext<BbT>
+        withoutCallables(detail::MachineBuilderContext<BbT>&& definition)
+        {
+            for (auto&& [_, state] : definition.states)
+            {
+                for (auto&& condition : state.conditions)
+                    condition.condition = nullptr;
+                state.action = nullptr;
+                state.asyncAction = nullptr;
+                state.waitCondition = nullptr;
+                state.switchSelector = nullptr;
+            }
+
+            for (auto&& interrupt : definition.interrupts)
+                interrupt.condition = nullptr;
+
+            return std::move(definition);
+        }
+
+    private:
+        // The submachine is built as the main machine
+        static constexpr std::string_view LOCAL_PREFIX = "__main__:";
+
+        detail::MachineBuilderContext<BbT> definition;
+        std::vector<std::string> stateNames;
+        std::vector<detail::CompiledState<BbT>> states;
+        std::vector<detail::CompiledStateExtras<BbT>> stateExtras;
+        std::vector<detail::CompiledConditionalTransition<BbT>> interrupts;
+    };
+} // namespace fsm
@@ -0,0 +1,439 @@
+#pragma once
+
+#include <charconv>
+#include <filesystem>
+#include <format>
+#include <fsm/Builder.hpp>
+#include <fsm/CallableRegistry.hpp>
+#include <fsm/Error.hpp>
+#include <fsm/MappedFile.hpp>
+#include <fsm/Types.hpp>
+#include <fsm/detail/BuilderContext.hpp>
+#include <fsm/detail/BuilderContextHelper.hpp>
+#include <fsm/detail/Constants.hpp>
+#include <fsm/detail/DefinitionReader.hpp>
+#include <fsm/detail/Helper.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace fsm
+{
+    /**
+     * \brief Loads a machine from a text definition
+     *
+     * The definition produces the same builder context as the fluent
+     * builder, so the result can be optimized, exported or built like
+     * any other machine. Conditions and actions are referenced by names
+     * they were given in the fsm::CallableRegistry, action named
+     * 'nothing' is fsm::doNothing.
+     *
+     * Each line holds one directive, # starts a comment:
+     *
+     * \code
+     * error [on <condition>]        # optional, must come first
+     * machine <name>                # submachine
+     * main                          # main machine, must come last
+     * interrupt <condition> -> <target>
+     * state <name>                  # first state is the entry state
+     * exclusive                     # withMutuallyExclusiveConditions
+     * wait <condition> <fields>
+     * when <condition> [<fields>] -> <target>
+     * exec <action> -> <target>     # completes the state
+     * \endcode
+     *
+     * Targets are 'state <name>', 'loop', 'finish', 'error', 'restart'
+     * and 'machine <name> [then <state>]', allowed where the equivalent
+     * builder call is. Fields are a decimal or 0x-prefixed hexadecimal
+     * fsm::FieldMask.
+     */
+    template<BlackboardTypeConcept BbT>
+    class [[nodiscard]] DefinitionLoader final
+    {
+    public:
+        /**
+         * \throws fsm::Error if the definition is malformed or it uses
+         * a callable missing in the registry
+         */
+        [[nodiscard]] static detail::FinalBuilder<BbT> load(
+            std::string_view text, const CallableRegistry<BbT>& registry)
+        {
+            auto&& loader = DefinitionLoader(registry);
+            auto&& reader = detail::DefinitionReader(text);
+
+            while (reader.nextLine())
+            {
+                loader.lineNumber = reader.getLineNumber();
+                loader.parseLine(reader.getTokens());
+            }
+
+            loader.checkIsComplete();
+            return detail::FinalBuilder<BbT>(std::move(loader.context));
+        }
+
+        /**
+         * Map the file into memory and load the definition from it,
+         * \see load
+         */
+        [[nodiscard]] static detail::FinalBuilder<BbT> loadFromFile(
+            const std::filesystem::path& path,
+            const CallableRegistry<BbT>& registry)
+        {
+            auto&& file = MappedFile(path);
+            auto&& data = file.getData();
+            return load(std::string_view(data.data(), data.size()), registry);
+        }
+
+    private:
+        enum class Stage
+        {
+            NoMachine,
+            BeforeEntryState,
+            BeforePickingAnything,
+            AfterCondition,
+            StateDone,
+        };
+
+        enum TargetKind : unsigned
+        {
+            TO_STATE = 1u << 0,
+            TO_LOOP = 1u << 1,
+            TO_FINISH = 1u << 2,
+            TO_ERROR = 1u << 3,
+            TO_RESTART = 1u << 4,
+            TO_MACHINE = 1u << 5,
+        };
+
+        using Tokens = std::span<const std::string_view>;
+
+    private:
+        explicit DefinitionLoader(const CallableRegistry<BbT>& registry)
+            : registry(registry)
+        {
+        }
+
+        DefinitionLoader(DefinitionLoader&&) = delete;
+
+        DefinitionLoader(const DefinitionLoader&) = delete;
+
+    private:
+        void parseLine(Tokens tokens)
+        {
+            const auto keyword = tokens[0];
+            if (keyword == "error")
+                parseErrorMachine(tokens);
+            else if (keyword == "machine" || keyword == "main")
+                parseMachine(tokens);
+            else if (keyword == "interrupt")
+                parseInterrupt(tokens);
+            else if (keyword == "state")
+                parseState(tokens);
+            else if (keyword == "exclusive")
+                parseExclusive(tokens);
+            else if (keyword == "wait")
+                parseWait(tokens);
+            else if (keyword == "when")
+                parseWhen(tokens);
+            else if (keyword == "exec")
+                parseExec(tokens);
+            else
+                fail(std::format("unknown directive {}", keyword));
+        }
+
+        void parseErrorMachine(Tokens tokens)
+        {
+            if (stage != Stage::NoMachine || !context.machines.empty())
+                fail("error machine must be declared first");
+
+            if (tokens.size() != 1u
+                && (tokens.size() != 3u || tokens[1] != "on"))
+                fail("expected 'error [on <condition>]'");
+
+            detail::insertNewMachineIntoContext(
+                detail::ERROR_MACHINE_NAME, context);
+            if (tokens.size() == 3u)
+            {
+                context.useGlobalError = true;
+                context.errorCondition = registry.getCondition(tokens[2]);
+            }
+
+            isErrorMachine = true;
+            stage = Stage::BeforeEntryState;
+        }
+
+        void parseMachine(Tokens tokens)
+        {
+            const bool isMain = tokens[0] == "main";
+            if (tokens.size() != (isMain ? 1u : 2u))
+                fail(isMain ? "expected 'main'" : "expected 'machine <name>'");
+
+            if (mainDeclared)
+                fail("main machine must be declared last");
+            checkStateIsDone();
+
+            const auto name = isMain ? std::string(detail::MAIN_MACHINE_NAME)
+                                     : getName(tokens[1]);
+            if (context.machines.contains(name))
+                fail(std::format(
+                    "trying to redeclare machine with name {}", name));
+
+            detail::insertNewMachineIntoContext(name, context);
+            isErrorMachine = false;
+            mainDeclared = isMain;
+            stage = Stage::BeforeEntryState;
+        }
+
+        void parseInterrupt(Tokens tokens)
+        {
+            if (stage != Stage::BeforeEntryState || isErrorMachine)
+                fail("interrupts must precede the first state of a machine "
+                     "other than the error machine");
+
+            if (tokens.size() < 4u || tokens[2] != "->")
+                fail("expected 'interrupt <condition> -> <target>'");
+
+            auto& interrupts =
+                detail::getCurrentlyBuiltMachine(context).interrupts;
+            interrupts.push_back(detail::ConditionalTransitionContext<BbT> {
+                .condition = registry.getCondition(tokens[1]),
+                .destination = parseTarget(
+                    tokens.subspan(3u), TO_STATE | TO_FINISH | TO_ERROR),
+                .declarationIdx = interrupts.size(),
+            });
+        }
+
+        void parseState(Tokens tokens)
+        {
+            if (tokens.size() != 2u) fail("expected 'state <name>'");
+            if (stage == Stage::NoMachine) fail("state must be in a machine");
+            if (stage != Stage::BeforeEntryState) checkStateIsDone();
+
+            const auto name = getName(tokens[1]);
+            if (stage == Stage::BeforeEntryState)
+            {
+                detail::getCurrentlyBuiltMachine(context).entryState = name;
+                if (isErrorMachine)
+                    context.errorDestination.primary =
+                        detail::createFullStateName(
+                            detail::ERROR_MACHINE_NAME, name);
+            }
+
+            detail::insertNewStateIntoContext(name, context);
+            stage = Stage::BeforePickingAnything;
+        }
+
+        void parseExclusive(Tokens tokens)
+        {
+            if (tokens.size() != 1u) fail("expected 'exclusive'");
+            checkStage(Stage::BeforePickingAnything, "exclusive");
+
+            detail::getCurrentlyBuiltState(context).conditionsAreExclusive =
+                true;
+        }
+
+        void parseWait(Tokens tokens)
+        {
+            if (tokens.size() != 3u)
+                fail("expected 'wait <condition> <fields>'");
+            checkStage(Stage::BeforePickingAnything, "wait");
+
+            auto& state = detail::getCurrentlyBuiltState(context);
+            if (state.waitCondition)
+                fail("state can only wait for a single condition");
+
+            const auto dependencies = getFields(tokens[2]);
+            if (dependencies == 0)
+                fail("waited condition must depend on at least one field");
+
+            state.waitCondition = registry.getCondition(tokens[1]);
+            state.waitDependencies = dependencies;
+        }
+
+        void parseWhen(Tokens tokens)
+        {
+            if (stage != Stage::BeforePickingAnything
+                && stage != Stage::AfterCondition)
+                fail("'when' must precede 'exec' of a state");
+
+            const size_t arrowIdx =
+                tokens.size() > 3u && tokens[2] != "->" ? 3u : 2u;
+            if (tokens.size() <= arrowIdx + 1u || tokens[arrowIdx] != "->")
+                fail("expected 'when <condition> [<fields>] -> <target>'");
+
+            const auto allowedTargets =
+                isErrorMachine ? TO_STATE | TO_RESTART
+                               : TO_STATE | TO_FINISH | TO_ERROR | TO_MACHINE;
+            detail::getCurrentlyBuiltState(context).conditions.push_back(
+                detail::ConditionalTransitionContext<BbT> {
+                    .condition = registry.getCondition(tokens[1]),
+                    .destination = parseTarget(
+                        tokens.subspan(arrowIdx + 1u), allowedTargets),
+                    .dependencies =
+                        arrowIdx == 3u ? getFields(tokens[2]) : FieldMask {},
+                });
+            stage = Stage::AfterCondition;
+        }
+
+        void parseExec(Tokens tokens)
+        {
+            if (stage != Stage::BeforePickingAnything
+                && stage != Stage::AfterCondition)
+                fail("'exec' must follow a state");
+
+            if (tokens.size() < 4u || tokens[2] != "->")
+                fail("expected 'exec <action> -> <target>'");
+
+            const auto allowedTargets =
+                isErrorMachine ? TO_STATE | TO_LOOP | TO_RESTART
+                               : TO_STATE | TO_LOOP | TO_FINISH | TO_MACHINE;
+            auto& state = detail::getCurrentlyBuiltState(context);
+            if (tokens[1] == "nothing")
+                state.action = doNothing;
+            else
+                state.action = registry.getAction(tokens[1]);
+            state.destination = parseTarget(tokens.subspan(3u), allowedTargets);
+            stage = Stage::StateDone;
+        }
+
+        [[nodiscard]] detail::TransitionContext
+        parseTarget(Tokens tokens, unsigned allowedTargets)
+        {
+            const auto kind = tokens[0];
+            const auto& machineName = context.currentlyBuiltMachine;
+
+            if (kind == "state" && tokens.size() == 2u
+                && (allowedTargets & TO_STATE))
+                return { .primary = detail::createFullStateName(
+                             machineName, getName(tokens[1])) };
+
+            if (kind == "loop" && tokens.size() == 1u
+                && (allowedTargets & TO_LOOP))
+                return { .primary = detail::createFullStateName(
+                             machineName,
+                             detail::getCurrentlyBuiltMachine(context)
+                                 .currentlyBuiltState) };
+
+            if (kind == "finish" && tokens.size() == 1u
+                && (allowedTargets & TO_FINISH))
+                return {};
+
+            if (kind == "error" && tokens.size() == 1u
+                && (allowedTargets & TO_ERROR))
+            {
+                if (!context.machines.contains(detail::ERROR_MACHINE_NAME))
+                    fail("'error' target requires an error machine");
+
+                return { .primary = detail::createFullStateName(
+                             detail::ERROR_MACHINE_NAME,
+                             context.machines.at(detail::ERROR_MACHINE_NAME)
+                                 .entryState) };
+            }
+
+            if (kind == "restart" && tokens.size() == 1u
+                && (allowedTargets & TO_RESTART))
+                return { .primary = detail::RESTART_METASTATE_TRANSITION };
+
+            if (kind == "machine" && (allowedTargets & TO_MACHINE)
+                && (tokens.size() == 2u
+                    || (tokens.size() == 4u && tokens[2] == "then")))
+                return parseMachineTarget(tokens);
+
+            fail(std::format("invalid transition target {}", kind));
+        }
+
+        [[nodiscard]] detail::TransitionContext
+        parseMachineTarget(Tokens tokens)
+        {
+            const auto target = getName(tokens[1]);
+            if (target == context.currentlyBuiltMachine)
+                fail("when transition to machine, you cannot re-enter the "
+                     "current machine");
+
+            auto&& itr = context.machines.find(target);
+            if (itr == context.machines.end())
+                fail(std::format(
+                    "trying to go to machine called {} that is not defined "
+                    "yet",
+                    target));
+
+            return {
+                .primary =
+                    detail::createFullStateName(target, itr->second.entryState),
+                .secondary = tokens.size() == 4u
+                                 ? detail::createFullStateName(
+                                       context.currentlyBuiltMachine,
+                                       getName(tokens[3]))
+                                 : std::string {},
+            };
+        }
+
+        void checkIsComplete()
+        {
+            if (!mainDeclared) fail("main machine is not declared");
+            checkStateIsDone();
+        }
+
+        void checkStateIsDone()
+        {
+            if (stage == Stage::BeforeEntryState)
+                fail(std::format(
+                    "machine {} has no states", context.currentlyBuiltMachine));
+
+            if (stage == Stage::BeforePickingAnything
+                || stage == Stage::AfterCondition)
+                fail(std::format(
+                    "state {} has no 'exec'",
+                    detail::getCurrentlyBuiltMachine(context)
+                        .currentlyBuiltState));
+        }
+
+        void checkStage(Stage expected, std::string_view directive)
+        {
+            if (stage != expected)
+                fail(std::format(
+                    "'{}' must directly follow 'state' or 'wait'", directive));
+        }
+
+        [[nodiscard]] std::string getName(std::string_view name)
+        {
+            if (name.starts_with("__"))
+                fail(std::format(
+                    "names starting with __ are reserved, got {}", name));
+
+            if (name.find(':') != std::string_view::npos)
+                fail(std::format("name {} cannot contain ':'", name));
+
+            return std::string(name);
+        }
+
+        [[nodiscard]] FieldMask getFields(std::string_view str)
+        {
+            const bool isHex = str.starts_with("0x") || str.starts_with("0X");
+            if (isHex) str.remove_prefix(2u);
+
+            FieldMask result = 0;
+            const auto [ptr, ec] = std::from_chars(
+                str.data(), str.data() + str.size(), result, isHex ? 16 : 10);
+
+            if (str.empty() || ec != std::errc()
+                || ptr != str.data() + str.size())
+                fail(std::format("invalid fields '{}'", str));
+
+            return result;
+        }
+
+        [[noreturn]] void fail(const std::string& message) const
+        {
+            throw Error(std::format(
+                "Line {} of the definition: {}", lineNumber, message));
+        }
+
+    private:
+        const CallableRegistry<BbT>& registry;
+        detail::BuilderContext<BbT> context;
+        Stage stage = Stage::NoMachine;
+        bool isErrorMachine = false;
+        bool mainDeclared = false;
+        size_t lineNumber = 0;
+    };
+} // namespace fsm
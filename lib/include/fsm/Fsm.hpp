@@ -1,27 +1,43 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <filesystem>
 #include <format>
+#include <fsm/BatchCursor.hpp>
+#include <fsm/CallableRegistry.hpp>
 #include <fsm/Error.hpp>
+#include <fsm/MappedFile.hpp>
+#include <fsm/TickContext.hpp>
 #include <fsm/Types.hpp>
+#include <fsm/detail/Analyzer.hpp>
 #include <fsm/detail/BuilderContext.hpp>
 #include <fsm/detail/Compiler.hpp>
 #include <fsm/detail/Helper.hpp>
+#include <fsm/detail/ModelSerializer.hpp>
+#include <fsm/detail/RetiringPointer.hpp>
 #include <fsm/detail/StateIndex.hpp>
 #include <fsm/logging/LoggerInterface.hpp>
 #include <fsm/logging/NullLogger.hpp>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ostream>
 #include <print>
 #include <ranges>
+#include <span>
 #include <string>
 #include <utility>
 #include <version>
 
 namespace fsm
 {
+    template<BlackboardTypeConcept BbT>
+    class VariantBuilder;
+
     /**
      * \brief Class representing hierarchical finite state machine
      *
@@ -45,12 +61,14 @@ namespace fsm
     public:
         Fsm(const detail::StateIndex& index,
             detail::BuilderContext<BbT>&& context)
-            : stateIdToName(index.getIndexedStateNames())
-            , states(detail::Compiler::compileMachine(context, index))
-            , errorStateEndIdx(detail::getErrorStatesCount(context) + 1)
-            , globalErrorTransition(
-                  detail::Compiler::compileGlobalErrorTransition<BbT>(
-                      context, index))
+            : currentModel(std::make_shared<detail::CompiledModel<BbT>>(
+                detail::Compiler::compileModel(context, index)))
+        {
+        }
+
+        explicit Fsm(detail::CompiledModel<BbT>&& model)
+            : currentModel(
+                std::make_shared<detail::CompiledModel<BbT>>(std::move(model)))
         {
         }
 
@@ -63,6 +81,36 @@ namespace fsm
         Fsm(Fsm&&) = delete;
         Fsm(const Fsm&) = delete;
 
+    public:
+        /**
+         * Load a model written by \see saveModel. Names of conditions and
+         * actions are bound to the callables of the registry.
+         *
+         * \throws fsm::Error if the data are not a valid model,
+         * the registry lacks a callable used by the model or the model
+         * does not fit into the state stack of a packed blackboard
+         */
+        [[nodiscard]] static Fsm loadModel(
+            std::span<const char> data, const CallableRegistry<BbT>& registry)
+        {
+            auto&& model = detail::ModelSerializer::load(data, registry);
+            if constexpr (PackedBlackboardTypeConcept<BbT>)
+                throwOnUnpackableModel(model);
+            return Fsm(std::move(model));
+        }
+
+        /**
+         * Map the file into memory and load the model from it,
+         * \see loadModel
+         */
+        [[nodiscard]] static Fsm loadModelFromFile(
+            const std::filesystem::path& path,
+            const CallableRegistry<BbT>& registry)
+        {
+            auto&& file = MappedFile(path);
+            return loadModel(file.getData(), registry);
+        }
+
     public:
         void setLogger(LoggerInterface& _logger)
         {
@@ -78,46 +126,167 @@ namespace fsm
          *
          * If global error condition was specified, it is evaluated before
          * evaluating the current state, possibly transitioning to the error
-         * machine.
+         * machine. Then the interrupts of all machines with a state
+         * on the stack are evaluated, starting with the outermost machine.
+         *
+         * In the 'run to behavior' mode (\see FinalBuilder::runToBehavior),
+         * the tick continues evaluating the new state after each conditional
+         * transition, until a behavior is executed or the step limit is hit.
+         *
+         * If the current state runs an async behavior that is suspended
+         * (\see StateBuilderBeforePickingAnything::execAsync), the tick
+         * only checks whether the awaited event happened and resumes
+         * the behavior if it did. Similarly, agent waiting for a condition
+         * (\see StateBuilderBeforePickingAnything::waitUntil) is not
+         * evaluated until a field the condition depends on is marked dirty.
+         * The global error condition and the interrupts are still evaluated
+         * for such agents, so they can preempt the wait.
          *
          * If the machine finished (\see isFinished), the function does nothing.
+         *
+         * \throws fsm::Error if a condition or action adapted
+         * by fsm::withContext or fsm::withParams requires a context that
+         * was not passed, before the blackboard is touched
          */
         void tick(BbT& blackboard)
         {
-            if (blackboard.__stateIdxs.empty()) return;
+            const auto& model = *currentModel.read();
+            checkContexts(model);
+            tickImpl(
+                model,
+                blackboard,
+                evaluateWorldInterrupts(model),
+                detail::TickClock());
+        }
 
-            auto start = std::chrono::high_resolution_clock::now();
+        /**
+         * Tick with contexts shared by all blackboards, conditions
+         * and actions adapted by fsm::withContext receive them. Passing
+         * an fsm::Archetype provides the params read by conditions
+         * and actions adapted by fsm::withParams.
+         *
+         * \throws fsm::Error if a condition or action requires a context
+         * of a type that was not passed, before the blackboard is touched
+         */
+        template<class... CtxTs>
+            requires(sizeof...(CtxTs) > 0)
+        void tick(BbT& blackboard, const CtxTs&... contexts)
+        {
+            auto&& guard = detail::TickContextGuard<CtxTs...>(contexts...);
+            tick(blackboard);
+        }
 
-            auto currentStateIdx = detail::popTopState(blackboard);
-            assert(currentStateIdx < states.size());
-            auto& state = states[currentStateIdx];
+        /**
+         * Tick every blackboard of a batch once. Agents that are suspended
+         * by an async behavior or by waiting for a condition whose
+         * dependencies are clean are skipped without being touched,
+         * unless the machine has a global error condition or interrupts
+         * that could preempt them.
+         *
+         * World interrupts (\see FinalBuilder::withWorldInterrupt) are
+         * evaluated only once for the whole batch.
+         *
+         * \return Number of blackboards that were ticked
+         */
+        size_t tickAll(std::span<BbT> blackboards)
+        {
+            const auto& model = *currentModel.read();
+            checkContexts(model);
+            const auto worldInterrupts = evaluateWorldInterrupts(model);
+            const bool preemptible = isPreemptible(model, worldInterrupts);
+            const auto clock = detail::TickClock();
 
-            auto log = [&](const std::string& message,
-                           const std::string& targetStateName)
+            size_t tickCount = 0;
+            for (auto& blackboard : blackboards)
             {
-                auto duration =
-                    std::chrono::duration_cast<std::chrono::microseconds>(
-                        std::chrono::high_resolution_clock::now() - start);
+                if (!preemptible && isSuspended(model, blackboard, clock))
+                    continue;
 
-                logger.get().log(
-                    reinterpret_cast<std::uintptr_t>(this),
-                    stateIdToName[currentStateIdx],
-                    blackboard,
-                    message,
-                    targetStateName,
-                    duration);
-            };
+                tickImpl(model, blackboard, worldInterrupts, clock);
+                ++tickCount;
+            }
+            return tickCount;
+        }
 
-#define _BIND(x) [&] { return x(blackboard, state); }
+        /**
+         * \see tickAll, conditions and actions adapted by fsm::withContext
+         * or fsm::withParams receive the contexts
+         */
+        template<class... CtxTs>
+            requires(sizeof...(CtxTs) > 0)
+        size_t
+        tickAll(std::span<BbT> blackboards, const CtxTs&... contexts)
+        {
+            auto&& guard = detail::TickContextGuard<CtxTs...>(contexts...);
+            return tickAll(blackboards);
+        }
 
-            std::optional<Log> result =
-                evaluateGlobalErrorCondition(blackboard, currentStateIdx)
-                    .or_else(_BIND(evaluateStateConditions))
-                    .or_else(_BIND(evaluateDefaultTransition));
+        /**
+         * Tick blackboards of a batch one by one, starting with the one
+         * the cursor points to, until the time budget is depleted or each
+         * blackboard was ticked once. The cursor is updated so the next call
+         * resumes with the first blackboard that was not ticked by this call.
+         *
+         * The clock is only read once per cursor.clockCheckInterval ticks,
+         * so the budget can be exceeded by up to that many ticks. World
+         * interrupts are evaluated once per call.
+         *
+         * \return Number of ticks performed
+         */
+        size_t tickWithBudget(
+            std::span<BbT> blackboards,
+            std::chrono::nanoseconds budget,
+            BatchCursor& cursor)
+        {
+            if (blackboards.empty()) return 0;
+            if (cursor.nextIdx >= blackboards.size()) cursor.nextIdx = 0;
 
-#undef _BIND
+            const auto& model = *currentModel.read();
+            checkContexts(model);
+            const auto clock =
+                detail::TickClock(std::chrono::steady_clock::now());
+            const auto deadline = clock.now() + budget;
+            const auto worldInterrupts = evaluateWorldInterrupts(model);
+            const auto checkInterval =
+                std::max(cursor.clockCheckInterval, size_t { 1 });
+            size_t tickCount = 0;
+
+            while (tickCount < blackboards.size())
+            {
+                tickImpl(
+                    model, blackboards[cursor.nextIdx], worldInterrupts, clock);
+                ++tickCount;
+
+                if (++cursor.nextIdx == blackboards.size())
+                {
+                    cursor.nextIdx = 0;
+                    ++cursor.completedPasses;
+                }
 
-            log(result.value().message, result.value().targetStateName);
+                if (tickCount >= cursor.minTicksPerCall
+                    && (tickCount - cursor.minTicksPerCall) % checkInterval
+                           == 0
+                    && std::chrono::steady_clock::now() >= deadline)
+                    break;
+            }
+
+            return tickCount;
+        }
+
+        /**
+         * \see tickWithBudget, conditions and actions adapted
+         * by fsm::withContext or fsm::withParams receive the contexts
+         */
+        template<class... CtxTs>
+            requires(sizeof...(CtxTs) > 0)
+        size_t tickWithBudget(
+            std::span<BbT> blackboards,
+            std::chrono::nanoseconds budget,
+            BatchCursor& cursor,
+            const CtxTs&... contexts)
+        {
+            auto&& guard = detail::TickContextGuard<CtxTs...>(contexts...);
+            return tickWithBudget(blackboards, budget, cursor);
         }
 
         /**
@@ -133,64 +302,400 @@ namespace fsm
         /**
          * Check if the machine is in error submachine.
          */
-        [[nodiscard]] constexpr bool
-        isErrored(const BbT& blackboard) const noexcept
+        [[nodiscard]] bool isErrored(const BbT& blackboard) const noexcept
         {
             return !blackboard.__stateIdxs.empty()
-                   && isErrorStateIdx(blackboard.__stateIdxs.back());
+                   && isErrorStateIdx(
+                       *currentModel.read(), blackboard.__stateIdxs.back());
+        }
+
+        /**
+         * Write the compiled model in a compact binary format, so it can
+         * be loaded without running the builder (\see loadModel).
+         *
+         * \throws fsm::Error if a condition or action was not taken
+         * from fsm::CallableRegistry, or the model uses features that
+         * cannot be saved (switches, async behaviors, world interrupts)
+         */
+        void saveModel(std::ostream& out) const
+        {
+            auto&& data = detail::ModelSerializer::save(*currentModel.read());
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!out) throw Error("Cannot write the model");
+        }
+
+        /**
+         * Replace the model with the model of the source machine, typically
+         * a rebuilt version of this one. The source machine is left empty
+         * and must not be used afterwards.
+         *
+         * Blackboards are remapped on their next tick. Each state on their
+         * stack is looked up by its full name ("machine:state") in the new
+         * model. If any of them no longer exists, the blackboard restarts
+         * from the entry state of the main machine. Async behaviors
+         * and waiting for conditions are cancelled either way. Blackboards
+         * that were never ticked are not remapped, they start from the entry
+         * state of the new model.
+         *
+         * Machine can be reloaded while other threads tick it, even from
+         * an action of a running tick. Ticks that already started finish
+         * with the old model, which is kept alive until this machine
+         * is destroyed, so the function never waits for them and ticks
+         * pay no synchronization beyond reading the model pointer.
+         *
+         * Only available for blackboards deriving from
+         * fsm::ReloadableBlackboard, which remembers the model that ticked
+         * the blackboard last.
+         */
+        void reload(Fsm&& source)
+            requires ReloadableBlackboardTypeConcept<BbT>
+        {
+            auto&& lock = std::lock_guard(reloadMutex);
+            auto&& next = source.currentModel.exchange(nullptr);
+            if (!next) throw Error("Source machine was already reloaded from");
+
+            next->succeed(*currentModel.getForWriter());
+            std::ignore = currentModel.exchange(std::move(next));
         }
 
     private:
+        friend class VariantBuilder<BbT>;
+
         struct Log
         {
             std::string message;
             std::string targetStateName;
+            bool behaviorExecuted = false;
         };
 
     private:
-        std::optional<Log>
-        evaluateGlobalErrorCondition(BbT& blackboard, size_t currentStateIdx)
+        /**
+         * \return Current model, kept alive by the caller even after
+         * the machine is reloaded
+         */
+        [[nodiscard]] std::shared_ptr<const detail::CompiledModel<BbT>>
+        shareModel() const
+        {
+            auto&& lock = std::lock_guard(reloadMutex);
+            auto&& model = currentModel.getForWriter();
+            if (!model) throw Error("Machine was already reloaded from");
+            return model;
+        }
+
+        /**
+         * \param worldInterrupts i-th bit is set if the i-th global
+         * interrupt is a world interrupt and its condition is true
+         * \param clock Time of the tick, shared by all agents of a batch
+         */
+        void tickImpl(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            std::uint64_t worldInterrupts,
+            const detail::TickClock& clock)
+        {
+            if constexpr (ReloadableBlackboardTypeConcept<BbT>)
+            {
+                if (blackboard.__modelGeneration != model.generation)
+                    [[unlikely]]
+                    remapBlackboard(model, blackboard);
+            }
+
+            for (size_t step = 0; step < model.microstepLimit; ++step)
+            {
+                if (blackboard.__stateIdxs.empty()
+                    || executeMicrostep(
+                        model, blackboard, worldInterrupts, clock))
+                    return;
+            }
+        }
+
+        static void remapBlackboard(
+            const detail::CompiledModel<BbT>& model, BbT& blackboard)
+            requires ReloadableBlackboardTypeConcept<BbT>
         {
-            if (isErrorStateIdx(currentStateIdx)
-                || !globalErrorTransition.onConditionHit(blackboard))
+            // Untouched blackboard starts in the entry state of any model
+            if (blackboard.__modelGeneration == detail::NO_MODEL_GENERATION)
+            {
+                blackboard.__modelGeneration = model.generation;
+                return;
+            }
+
+            auto& stack = blackboard.__stateIdxs;
+            const auto age = model.generation - blackboard.__modelGeneration;
+            const bool remappable = blackboard.__modelGeneration
+                                        < model.generation
+                                    && age <= model.remapTables.size();
+
+            bool lost = !remappable;
+            if (remappable)
+            {
+                const auto& table = model.remapTables[age - 1];
+                for (size_t level = 0; level < stack.size() && !lost; ++level)
+                {
+                    const StateIdx stateIdx = stack[level];
+                    lost = stateIdx >= table.size()
+                           || table[stateIdx] == NO_STATE_IDX;
+                    if (!lost) stack[level] = table[stateIdx];
+                }
+            }
+
+            if (lost) stack.assign(1u, StateIdx {});
+
+            blackboard.__asyncBehavior.behavior.reset();
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+            {
+                blackboard.__dirtyFields = ALL_FIELDS;
+                blackboard.__checkedStateIdx = NO_STATE_IDX;
+                blackboard.__waitedFields = 0;
+            }
+            blackboard.__modelGeneration = model.generation;
+        }
+
+        /**
+         * Called once per tick (or batch) before any blackboard is touched,
+         * so callables can read their contexts without checking them.
+         *
+         * \throws fsm::Error if the tick was not passed a context read
+         * by a callable of the model
+         */
+        static void checkContexts(const detail::CompiledModel<BbT>& model)
+        {
+            for (auto&& check : model.contextChecks)
+                check();
+        }
+
+        [[nodiscard]] static std::uint64_t
+        evaluateWorldInterrupts(const detail::CompiledModel<BbT>& model)
+        {
+            std::uint64_t result = 0;
+            for (size_t idx = 0; idx < model.globalInterrupts.size(); ++idx)
+            {
+                const auto& condition =
+                    model.globalInterrupts[idx].worldCondition;
+                if (condition && condition())
+                    result |= std::uint64_t { 1 } << idx;
+            }
+            return result;
+        }
+
+        /**
+         * Evaluate the current state once.
+         *
+         * \return Whether a behavior was executed
+         */
+        bool executeMicrostep(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            std::uint64_t worldInterrupts,
+            const detail::TickClock& clock)
+        {
+            // Suspended agent is not evaluated until its awaited event,
+            // unless it can be preempted
+            const bool suspended = isSuspended(model, blackboard, clock);
+            if (suspended && !isPreemptible(model, worldInterrupts))
+                return true;
+
+            const bool logging = isLoggingEnabled();
+            const auto start =
+                logging ? std::chrono::high_resolution_clock::now()
+                        : std::chrono::high_resolution_clock::time_point();
+
+            auto currentStateIdx = detail::popTopState(blackboard);
+            assert(currentStateIdx < model.slots.size());
+            const auto& slot = model.slots[currentStateIdx];
+            bool inputsTracked = false;
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+                inputsTracked =
+                    std::exchange(blackboard.__checkedStateIdx, NO_STATE_IDX)
+                    == currentStateIdx;
+
+            auto log = [&](const std::string& message,
+                           const std::string& targetStateName)
+            {
+                auto duration =
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::high_resolution_clock::now() - start);
+
+                logger.get().log(
+                    reinterpret_cast<std::uintptr_t>(this),
+                    (*model.stateIdToName)[currentStateIdx],
+                    blackboard,
+                    message,
+                    targetStateName,
+                    duration);
+            };
+
+#define _BIND(x) [&] { return x(model, blackboard, slot); }
+
+            std::optional<Log> result =
+                evaluateGlobalErrorCondition(
+                    model, blackboard, currentStateIdx)
+                    .or_else(
+                        [&] {
+                            return evaluateGlobalInterrupts(
+                                model,
+                                blackboard,
+                                currentStateIdx,
+                                worldInterrupts);
+                        })
+                    .or_else(
+                        [&] {
+                            return evaluateInterrupts(
+                                model, blackboard, currentStateIdx);
+                        });
+
+            if (!result && suspended)
+            {
+                blackboard.__stateIdxs.push_back(currentStateIdx);
+                if constexpr (TrackedBlackboardTypeConcept<BbT>)
+                {
+                    if (inputsTracked)
+                        blackboard.__checkedStateIdx = currentStateIdx;
+                }
+                return true;
+            }
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+                blackboard.__waitedFields = 0;
+
+            result =
+                std::move(result)
+                    .or_else(
+                        [&] {
+                            return evaluateWaitCondition(
+                                model, blackboard, slot, currentStateIdx);
+                        })
+                    .or_else(_BIND(evaluateSwitch))
+                    .or_else(
+                        [&] {
+                            return evaluateStateConditions(
+                                model,
+                                blackboard,
+                                slot,
+                                currentStateIdx,
+                                inputsTracked);
+                        })
+                    .or_else(
+                        [&] {
+                            return evaluateAsyncBehavior(
+                                model, blackboard, slot, currentStateIdx);
+                        })
+                    .or_else(_BIND(evaluateDefaultTransition));
+
+#undef _BIND
+
+            if (logging)
+                log(result.value().message, result.value().targetStateName);
+
+            return result.value().behaviorExecuted;
+        }
+
+        static std::optional<Log> evaluateGlobalErrorCondition(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            StateIdx currentStateIdx)
+        {
+            if (!model.globalErrorTransition.onConditionHit
+                || isErrorStateIdx(model, currentStateIdx)
+                || !model.globalErrorTransition.onConditionHit(blackboard))
                 return std::nullopt;
 
             blackboard.__stateIdxs.clear();
+            blackboard.__asyncBehavior.behavior.reset();
             detail::executeTransition(
-                blackboard, globalErrorTransition.transition);
+                blackboard, model.globalErrorTransition.transition);
 
             return Log {
                 .message = "Global error condition hit",
                 .targetStateName = getTransitionLog(
-                    globalErrorTransition.transition, blackboard),
+                    model, model.globalErrorTransition.transition, blackboard),
             };
         }
 
-        std::optional<Log> evaluateStateConditions(
-            BbT& blackboard, const detail::CompiledState<BbT>& state)
+        /**
+         * Evaluate global interrupts in the order of priority, up to
+         * the first interrupt whose submachine is already on the stack.
+         */
+        static std::optional<Log> evaluateGlobalInterrupts(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            StateIdx currentStateIdx,
+            std::uint64_t worldInterrupts)
         {
-#ifdef __cpp_lib_ranges_enumerate
-            for (const auto& [idx, condition] :
-                 std::views::enumerate(state.conditionalTransitions))
-#else
-            for (const auto& [idx, condition] : std::views::zip(
-                     std::views::iota(0u, state.conditionalTransitions.size()),
-                     state.conditionalTransitions))
-#endif
+            if ((worldInterrupts == 0 && !model.hasAgentGlobalInterrupts)
+                || isErrorStateIdx(model, currentStateIdx))
+                return std::nullopt;
+
+            // Current state was already popped from the stack
+            const auto& limits = model.globalInterruptLimits;
+            auto limit = limits[model.slots[currentStateIdx].machineIdx];
+            const auto& stack = blackboard.__stateIdxs;
+            for (size_t level = 0; level < stack.size(); ++level)
+                limit = std::min(
+                    limit, limits[model.slots[stack[level]].machineIdx]);
+
+            for (size_t idx = 0; idx < limit; ++idx)
             {
-                if (condition.onConditionHit(blackboard))
+                const auto& interrupt = model.globalInterrupts[idx];
+                const bool hit = interrupt.worldCondition
+                                     ? ((worldInterrupts >> idx) & 1u) != 0
+                                     : interrupt.condition(blackboard);
+                if (!hit) continue;
+
+                blackboard.__stateIdxs.clear();
+                blackboard.__asyncBehavior.behavior.reset();
+                detail::executeTransition(blackboard, interrupt.transition);
+
+                return Log {
+                    .message = std::format("Global interrupt {} hit", idx),
+                    .targetStateName = getTransitionLog(
+                        model, interrupt.transition, blackboard),
+                };
+            }
+
+            return std::nullopt;
+        }
+
+        /**
+         * Evaluate interrupts of each machine on the state stack, outermost
+         * first. When an interrupt is hit, the states of the interrupted
+         * machine and of its submachines are dropped from the stack.
+         */
+        static std::optional<Log> evaluateInterrupts(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            StateIdx currentStateIdx)
+        {
+            if (!model.hasInterrupts) return std::nullopt;
+
+            // Current state was already popped from the stack
+            auto& stack = blackboard.__stateIdxs;
+            for (size_t level = 0; level <= stack.size(); ++level)
+            {
+                const auto levelStateIdx =
+                    level < stack.size() ? stack[level] : currentStateIdx;
+
+                const auto& interrupts = model.machineInterrupts
+                    [model.slots[levelStateIdx].machineIdx];
+                for (const auto& interrupt : interrupts)
                 {
-                    if (isErrorTransition(condition.transition))
-                    {
-                        blackboard.__stateIdxs.clear();
-                    }
+                    const auto& transition = interrupt.transition;
+                    if (transition.getSize() == 1u
+                        && transition[0] == levelStateIdx)
+                        continue;
+
+                    if (!interrupt.onConditionHit(blackboard)) continue;
 
-                    detail::executeTransition(blackboard, condition.transition);
+                    stack.resize(level);
+                    if (isErrorTransition(model, transition)) stack.clear();
+
+                    blackboard.__asyncBehavior.behavior.reset();
+                    detail::executeTransition(blackboard, transition);
 
                     return Log {
-                        .message = std::format("Condition {} hit", idx),
+                        .message = std::format(
+                            "Interrupt {} hit", interrupt.declarationIdx),
                         .targetStateName =
-                            getTransitionLog(condition.transition, blackboard),
+                            getTransitionLog(model, transition, blackboard),
                     };
                 }
             }
@@ -198,49 +703,305 @@ namespace fsm
             return std::nullopt;
         }
 
-        std::optional<Log> evaluateDefaultTransition(
-            BbT& blackboard, const detail::CompiledState<BbT>& state)
+        /**
+         * If the wait condition of the state is false, keep the state
+         * on the top of the stack and park the agent until the condition
+         * dependencies are marked dirty. Untracked blackboards evaluate
+         * the condition again on the next tick.
+         */
+        static std::optional<Log> evaluateWaitCondition(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            const detail::StateSlot<BbT>& slot,
+            StateIdx currentStateIdx)
+        {
+            const auto* extras = slot.extras;
+            if (!extras || !extras->waitCondition
+                || extras->waitCondition(blackboard))
+                return std::nullopt;
+
+            blackboard.__stateIdxs.push_back(currentStateIdx);
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+            {
+                blackboard.__dirtyFields = 0;
+                blackboard.__waitedFields = extras->waitDependencies;
+            }
+
+            return Log {
+                .message = "Waiting for condition",
+                .targetStateName = (*model.stateIdToName)[currentStateIdx],
+                .behaviorExecuted = true,
+            };
+        }
+
+        static std::optional<Log> evaluateSwitch(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            const detail::StateSlot<BbT>& slot)
+        {
+            if (!slot.extras) return std::nullopt;
+
+            const auto* switchCase =
+                slot.extras->switchTable.findCase(blackboard);
+            if (!switchCase) return std::nullopt;
+
+            return executeConditionalTransition(
+                model, blackboard, *switchCase, slot.offset);
+        }
+
+        /**
+         * \param inputsTracked Whether all conditions of this state were
+         * false when the dirty fields were cleared. Conditions whose
+         * dependencies were not written since are skipped. Always false
+         * for untracked blackboards.
+         */
+        static std::optional<Log> evaluateStateConditions(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            const detail::StateSlot<BbT>& slot,
+            StateIdx currentStateIdx,
+            bool inputsTracked)
+        {
+            for (const auto& condition : slot.state->conditionalTransitions)
+            {
+                if constexpr (TrackedBlackboardTypeConcept<BbT>)
+                {
+                    if (inputsTracked && condition.dependencies != 0
+                        && (condition.dependencies & blackboard.__dirtyFields)
+                               == 0)
+                        continue;
+                }
+
+                if (condition.onConditionHit(blackboard))
+                    return executeConditionalTransition(
+                        model, blackboard, condition, slot.offset);
+            }
+
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+            {
+                blackboard.__dirtyFields = 0;
+                blackboard.__checkedStateIdx = currentStateIdx;
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * \param offset Added to the state indices of the transition
+         */
+        static Log executeConditionalTransition(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            const detail::CompiledConditionalTransition<BbT>& condition,
+            size_t offset)
+        {
+            if (isErrorTransition(model, condition.transition, offset))
+            {
+                blackboard.__stateIdxs.clear();
+            }
+
+            // Leaving the state cancels its async behavior
+            blackboard.__asyncBehavior.behavior.reset();
+
+            detail::executeTransition(
+                blackboard, condition.transition, offset);
+
+            return Log {
+                .message =
+                    std::format("Condition {} hit", condition.declarationIdx),
+                .targetStateName = getTransitionLog(
+                    model, condition.transition, blackboard, offset),
+            };
+        }
+
+        /**
+         * Start or resume the async behavior of the state. While it
+         * is not finished, the state stays on the top of the stack.
+         */
+        static std::optional<Log> evaluateAsyncBehavior(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            const detail::StateSlot<BbT>& slot,
+            StateIdx currentStateIdx)
+        {
+            if (!slot.extras || !slot.extras->startAsyncBehavior)
+                return std::nullopt;
+
+            auto& behavior = blackboard.__asyncBehavior.behavior;
+            if (behavior.isRunning())
+            {
+                behavior.resume();
+            }
+            else
+                behavior = slot.extras->startAsyncBehavior(blackboard);
+
+            if (!behavior.isRunning())
+            {
+                behavior.finish();
+                return std::nullopt;
+            }
+
+            blackboard.__stateIdxs.push_back(currentStateIdx);
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+                parkAsyncBehavior(blackboard);
+            return Log {
+                .message = "Async behavior suspended",
+                .targetStateName = (*model.stateIdToName)[currentStateIdx],
+                .behaviorExecuted = true,
+            };
+        }
+
+        static std::optional<Log> evaluateDefaultTransition(
+            const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            const detail::StateSlot<BbT>& slot)
         {
+            const auto& state = *slot.state;
             state.executeBehavior(blackboard);
-            detail::executeTransition(blackboard, state.defaultTransition);
+            detail::executeTransition(
+                blackboard, state.defaultTransition, slot.offset);
 
             return Log {
                 .message = "Behavior executed",
-                .targetStateName =
-                    getTransitionLog(state.defaultTransition, blackboard),
+                .targetStateName = getTransitionLog(
+                    model, state.defaultTransition, blackboard, slot.offset),
+                .behaviorExecuted = true,
             };
         }
 
-        std::string getTransitionLog(
-            const detail::CompiledTransition& transition, const BbT& blackboard)
+        /**
+         * If the suspended async behavior waits for a predicate with
+         * dependencies, do not evaluate the predicate again until one
+         * of them is marked dirty.
+         */
+        static void parkAsyncBehavior(BbT& blackboard)
+            requires TrackedBlackboardTypeConcept<BbT>
+        {
+            const auto& behavior = blackboard.__asyncBehavior.behavior;
+            if (!behavior.isRunning()) return;
+
+            blackboard.__waitedFields = behavior.getWaitedFields();
+            if (blackboard.__waitedFields == 0) return;
+
+            // Conditions tracking these fields must not miss the writes
+            // that are consumed by the predicate
+            blackboard.__dirtyFields = 0;
+            blackboard.__checkedStateIdx = NO_STATE_IDX;
+        }
+
+        /**
+         * Whether the global error condition or an interrupt can preempt
+         * a suspended agent
+         */
+        [[nodiscard]] static bool isPreemptible(
+            const detail::CompiledModel<BbT>& model,
+            std::uint64_t worldInterrupts) noexcept
+        {
+            return model.globalErrorTransition.onConditionHit
+                   || model.hasAgentGlobalInterrupts || worldInterrupts != 0
+                   || model.hasInterrupts;
+        }
+
+        /**
+         * Async behavior whose predicate was evaluated because its
+         * dependencies were dirty, but is still false, is parked again.
+         * Untracked blackboards evaluate the predicate on every tick.
+         */
+        [[nodiscard]] static bool isSuspended(
+            [[maybe_unused]] const detail::CompiledModel<BbT>& model,
+            BbT& blackboard,
+            const detail::TickClock& clock)
         {
+            // Blackboard of an older model must be remapped first
+            if constexpr (ReloadableBlackboardTypeConcept<BbT>)
+            {
+                if (blackboard.__modelGeneration != model.generation)
+                    return false;
+            }
+
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+            {
+                if (blackboard.__waitedFields != 0
+                    && (blackboard.__dirtyFields & blackboard.__waitedFields)
+                           == 0)
+                    return true;
+            }
+
+            if (!blackboard.__asyncBehavior.behavior.isWaiting(clock))
+                return false;
+
+            if constexpr (TrackedBlackboardTypeConcept<BbT>)
+                parkAsyncBehavior(blackboard);
+            return true;
+        }
+
+        [[nodiscard]] bool isLoggingEnabled() const noexcept
+        {
+            return &logger.get() != &defaultLogger;
+        }
+
+        static std::string getTransitionLog(
+            const detail::CompiledModel<BbT>& model,
+            const detail::CompiledTransition& transition,
+            const BbT& blackboard,
+            size_t offset = 0)
+        {
+            const auto& stateIdToName = *model.stateIdToName;
             if (transition.isEmpty())
                 if (blackboard.__stateIdxs.empty())
                     return "Finishing";
                 else
                     return stateIdToName[blackboard.__stateIdxs.back()];
             else if (transition.getSize() == 1u)
-                return stateIdToName[transition[0]];
-            return stateIdToName[transition[0]];
+                return stateIdToName[transition[0] + offset];
+            return stateIdToName[transition[0] + offset];
+        }
+
+        /**
+         * Loaded model skips the checks of fsm::FinalBuilder::build,
+         * so it is validated against the packed state stack here
+         */
+        static void
+        throwOnUnpackableModel(const detail::CompiledModel<BbT>& model)
+        {
+            using PackedStateStack = typename BbT::PackedStateStack;
+
+            if (model.slots.size() > PackedStateStack::MAX_INDEX)
+                throw Error(std::format(
+                    "Packed blackboard with {}-bit indices can index at most "
+                    "{} states, but the model has {}",
+                    PackedStateStack::INDEX_BITS,
+                    PackedStateStack::MAX_INDEX,
+                    model.slots.size()));
+
+            auto&& depth = detail::Analyzer::getMaxStackDepth(
+                model, PackedStateStack::CAPACITY);
+            if (!depth)
+                throw Error(std::format(
+                    "Packed blackboard with {}-bit indices can hold at most "
+                    "{} nested states, but the model can nest deeper",
+                    PackedStateStack::INDEX_BITS,
+                    PackedStateStack::CAPACITY));
         }
 
-        [[nodiscard]] constexpr bool isErrorStateIdx(size_t idx) const noexcept
+        [[nodiscard]] static constexpr bool isErrorStateIdx(
+            const detail::CompiledModel<BbT>& model, size_t idx) noexcept
         {
-            return 0 < idx && idx < errorStateEndIdx;
+            return 0 < idx && idx < model.errorStateEndIdx;
         }
 
-        [[nodiscard]] constexpr bool isErrorTransition(
-            const detail::CompiledTransition& transition) const noexcept
+        [[nodiscard]] static constexpr bool isErrorTransition(
+            const detail::CompiledModel<BbT>& model,
+            const detail::CompiledTransition& transition,
+            size_t offset = 0) noexcept
         {
-            return transition.getSize() == 1u && isErrorStateIdx(transition[0]);
+            return transition.getSize() == 1u
+                   && isErrorStateIdx(model, transition[0] + offset);
         }
 
     private:
         NullLogger defaultLogger = NullLogger();
         std::reference_wrapper<LoggerInterface> logger = defaultLogger;
-        std::vector<std::string> stateIdToName;
-        std::vector<detail::CompiledState<BbT>> states;
-        size_t errorStateEndIdx = 0;
-        detail::CompiledConditionalTransition<BbT> globalErrorTransition;
+        detail::RetiringPointer<detail::CompiledModel<BbT>> currentModel;
+        mutable std::mutex reloadMutex;
     };
 } // namespace fsm
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace fsm
+{
+    /**
+     * \brief Read-only view of a whole file
+     *
+     * On POSIX systems the file is memory-mapped and the kernel is hinted
+     * that it will be read sequentially, so its contents are never copied
+     * into the process. Elsewhere the file is read into a buffer.
+     *
+     * The data are valid as long as the MappedFile exists. Pass them
+     * to a blackboard as a view or to fsm::StreamDriver::run.
+     */
+    class [[nodiscard]] MappedFile final
+    {
+    public:
+        /**
+         * \throws fsm::Error if the file cannot be opened or mapped
+         */
+        explicit MappedFile(const std::filesystem::path& path);
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+    public:
+        [[nodiscard]] constexpr std::span<const char> getData() const noexcept
+        {
+            return { data, size };
+        }
+
+    private:
+        void unmap() noexcept;
+
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+        std::vector<char> fallbackBuffer;
+    };
+} // namespace fsm
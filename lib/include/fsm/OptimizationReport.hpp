@@ -0,0 +1,23 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fsm
+{
+    /**
+     * \brief Summary of changes done by the graph optimizer
+     *
+     * \see FinalBuilder::optimize
+     */
+    struct [[nodiscard]] OptimizationReport
+    {
+        // Full names of states that could never be entered
+        std::vector<std::string> removedStates;
+
+        // Full names of collapsed or deduplicated states, mapped to the full
+        // name of the state that took over their role
+        std::map<std::string, std::string> mergedStates;
+    };
+} // namespace fsm
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <fsm/ByteFsm.hpp>
+#include <fsm/Error.hpp>
+#include <fsm/Types.hpp>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace fsm
+{
+    /**
+     * \brief Processes a large input with a fsm::ByteFsm on multiple threads
+     *
+     * The input is split into segments and each segment is processed
+     * on its own thread with its own copy of the blackboard. The caller
+     * then combines the blackboards, which are returned in input order.
+     *
+     * Actions in different segments run concurrently, so they must only
+     * touch their own blackboard.
+     */
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] ParallelDriver final
+    {
+    public:
+        /**
+         * \param machine  Machine to drive, must outlive the driver
+         * \param threadCount  Number of segments the input is split into
+         */
+        explicit ParallelDriver(
+            const ByteFsm<BbT>& machine,
+            size_t threadCount = std::thread::hardware_concurrency())
+            : machine(machine), threadCount(std::max<size_t>(threadCount, 1u))
+        {
+        }
+
+    public:
+        /**
+         * Speculative processing. Each segment is first walked from every
+         * state of the machine without executing actions. The walks are
+         * cheap and independent, so they run in parallel. Chaining their
+         * results then tells in which state and with what partial token
+         * each segment starts, and the segments are processed with actions
+         * in parallel again.
+         *
+         * The result is the same as if the whole input was processed by
+         * a single blackboard: tokens crossing segment boundaries are
+         * passed whole to the action in the segment where they end and
+         * an error stops processing of all following segments.
+         *
+         * Every segment but the first and the last is walked once per
+         * state, so this only pays off for machines with few states.
+         * Prefer runWithSyncByte when the input has a synchronization byte.
+         *
+         * \param prototype  Blackboard each segment starts with, its state
+         *                   and pending token are used for the first segment
+         * \throws Whatever an action throws, after all threads finish
+         */
+        std::vector<BbT> run(std::span<const char> input, const BbT& prototype)
+        {
+            const auto&& segments = splitEvenly(toView(input));
+
+            // Start state of the first segment is known and the walk
+            // of the last one would never be read
+            auto&& walks =
+                std::vector<std::vector<WalkResult>>(segments.size() - 1u);
+            forEachSegmentInParallel(
+                walks.size(),
+                [&](size_t segmentIdx)
+                {
+                    if (segmentIdx == 0)
+                    {
+                        walks[0].push_back(machine.walk(
+                            prototype.__byteStateIdx, segments[0]));
+                        return;
+                    }
+
+                    for (size_t stateIdx = 0;
+                         stateIdx < machine.getStateCount();
+                         ++stateIdx)
+                        walks[segmentIdx].push_back(
+                            machine.walk(stateIdx, segments[segmentIdx]));
+                });
+
+            auto&& blackboards = std::vector<BbT>(segments.size(), prototype);
+            for (size_t segmentIdx = 1; segmentIdx < segments.size();
+                 ++segmentIdx)
+            {
+                const auto& previous = blackboards[segmentIdx - 1];
+                auto& current = blackboards[segmentIdx];
+                const auto& segment = segments[segmentIdx - 1];
+
+                if (machine.isErrored(previous))
+                {
+                    current.__byteStateIdx = previous.__byteStateIdx;
+                    continue;
+                }
+
+                const auto& walk =
+                    segmentIdx == 1
+                        ? walks[0].front()
+                        : walks[segmentIdx - 1][previous.__byteStateIdx];
+                current.__byteStateIdx = walk.endStateIdx;
+                current.__pendingToken =
+                    walk.lastTokenStart
+                        ? std::string(segment.substr(*walk.lastTokenStart))
+                        : previous.__pendingToken + std::string(segment);
+            }
+
+            processSegments(segments, blackboards);
+            return blackboards;
+        }
+
+        /**
+         * Processing with a synchronization byte. Segment boundaries are
+         * moved right after the next occurrence of the synchronization byte
+         * (for example a newline) and every segment but the first starts
+         * in the entry state with an empty token.
+         *
+         * This is only correct if the machine is always in the entry state
+         * with an empty token after reading the synchronization byte,
+         * but it skips the speculative walks. Errors do not propagate
+         * between segments, each blackboard has to be checked.
+         *
+         * \throws Whatever an action throws, after all threads finish
+         */
+        std::vector<BbT> runWithSyncByte(
+            std::span<const char> input, char syncByte, const BbT& prototype)
+        {
+            const auto&& segments =
+                splitAfterSyncByte(toView(input), syncByte);
+
+            auto&& blackboards = std::vector<BbT>(segments.size(), prototype);
+            for (size_t segmentIdx = 1; segmentIdx < segments.size();
+                 ++segmentIdx)
+            {
+                blackboards[segmentIdx].__byteStateIdx = 0;
+                blackboards[segmentIdx].__pendingToken.clear();
+            }
+
+            processSegments(segments, blackboards);
+            return blackboards;
+        }
+
+    private:
+        using WalkResult = typename ByteFsm<BbT>::WalkResult;
+
+    private:
+        [[nodiscard]] size_t
+        getSegmentSize(std::string_view input) const noexcept
+        {
+            return std::max<size_t>(
+                (input.size() + threadCount - 1) / threadCount, 1u);
+        }
+
+        [[nodiscard]] static std::string_view
+        toView(std::span<const char> input) noexcept
+        {
+            return std::string_view(input.data(), input.size());
+        }
+
+        [[nodiscard]] std::vector<std::string_view>
+        splitEvenly(std::string_view input) const
+        {
+            const auto segmentSize = getSegmentSize(input);
+
+            auto&& segments = std::vector<std::string_view> {};
+            for (size_t pos = 0; pos < input.size(); pos += segmentSize)
+                segments.push_back(input.substr(pos, segmentSize));
+
+            if (segments.empty()) segments.push_back(input);
+            return segments;
+        }
+
+        [[nodiscard]] std::vector<std::string_view>
+        splitAfterSyncByte(std::string_view input, char syncByte) const
+        {
+            const auto segmentSize = getSegmentSize(input);
+
+            auto&& segments = std::vector<std::string_view> {};
+            size_t start = 0;
+
+            while (start < input.size())
+            {
+                auto end = input.find(syncByte, start + segmentSize - 1);
+                end = end == std::string_view::npos ? input.size() : end + 1;
+
+                segments.push_back(input.substr(start, end - start));
+                start = end;
+            }
+
+            if (segments.empty()) segments.push_back(input);
+            return segments;
+        }
+
+        void processSegments(
+            const std::vector<std::string_view>& segments,
+            std::vector<BbT>& blackboards) const
+        {
+            forEachSegmentInParallel(
+                segments.size(),
+                [&](size_t segmentIdx)
+                {
+                    auto& blackboard = blackboards[segmentIdx];
+                    machine.process(blackboard, segments[segmentIdx]);
+
+                    // Partial token at the end of a segment is handed over
+                    // to the next segment
+                    if (segmentIdx + 1 < segments.size())
+                        blackboard.__pendingToken.clear();
+                    else
+                        machine.finish(blackboard);
+                });
+        }
+
+        /**
+         * Exception thrown on a worker thread is rethrown on the calling
+         * thread once all threads are joined, the one of the earliest
+         * segment wins
+         */
+        template<class Fn>
+        static void forEachSegmentInParallel(size_t segmentCount, Fn&& fn)
+        {
+            auto&& errors = std::vector<std::exception_ptr>(segmentCount);
+
+            {
+                auto&& threads = std::vector<std::jthread> {};
+                threads.reserve(segmentCount);
+
+                for (size_t segmentIdx = 0; segmentIdx < segmentCount;
+                     ++segmentIdx)
+                    threads.emplace_back(
+                        [&fn, &errors, segmentIdx]
+                        {
+                            try
+                            {
+                                fn(segmentIdx);
+                            }
+                            catch (...)
+                            {
+                                errors[segmentIdx] = std::current_exception();
+                            }
+                        });
+            }
+
+            for (auto&& error : errors)
+            {
+                if (error) std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        const ByteFsm<BbT>& machine;
+        size_t threadCount;
+    };
+} // namespace fsm
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace fsm
+{
+    /**
+     * \brief Runtime statistics of a FSM
+     *
+     * Stores how many times each state was ticked, how many times
+     * each transition between two states was taken and how many times
+     * each condition of a state was hit. States are identified by their
+     * full names, as they appear in the logs, conditions by their
+     * declaration index within the state.
+     *
+     * Profile is usually collected with fsm::ProfilingLogger, saved
+     * to a file and passed to fsm::FinalBuilder::withProfile during
+     * subsequent builds of the same FSM.
+     */
+    class [[nodiscard]] Profile final
+    {
+    public:
+        using TransitionKey = std::pair<std::string, std::string>;
+        using ConditionKey = std::pair<std::string, size_t>;
+
+    public:
+        void recordTick(const std::string& stateName);
+
+        void recordTransition(
+            const std::string& sourceStateName,
+            const std::string& targetStateName);
+
+        void recordConditionHit(
+            const std::string& stateName, size_t conditionDeclarationIdx);
+
+        [[nodiscard]] size_t
+        getTickCount(const std::string& stateName) const noexcept;
+
+        [[nodiscard]] size_t getTransitionCount(
+            const std::string& sourceStateName,
+            const std::string& targetStateName) const noexcept;
+
+        [[nodiscard]] size_t getConditionHitCount(
+            const std::string& stateName,
+            size_t conditionDeclarationIdx) const noexcept;
+
+        [[nodiscard]] constexpr const std::map<std::string, size_t>&
+        getTickCounts() const noexcept
+        {
+            return tickCounts;
+        }
+
+        [[nodiscard]] constexpr const std::map<TransitionKey, size_t>&
+        getTransitionCounts() const noexcept
+        {
+            return transitionCounts;
+        }
+
+        [[nodiscard]] constexpr const std::map<ConditionKey, size_t>&
+        getConditionHitCounts() const noexcept
+        {
+            return conditionHitCounts;
+        }
+
+        /**
+         * Add all counts from other profile to this one. Useful when
+         * the profile is collected from multiple runs.
+         */
+        void merge(const Profile& other);
+
+        /**
+         * Write the profile in a line-based text format, one record
+         * per line with tab-separated fields.
+         */
+        void save(std::ostream& stream) const;
+
+        void saveToFile(const std::filesystem::path& path) const;
+
+        /**
+         * Read profile written by save().
+         *
+         * \throws fsm::Error if the input is malformed
+         */
+        [[nodiscard]] static Profile load(std::istream& stream);
+
+        [[nodiscard]] static Profile
+        loadFromFile(const std::filesystem::path& path);
+
+    private:
+        std::map<std::string, size_t> tickCounts;
+        std::map<TransitionKey, size_t> transitionCounts;
+        std::map<ConditionKey, size_t> conditionHitCounts;
+    };
+} // namespace fsm
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <fsm/ByteFsm.hpp>
+#include <fsm/Types.hpp>
+#include <istream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace fsm
+{
+    namespace detail
+    {
+        /**
+         * Read at most buffer.size() bytes from a file descriptor.
+         *
+         * \return Number of bytes read, zero at the end of file
+         * \throws fsm::Error if reading fails
+         */
+        [[nodiscard]] size_t
+        readFromFileDescriptor(int fileDescriptor, std::span<char> buffer);
+    } // namespace detail
+
+    /**
+     * \brief Feeds input to a fsm::ByteFsm in fixed-size chunks
+     *
+     * Only a single chunk of the input is held in memory at a time,
+     * so arbitrarily large inputs are parsed with constant memory
+     * (plus the length of the longest token, which is carried over
+     * chunk boundaries in the blackboard).
+     *
+     * Each run processes the input until its end or until the machine
+     * gets into the error state and then calls fsm::ByteFsm::finish.
+     */
+    template<ByteBlackboardTypeConcept BbT>
+    class [[nodiscard]] StreamDriver final
+    {
+    public:
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    public:
+        /**
+         * \param machine  Machine to drive, must outlive the driver
+         * \param chunkSize  Number of bytes read at once
+         */
+        explicit StreamDriver(
+            const ByteFsm<BbT>& machine,
+            size_t chunkSize = DEFAULT_CHUNK_SIZE)
+            : machine(machine), buffer(chunkSize)
+        {
+        }
+
+    public:
+        /**
+         * Process everything that can be read from the stream.
+         *
+         * \return Number of bytes consumed by the machine
+         */
+        size_t run(BbT& blackboard, std::istream& stream)
+        {
+            return runImpl(
+                blackboard,
+                [&stream](std::span<char> chunk) -> size_t
+                {
+                    stream.read(
+                        chunk.data(),
+                        static_cast<std::streamsize>(chunk.size()));
+                    return static_cast<size_t>(stream.gcount());
+                });
+        }
+
+        /**
+         * Process everything that can be read from an open file
+         * descriptor. The descriptor is not closed.
+         *
+         * \return Number of bytes consumed by the machine
+         */
+        size_t runFromFileDescriptor(BbT& blackboard, int fileDescriptor)
+        {
+            return runImpl(
+                blackboard,
+                [fileDescriptor](std::span<char> chunk) {
+                    return detail::readFromFileDescriptor(
+                        fileDescriptor, chunk);
+                });
+        }
+
+        /**
+         * Process input that is already in memory, for example
+         * a memory-mapped file.
+         *
+         * \return Number of bytes consumed by the machine
+         */
+        size_t run(BbT& blackboard, std::span<const char> input)
+        {
+            const auto consumed = machine.process(
+                blackboard, std::string_view(input.data(), input.size()));
+            machine.finish(blackboard);
+            return consumed;
+        }
+
+    private:
+        template<class ReadFn>
+        size_t runImpl(BbT& blackboard, ReadFn&& read)
+        {
+            size_t consumed = 0;
+
+            while (!machine.isErrored(blackboard))
+            {
+                const auto bytesRead = read(std::span(buffer));
+                if (bytesRead == 0) break;
+
+                consumed += machine.process(
+                    blackboard, std::string_view(buffer.data(), bytesRead));
+            }
+
+            machine.finish(blackboard);
+            return consumed;
+        }
+
+    private:
+        const ByteFsm<BbT>& machine;
+        std::vector<char> buffer;
+    };
+} // namespace fsm
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cassert>
+#include <fsm/Error.hpp>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace fsm
+{
+    namespace detail
+    {
+        // Context of type CtxT passed to the tick running on this thread,
+        // each type has its own slot so a context cannot be read as
+        // another type
+        template<class CtxT>
+        inline thread_local const CtxT* currentTickContext = nullptr;
+
+        template<class... Ts>
+        inline constexpr bool areDistinct = true;
+
+        template<class T, class... Ts>
+        inline constexpr bool areDistinct<T, Ts...> =
+            (!std::is_same_v<T, Ts> && ...) && areDistinct<Ts...>;
+
+        /**
+         * Publish the contexts for the duration of a tick, restoring
+         * the previous ones so ticks of different machines can nest.
+         */
+        template<class... CtxTs>
+            requires areDistinct<CtxTs...>
+        class [[nodiscard]] TickContextGuard final
+        {
+        public:
+            explicit TickContextGuard(const CtxTs&... contexts) noexcept
+                : previous(
+                    std::exchange(currentTickContext<CtxTs>, &contexts)...)
+            {
+            }
+
+            TickContextGuard(TickContextGuard&&) = delete;
+            TickContextGuard(const TickContextGuard&) = delete;
+
+            ~TickContextGuard()
+            {
+                std::apply(
+                    [](const CtxTs*... contexts)
+                    { ((currentTickContext<CtxTs> = contexts), ...); },
+                    previous);
+            }
+
+        private:
+            std::tuple<const CtxTs*...> previous;
+        };
+    } // namespace detail
+
+    namespace detail
+    {
+        template<class CtxT>
+        void checkTickContext()
+        {
+            if (!currentTickContext<CtxT>) [[unlikely]]
+                throw Error(
+                    "Tick was not passed the context required by a condition "
+                    "or action adapted by fsm::withContext");
+        }
+    } // namespace detail
+
+    /**
+     * \brief Context passed to the tick that is currently running
+     *
+     * Can only be called from conditions and actions invoked by
+     * fsm::Fsm::tick (or tickAll, tickWithBudget) with a context
+     * of type CtxT.
+     *
+     * \throws fsm::Error if the running tick was not passed a context
+     * of type CtxT
+     */
+    template<class CtxT>
+    [[nodiscard]] const CtxT& getTickContext()
+    {
+        detail::checkTickContext<CtxT>();
+        return *detail::currentTickContext<CtxT>;
+    }
+
+    namespace detail
+    {
+        /**
+         * Fsm checks that the context was passed before the tick
+         * evaluates any state (\see getContextCheck), so calls
+         * don't check it again.
+         */
+        template<class CtxT, class Callable>
+        struct [[nodiscard]] ContextBinding final
+        {
+            Callable callable;
+
+            template<class BbT>
+            auto operator()(BbT& blackboard) const -> decltype(std::invoke(
+                std::declval<const Callable&>(),
+                blackboard,
+                std::declval<const CtxT&>()))
+            {
+                assert(currentTickContext<CtxT>);
+                return std::invoke(
+                    callable, blackboard, *currentTickContext<CtxT>);
+            }
+
+            // World conditions don't read the blackboard
+            template<class ContextT = CtxT>
+            auto operator()() const -> decltype(std::invoke(
+                std::declval<const Callable&>(),
+                std::declval<const ContextT&>()))
+            {
+                assert(currentTickContext<CtxT>);
+                return std::invoke(callable, *currentTickContext<CtxT>);
+            }
+
+            [[nodiscard]] static constexpr auto getContextCheck() noexcept
+            {
+                return &checkTickContext<CtxT>;
+            }
+        };
+    } // namespace detail
+
+    /**
+     * \brief Adapt a condition taking (const BbT&, const CtxT&), an action
+     * taking (BbT&, const CtxT&) or a world condition taking
+     * (const CtxT&) for fsm::Builder
+     *
+     * The context is the one passed to fsm::Fsm::tick, it is shared
+     * by all blackboards of the tick so they don't have to hold pointers
+     * to the world data. Ticking a machine that uses such callable without
+     * the context throws fsm::Error before any state is evaluated.
+     *
+     * \code
+     * .when(fsm::withContext<World>(
+     *     [](const Blackboard& bb, const World& world)
+     *     { return world.isNight && bb.isTired; }))
+     * ...
+     * machine.tickAll(agents, world);
+     * \endcode
+     */
+    template<class CtxT, class Callable>
+    [[nodiscard]] constexpr auto withContext(Callable&& callable)
+    {
+        return detail::ContextBinding<CtxT, std::decay_t<Callable>> {
+            std::forward<Callable>(callable)
+        };
+    }
+} // namespace fsm
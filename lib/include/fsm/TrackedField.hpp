@@ -0,0 +1,78 @@
+#pragma once
+
+#include <concepts>
+#include <fsm/Types.hpp>
+#include <utility>
+
+namespace fsm
+{
+    /**
+     * \brief Blackboard field that marks itself dirty when written
+     *
+     * The field can be read like the plain value, but it can only be
+     * written through set or modify, which flag the Fields bits
+     * of the owning blackboard (\see markDirty). Conditions declared
+     * with dependencies (\see StateBuilderBeforePickingAnything::when)
+     * are then only re-evaluated when a field they read was written.
+     *
+     * \code
+     * struct Blackboard : fsm::BlackboardBase, fsm::TrackedBlackboard
+     * {
+     *     fsm::TrackedField<int, 1u << 0> health = 100;
+     * };
+     *
+     * bb.health.set(bb, bb.health - damage);
+     * \endcode
+     */
+    template<class T, FieldMask Fields>
+        requires(Fields != 0)
+    class [[nodiscard]] TrackedField final
+    {
+    public:
+        static constexpr FieldMask MASK = Fields;
+
+    public:
+        constexpr TrackedField() = default;
+
+        constexpr TrackedField(T value) : value(std::move(value)) {}
+
+    public:
+        [[nodiscard]] constexpr const T& get() const noexcept
+        {
+            return value;
+        }
+
+        [[nodiscard]] constexpr operator const T&() const noexcept
+        {
+            return value;
+        }
+
+        /**
+         * Write the value. The owner is only marked dirty if the value
+         * changed, or if T cannot be compared.
+         */
+        constexpr void set(TrackedBlackboard& owner, T newValue)
+        {
+            if constexpr (std::equality_comparable<T>)
+            {
+                if (value == newValue) return;
+            }
+
+            value = std::move(newValue);
+            markDirty(owner, Fields);
+        }
+
+        /**
+         * Mark the owner dirty and get mutable access to the value
+         */
+        [[nodiscard]] constexpr T&
+        modify(TrackedBlackboard& owner) noexcept
+        {
+            markDirty(owner, Fields);
+            return value;
+        }
+
+    private:
+        T value = {};
+    };
+} // namespace fsm
@@ -1,14 +1,110 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
 #include <format>
+#include <fsm/AsyncBehavior.hpp>
+#include <fsm/detail/PackedStateStack.hpp>
 #include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace fsm
 {
+    /**
+     * \brief Set of blackboard fields, one bit per field
+     *
+     * Meaning of the bits is up to the user, \see markDirty.
+     */
+    using FieldMask = std::uint64_t;
+
+    inline constexpr FieldMask ALL_FIELDS = ~FieldMask {};
+
+    /**
+     * \brief Index of a compiled state
+     *
+     * Its width is chosen by the FSM_STATE_INDEX_BITS definition
+     * (8, 16, 32 or 64), set through the CMake option of the same name,
+     * and defaults to 16 bits. Narrower indices shrink the compiled
+     * transitions and the state stacks of blackboards, but limit the number
+     * of states of a machine, \see NO_STATE_IDX.
+     */
+#if !defined(FSM_STATE_INDEX_BITS) || FSM_STATE_INDEX_BITS == 16
+    using StateIdx = std::uint16_t;
+#elif FSM_STATE_INDEX_BITS == 8
+    using StateIdx = std::uint8_t;
+#elif FSM_STATE_INDEX_BITS == 32
+    using StateIdx = std::uint32_t;
+#elif FSM_STATE_INDEX_BITS == 64
+    using StateIdx = std::uint64_t;
+#else
+#error FSM_STATE_INDEX_BITS must be 8, 16, 32 or 64
+#endif
+
+    // Reserved, so a machine has less than this many states
+    inline constexpr StateIdx NO_STATE_IDX =
+        std::numeric_limits<StateIdx>::max();
+
+    namespace detail
+    {
+        // Generation of blackboards that were not ticked by any model yet
+        inline constexpr size_t NO_MODEL_GENERATION =
+            std::numeric_limits<size_t>::max();
+
+        /**
+         * Common base of BlackboardBase and PackedBlackboardBase
+         */
+        struct [[nodiscard]] BlackboardCore
+        {
+        };
+    } // namespace detail
+
+    /**
+     * \brief Mixin for blackboards that track which fields were written
+     *
+     * Inherit it next to BlackboardBase or PackedBlackboardBase
+     * to make use of the dependencies of conditions (\see
+     * StateBuilderBeforePickingAnything::when), of waitUntil and
+     * of fsm::until. Other blackboards don't store the fields below,
+     * their conditions and waits are evaluated on every tick.
+     *
+     * \code
+     * struct Blackboard : fsm::BlackboardBase, fsm::TrackedBlackboard {};
+     * \endcode
+     */
+    struct [[nodiscard]] TrackedBlackboard
+    {
+        // Fields written since conditions were last evaluated
+        FieldMask __dirtyFields = ALL_FIELDS;
+
+        // Non-zero while the agent waits for a condition depending
+        // on these fields
+        FieldMask __waitedFields = 0;
+
+        // State whose conditions were all false when __dirtyFields
+        // was last cleared
+        StateIdx __checkedStateIdx = NO_STATE_IDX;
+    };
+
+    /**
+     * \brief Mixin for blackboards of machines that are reloaded,
+     * \see Fsm::reload
+     *
+     * \code
+     * struct Blackboard : fsm::BlackboardBase, fsm::ReloadableBlackboard {};
+     * \endcode
+     */
+    struct [[nodiscard]] ReloadableBlackboard
+    {
+        // Generation of the model that ticked the blackboard last,
+        // state indices are remapped when the model is reloaded
+        size_t __modelGeneration = detail::NO_MODEL_GENERATION;
+    };
+
     /**
      * \brief Base class for blackboard
      *
@@ -17,17 +113,111 @@ namespace fsm
      * in the base class, you just need to inherit it publicly
      * for your Blackboard class.
      */
-    struct [[nodiscard]] BlackboardBase
+    struct [[nodiscard]] BlackboardBase : detail::BlackboardCore
     {
         // 0u is guaranteed to be the entry point of the machine
-        std::vector<size_t> __stateIdxs = { size_t {} };
+        std::vector<StateIdx> __stateIdxs = { StateIdx {} };
+
+        // Coroutine of the current state, if it has an async behavior
+        detail::AsyncBehaviorSlot __asyncBehavior;
     };
 
+    namespace detail
+    {
+        // Width of the whole index, but at most 16 bits so wide
+        // indices still leave room for nested submachines
+        inline constexpr size_t DEFAULT_PACKED_INDEX_BITS =
+            sizeof(StateIdx) < 2u ? sizeof(StateIdx) * 8u : 16u;
+
+        /**
+         * Common base of all specializations of PackedBlackboardBase
+         */
+        struct [[nodiscard]] PackedBlackboardCore : BlackboardCore
+        {
+        };
+    } // namespace detail
+
+    /**
+     * \brief Base class for blackboard that keeps its state stack
+     * in a single machine word
+     *
+     * Drop-in replacement for BlackboardBase that needs no heap allocation
+     * and is trivially copyable (as long as the derived class is), so
+     * blackboards can be snapshotted with memcpy. Each level of the stack
+     * takes IndexBits bits, so narrower indices allow deeper nesting
+     * of submachines in exchange for fewer states. fsm::FinalBuilder::build
+     * throws unless the submachines of the machine nest at most
+     * PackedStateStack::CAPACITY levels deep, the machine has at most
+     * PackedStateStack::MAX_INDEX states and no state has an async behavior.
+     *
+     * \code
+     * // 8 levels of at most 255 states
+     * struct Blackboard : fsm::PackedBlackboardBase<8> {};
+     * \endcode
+     */
+    template<size_t IndexBits = detail::DEFAULT_PACKED_INDEX_BITS>
+    struct [[nodiscard]] PackedBlackboardBase : detail::PackedBlackboardCore
+    {
+        using PackedStateStack = detail::PackedStateStack<StateIdx, IndexBits>;
+
+        // 0u is guaranteed to be the entry point of the machine
+        PackedStateStack __stateIdxs = { StateIdx {} };
+
+        // Placeholder, async behaviors are not supported
+        detail::NoAsyncBehaviorSlot __asyncBehavior;
+    };
+
+    /**
+     * \brief Signal that fields of the blackboard were written
+     *
+     * An agent waiting for a condition (\see
+     * StateBuilderBeforePickingAnything::waitUntil) is not ticked until
+     * a field the condition depends on is marked dirty.
+     */
+    constexpr void
+    markDirty(TrackedBlackboard& blackboard, FieldMask fields) noexcept
+    {
+        blackboard.__dirtyFields |= fields;
+    }
+
     /**
      * \brief Constraint that checks if a class was derived from BlackboardBase
+     * or PackedBlackboardBase
+     */
+    template<class T>
+    concept BlackboardTypeConcept =
+        std::derived_from<T, BlackboardBase>
+        || std::derived_from<T, detail::PackedBlackboardCore>;
+
+    template<class T>
+    concept PackedBlackboardTypeConcept =
+        std::derived_from<T, detail::PackedBlackboardCore>;
+
+    template<class T>
+    concept TrackedBlackboardTypeConcept =
+        std::derived_from<T, TrackedBlackboard>;
+
+    template<class T>
+    concept ReloadableBlackboardTypeConcept =
+        std::derived_from<T, ReloadableBlackboard>;
+
+    /**
+     * \brief Base class for blackboard of fsm::ByteFsm
+     *
+     * Holds the current state of the byte machine and the part of the
+     * current token that was consumed by previous calls to
+     * fsm::ByteFsm::process.
      */
+    struct [[nodiscard]] ByteBlackboardBase
+    {
+        // 0u is guaranteed to be the entry state of the machine
+        size_t __byteStateIdx = 0;
+        std::string __pendingToken;
+    };
+
     template<class T>
-    concept BlackboardTypeConcept = std::derived_from<T, BlackboardBase>;
+    concept ByteBlackboardTypeConcept =
+        std::derived_from<T, ByteBlackboardBase>;
 
     // Helper to detect if std::formatter<T, CharT> is specialized
     template<typename T, typename CharT, typename = void>
@@ -58,12 +248,155 @@ namespace fsm
         } -> std::same_as<void>;
     } && BlackboardTypeConcept<BlackboardType>;
 
+    template<class Callable>
+    concept WorldConditionConcept = requires(Callable&& fn) {
+        {
+            fn()
+        } -> std::same_as<bool>;
+    };
+
+    template<class Callable, class BlackboardType>
+    concept AsyncActionConcept = requires(Callable&& fn, BlackboardType& bb) {
+        {
+            fn(bb)
+        } -> std::same_as<AsyncBehavior>;
+    } && BlackboardTypeConcept<BlackboardType>;
+
+    template<class Callable, class BlackboardType>
+    concept ByteActionConcept =
+        requires(Callable&& fn, BlackboardType& bb, std::string_view token) {
+            {
+                fn(bb, token)
+            } -> std::same_as<void>;
+        } && ByteBlackboardTypeConcept<BlackboardType>;
+
+    /**
+     * \brief Constraint for blackboard fields usable in switchOn/caseOf
+     */
+    template<class T>
+    concept SwitchableFieldConcept = std::integral<T> || std::is_enum_v<T>;
+
+    /**
+     * \brief Action that does nothing
+     *
+     * Unlike a custom empty lambda, this action is recognized by the library,
+     * so states that only pass the control flow further can be collapsed
+     * by the graph optimizer (\see FinalBuilder::optimize).
+     */
+    struct [[nodiscard]] DoNothing final
+    {
+        constexpr void
+        operator()(const detail::BlackboardCore&) const noexcept
+        {
+        }
+    };
+
+    inline constexpr DoNothing doNothing = DoNothing {};
+
     namespace detail
     {
+        // Throws fsm::Error if the running tick was not passed a context
+        // read by a callable, \see fsm::withContext
+        using ContextCheck = void (*)();
+
+        /**
+         * std::function that remembers which tick context the wrapped
+         * callable reads, so Fsm can check the context once per tick
+         * instead of on every call.
+         */
+        template<class Signature>
+        class [[nodiscard]] TickCallable final : public std::function<Signature>
+        {
+        public:
+            TickCallable() noexcept = default;
+
+            template<class Callable>
+                requires(
+                    !std::same_as<std::decay_t<Callable>, TickCallable>
+                    && std::constructible_from<
+                        std::function<Signature>,
+                        Callable>)
+            TickCallable(Callable&& callable)
+                : TickCallable(
+                    findContextCheck(callable),
+                    std::forward<Callable>(callable))
+            {
+            }
+
+        public:
+            [[nodiscard]] constexpr ContextCheck
+            getContextCheck() const noexcept
+            {
+                return contextCheck;
+            }
+
+        private:
+            template<class Callable>
+            TickCallable(ContextCheck contextCheck, Callable&& callable)
+                : std::function<Signature>(std::forward<Callable>(callable))
+                , contextCheck(contextCheck)
+            {
+            }
+
+            [[nodiscard]] static constexpr ContextCheck
+            findContextCheck(const auto& callable) noexcept
+            {
+                if constexpr (requires { callable.getContextCheck(); })
+                    return callable.getContextCheck();
+                else
+                    return nullptr;
+            }
+
+        private:
+            ContextCheck contextCheck = nullptr;
+        };
+
         template<BlackboardTypeConcept BbT>
-        using Action = std::function<void(BbT&)>;
+        using Action = TickCallable<void(BbT&)>;
+
+        using WorldCondition = TickCallable<bool()>;
+
+        template<BlackboardTypeConcept BbT>
+        using AsyncAction = TickCallable<AsyncBehavior(BbT&)>;
 
         template<BlackboardTypeConcept BbT>
-        using Condition = std::function<bool(const BbT&)>;
+        using Condition = TickCallable<bool(const BbT&)>;
+
+        template<ByteBlackboardTypeConcept BbT>
+        using ByteAction = std::function<void(BbT&, std::string_view)>;
+
+        template<BlackboardTypeConcept BbT>
+        using SwitchSelector = TickCallable<std::int64_t(const BbT&)>;
+
+        /**
+         * Callable that remembers the name it was registered under,
+         * \see CallableRegistry
+         */
+        template<class Callable>
+        struct [[nodiscard]] NamedCallable final
+        {
+            std::string name;
+            Callable callable;
+
+            decltype(auto) operator()(auto&&... args) const
+            {
+                return callable(std::forward<decltype(args)>(args)...);
+            }
+
+            [[nodiscard]] constexpr ContextCheck
+            getContextCheck() const noexcept
+            {
+                return callable.getContextCheck();
+            }
+        };
+
+        template<SwitchableFieldConcept T>
+        [[nodiscard]] constexpr std::int64_t toSwitchKey(T value) noexcept
+        {
+            if constexpr (std::is_enum_v<T>)
+                return static_cast<std::int64_t>(std::to_underlying(value));
+            else
+                return static_cast<std::int64_t>(value);
+        }
     } // namespace detail
 } // namespace fsm
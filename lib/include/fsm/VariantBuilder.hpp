@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/Fsm.hpp>
+#include <fsm/Types.hpp>
+#include <fsm/detail/CompiledContext.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fsm
+{
+    /**
+     * \brief Derives a variant of a machine that overrides a few callables
+     *
+     * The variant shares the compiled states and state names with
+     * the base machine and only copies the states it overrides, so
+     * deriving many agent archetypes from a single machine costs little
+     * memory and no compilation. Structure of the machine (its states
+     * and transitions) is the same as in the base machine.
+     *
+     * States are identified by their full names, the same way as
+     * in the logs ("machine:state", main machine is called "__main__").
+     *
+     * The variant keeps the model the base machine had when the builder
+     * was created, reloading the base machine later does not affect it.
+     * Blackboards initialized by the base machine can be ticked by
+     * the variant and vice versa, as long as the base machine is not
+     * reloaded after the variant was built.
+     *
+     * \code
+     * auto&& berserker = fsm::VariantBuilder(soldier)
+     *     .overrideAction("__main__:Attack", attackRecklessly)
+     *     .overrideCondition("__main__:Attack", 0, isAnyoneAlive)
+     *     .build();
+     * \endcode
+     */
+    template<BlackboardTypeConcept BbT>
+    class [[nodiscard]] VariantBuilder final
+    {
+    public:
+        explicit VariantBuilder(const Fsm<BbT>& base)
+            : base(base.shareModel())
+        {
+        }
+
+        VariantBuilder(VariantBuilder&&) = delete;
+        VariantBuilder(const VariantBuilder&) = delete;
+
+    public:
+        /**
+         * Replace the behavior executed by the state
+         */
+        auto& overrideAction(
+            const std::string& fullStateName,
+            ActionConcept<BbT> auto&& action)
+        {
+            const auto stateIdx = getStateIdx(fullStateName);
+            const auto* extras = base->slots[stateIdx].extras;
+            if (extras && extras->startAsyncBehavior)
+                throw Error(std::format(
+                    "State {} has an async behavior, its action cannot be "
+                    "overridden",
+                    fullStateName));
+
+            getOverriddenState(stateIdx).executeBehavior = std::move(action);
+            return *this;
+        }
+
+        /**
+         * Replace the condition of a conditional transition of the state
+         *
+         * \param declarationIdx Order in which the condition was declared
+         * in the state, as reported by the logs
+         *
+         * The new condition is evaluated on every tick, even if the original
+         * one declared its dependencies.
+         */
+        auto& overrideCondition(
+            const std::string& fullStateName,
+            size_t declarationIdx,
+            ConditionConcept<BbT> auto&& condition)
+        {
+            auto& transitions =
+                getOverriddenState(getStateIdx(fullStateName))
+                    .conditionalTransitions;
+            auto&& itr = std::ranges::find(
+                transitions,
+                declarationIdx,
+                &detail::CompiledConditionalTransition<BbT>::declarationIdx);
+            if (itr == transitions.end())
+                throw Error(std::format(
+                    "State {} has no conditional transition declared as {}",
+                    fullStateName,
+                    declarationIdx));
+
+            itr->onConditionHit = std::move(condition);
+            itr->dependencies = 0;
+            return *this;
+        }
+
+        [[nodiscard]] Fsm<BbT> build()
+        {
+            auto&& model = detail::CompiledModel<BbT> {
+                .stateIdToName = base->stateIdToName,
+                .errorStateEndIdx = base->errorStateEndIdx,
+                .microstepLimit = base->microstepLimit,
+                .globalErrorTransition =
+                    cloneConditional(base->globalErrorTransition),
+                .linkedSubmachines = base->linkedSubmachines,
+                .base = base,
+                // Shares the indices of the base, so it remaps the same way
+                .generation = base->generation,
+                .remapTables = base->remapTables,
+            };
+
+            for (auto&& [stateIdx, state] : overriddenStates)
+            {
+                model.states.push_back(std::move(state));
+                model.overriddenStateIdxs.push_back(stateIdx);
+            }
+            overriddenStates.clear();
+
+            for (auto&& interrupts : base->machineInterrupts)
+            {
+                auto& clones = model.machineInterrupts.emplace_back();
+                for (auto&& interrupt : interrupts)
+                    clones.push_back(cloneConditional(interrupt));
+            }
+
+            for (auto&& interrupt : base->globalInterrupts)
+                model.globalInterrupts.push_back(
+                    detail::CompiledGlobalInterrupt<BbT> {
+                        .condition = interrupt.condition,
+                        .worldCondition = interrupt.worldCondition,
+                        .transition = interrupt.transition.relocate(0),
+                        .targetMachineIdx = interrupt.targetMachineIdx,
+                    });
+
+            model.link();
+            return Fsm<BbT>(std::move(model));
+        }
+
+    private:
+        [[nodiscard]] size_t
+        getStateIdx(const std::string& fullStateName) const
+        {
+            const auto& stateIdToName = *base->stateIdToName;
+            auto&& itr = std::ranges::find(stateIdToName, fullStateName);
+            if (itr == stateIdToName.end())
+                throw Error(std::format(
+                    "Machine has no state called {}", fullStateName));
+
+            return static_cast<size_t>(itr - stateIdToName.begin());
+        }
+
+        /**
+         * \return Copy of the state owned by the variant, created
+         * on the first override of the state
+         */
+        [[nodiscard]] detail::CompiledState<BbT>&
+        getOverriddenState(size_t stateIdx)
+        {
+            if (auto&& overridden = overriddenStates.find(stateIdx);
+                overridden != overriddenStates.end())
+                return overridden->second;
+
+            return overriddenStates
+                .emplace(stateIdx, cloneState(*base->slots[stateIdx].state))
+                .first->second;
+        }
+
+        [[nodiscard]] static detail::CompiledConditionalTransition<BbT>
+        cloneConditional(
+            const detail::CompiledConditionalTransition<BbT>& transition)
+        {
+            return detail::CompiledConditionalTransition<BbT> {
+                .onConditionHit = transition.onConditionHit,
+                .dependencies = transition.dependencies,
+                .transition = transition.transition.relocate(0),
+                .declarationIdx = transition.declarationIdx,
+            };
+        }
+
+        /**
+         * Extras of the clone are still read from the base model,
+         * \see detail::CompiledModel::link
+         */
+        [[nodiscard]] static detail::CompiledState<BbT>
+        cloneState(const detail::CompiledState<BbT>& state)
+        {
+            auto&& result = detail::CompiledState<BbT> {
+                .machineIdx = state.machineIdx,
+                .extrasIdx = state.extrasIdx,
+                .executeBehavior = state.executeBehavior,
+                .defaultTransition = state.defaultTransition.relocate(0),
+            };
+
+            for (auto&& transition : state.conditionalTransitions)
+                result.conditionalTransitions.push_back(
+                    cloneConditional(transition));
+            return result;
+        }
+
+    private:
+        std::shared_ptr<const detail::CompiledModel<BbT>> base;
+        std::map<size_t, detail::CompiledState<BbT>> overriddenStates;
+    };
+} // namespace fsm
@@ -0,0 +1,564 @@
+#pragma once
+
+#include <algorithm>
+#include <fsm/Types.hpp>
+#include <fsm/detail/BuilderContext.hpp>
+#include <fsm/detail/CompiledContext.hpp>
+#include <fsm/detail/Constants.hpp>
+#include <fsm/detail/Helper.hpp>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace fsm::detail
+{
+    /**
+     * Static analysis of the FSM graph stored in the BuilderContext
+     * or in a compiled model.
+     */
+    class Analyzer final
+    {
+    public:
+        /**
+         * Invoke a callback for every transition in the context.
+         *
+         * Callback receives full name of the source state, the destination
+         * of the transition and a flag whether the transition is taken
+         * as a result of a condition (and thus without executing any
+         * behavior).
+         *
+         * Interrupts of a machine are reported as conditional transitions
+         * from each of its states, except for the interrupt target.
+         */
+        template<BlackboardTypeConcept BbT, class Callback>
+        static void
+        forEachTransition(const BuilderContext<BbT>& context, Callback&& fn)
+        {
+            for (auto&& [machineName, machineContext] : context.machines)
+            {
+                for (auto&& [stateName, stateContext] : machineContext.states)
+                {
+                    const auto source =
+                        createFullStateName(machineName, stateName);
+
+                    for (auto&& condition : stateContext.conditions)
+                        fn(source, condition.destination, true);
+
+                    for (auto&& interrupt : machineContext.interrupts)
+                    {
+                        if (interrupt.destination.primary != source)
+                            fn(source, interrupt.destination, true);
+                    }
+
+                    fn(source, stateContext.destination, false);
+                }
+            }
+        }
+
+        /**
+         * Invoke a callback for every interrupt of an enclosing machine
+         * that is evaluated while a state of a submachine is on top
+         * of the stack.
+         *
+         * Callback receives full name of the state on top of the stack,
+         * the name of the machine that owns the interrupt and
+         * the destination of the interrupt. Taking it unwinds the stack
+         * to the level of the owning machine.
+         */
+        template<BlackboardTypeConcept BbT, class Callback>
+        static void forEachEnclosingInterrupt(
+            const BuilderContext<BbT>& context, Callback&& fn)
+        {
+            const auto&& enclosingMachines = getEnclosingMachines(context);
+
+            for (auto&& [machineName, enclosing] : enclosingMachines)
+            {
+                if (!context.machines.contains(machineName)) continue;
+
+                for (auto&& [stateName, _] :
+                     context.machines.at(machineName).states)
+                {
+                    const auto source =
+                        createFullStateName(machineName, stateName);
+
+                    for (auto&& outerMachine : enclosing)
+                    {
+                        if (!context.machines.contains(outerMachine)) continue;
+
+                        for (auto&& interrupt :
+                             context.machines.at(outerMachine).interrupts)
+                            fn(source, outerMachine, interrupt.destination);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Compute the machines that can have a state on the stack below
+         * a state of a given machine. A return state adds its machine,
+         * machines invoked with thenFinish inherit the enclosing machines
+         * of their caller.
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::map<std::string, std::set<std::string>>
+        getEnclosingMachines(const BuilderContext<BbT>& context)
+        {
+            auto&& directEnclosing = std::map<std::string, Edges> {};
+            auto&& callers = std::map<std::string, Edges> {};
+
+            forEachTransition(
+                context,
+                [&](const std::string& source,
+                    const TransitionContext& destination,
+                    bool)
+                {
+                    if (!isSubmachineInvocation(source, destination)) return;
+
+                    const auto calledMachine =
+                        getMachineName(destination.primary);
+                    callers[calledMachine].insert(getMachineName(source));
+                    if (!destination.secondary.empty())
+                        directEnclosing[calledMachine].insert(
+                            getMachineName(destination.secondary));
+                });
+
+            for (auto&& interrupt : context.globalInterrupts)
+            {
+                if (!interrupt.destination.secondary.empty())
+                    directEnclosing[interrupt.targetMachine].insert(
+                        getMachineName(interrupt.destination.secondary));
+            }
+
+            auto&& result = std::map<std::string, std::set<std::string>> {};
+            for (auto&& [machineName, _] : context.machines)
+            {
+                auto&& visited = std::set<std::string> {};
+                collectFromCallers(
+                    machineName,
+                    directEnclosing,
+                    callers,
+                    visited,
+                    result[machineName]);
+                result[machineName].erase(machineName);
+            }
+
+            return result;
+        }
+
+        /**
+         * Find a cycle made only of conditional transitions. Such cycle
+         * can be followed indefinitely without ever executing a behavior.
+         *
+         * Finishing a submachine is resolved into all states the submachine
+         * can return into.
+         *
+         * \return Full names of states forming the cycle or an empty vector
+         * if there is no such cycle.
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::vector<std::string>
+        findConditionOnlyCycle(const BuilderContext<BbT>& context)
+        {
+            const auto&& graph = createConditionGraph(context);
+            auto&& marks = std::map<std::string, Mark> {};
+            auto&& path = std::vector<std::string> {};
+
+            for (auto&& [node, _] : graph)
+            {
+                if (findCycleFrom(node, graph, marks, path)) return path;
+            }
+
+            return {};
+        }
+
+        /**
+         * Compute the states that are pushed on the state stack when
+         * a given machine finishes. Submachines invoked with thenFinish
+         * inherit the return states of their caller.
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::map<std::string, std::set<std::string>>
+        getReturnDestinations(const BuilderContext<BbT>& context)
+        {
+            auto&& directReturns = std::map<std::string, Edges> {};
+            auto&& finishingCallers = std::map<std::string, Edges> {};
+
+            forEachTransition(
+                context,
+                [&](const std::string& source,
+                    const TransitionContext& destination,
+                    bool)
+                {
+                    if (!isSubmachineInvocation(source, destination)) return;
+
+                    const auto calledMachine =
+                        getMachineName(destination.primary);
+                    if (destination.secondary.empty())
+                        finishingCallers[calledMachine].insert(
+                            getMachineName(source));
+                    else
+                        directReturns[calledMachine].insert(
+                            destination.secondary);
+                });
+
+            for (auto&& interrupt : context.globalInterrupts)
+            {
+                if (!interrupt.destination.secondary.empty())
+                    directReturns[interrupt.targetMachine].insert(
+                        interrupt.destination.secondary);
+            }
+
+            auto&& result = std::map<std::string, std::set<std::string>> {};
+            for (auto&& [machineName, _] : context.machines)
+            {
+                auto&& visited = std::set<std::string> {};
+                collectFromCallers(
+                    machineName,
+                    directReturns,
+                    finishingCallers,
+                    visited,
+                    result[machineName]);
+            }
+
+            return result;
+        }
+
+        /**
+         * Compute the largest number of states the state stack can hold.
+         *
+         * Each machine is assigned the deepest stack it can be entered
+         * with. Invoking a submachine with a return state adds a level,
+         * conditional transitions into the error machine and global
+         * interrupts clear the stack first.
+         *
+         * \return Nothing if the stack can grow indefinitely, for example
+         * when a submachine invokes itself with a return state
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::optional<size_t>
+        getMaxStackDepth(const BuilderContext<BbT>& context)
+        {
+            auto&& depths = std::map<std::string, size_t> {
+                { MAIN_MACHINE_NAME, size_t { 1 } },
+            };
+            auto&& raise = [&](const TransitionContext& destination,
+                               size_t baseDepth)
+            {
+                if (destination.primary.empty()) return false;
+
+                auto& depth = depths[getMachineName(destination.primary)];
+                const auto newDepth =
+                    baseDepth + (destination.secondary.empty() ? 1u : 2u);
+                if (newDepth <= depth) return false;
+
+                depth = newDepth;
+                return true;
+            };
+
+            if (context.useGlobalError) raise(context.errorDestination, 0);
+            for (auto&& interrupt : context.globalInterrupts)
+                raise(interrupt.destination, 0);
+
+            // Longest path search, the depths must settle within one pass
+            // per machine unless there is a cycle that keeps raising them
+            for (size_t pass = 0; pass <= context.machines.size(); ++pass)
+            {
+                bool raised = false;
+                forEachTransition(
+                    context,
+                    [&](const std::string& source,
+                        const TransitionContext& destination,
+                        bool isConditional)
+                    {
+                        const auto sourceMachine = getMachineName(source);
+                        if (!depths.contains(sourceMachine)) return;
+
+                        const bool clears =
+                            isConditional && !destination.primary.empty()
+                            && destination.secondary.empty()
+                            && getMachineName(destination.primary)
+                                   == ERROR_MACHINE_NAME;
+                        // Current state is popped before the transition
+                        raised |= raise(
+                            destination,
+                            clears ? 0 : depths.at(sourceMachine) - 1u);
+                    });
+
+                // Interrupt of an enclosing machine unwinds the stack
+                // to the level of that machine first
+                forEachEnclosingInterrupt(
+                    context,
+                    [&](const std::string&,
+                        const std::string& outerMachine,
+                        const TransitionContext& destination)
+                    {
+                        if (!depths.contains(outerMachine)) return;
+
+                        const bool clears =
+                            !destination.primary.empty()
+                            && destination.secondary.empty()
+                            && getMachineName(destination.primary)
+                                   == ERROR_MACHINE_NAME;
+                        raised |= raise(
+                            destination,
+                            clears ? 0 : depths.at(outerMachine) - 1u);
+                    });
+
+                if (!raised)
+                    return std::ranges::max(depths | std::views::values);
+            }
+
+            return std::nullopt;
+        }
+
+        /**
+         * Compute the largest number of states the state stack can hold
+         * when ticked by a compiled model, for example a loaded one.
+         *
+         * Each state index is assigned the deepest level it can be stored
+         * at, including return states stored below the top of the stack.
+         * Interrupts of a machine are taken at the level of its state.
+         *
+         * \return Nothing if the stack can grow deeper than limit
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::optional<size_t> getMaxStackDepth(
+            const CompiledModel<BbT>& model, size_t limit)
+        {
+            const auto& slots = model.slots;
+            auto&& depths = std::vector<size_t>(slots.size(), 0u);
+            auto&& queue = std::vector<size_t> {};
+            bool overflow = false;
+
+            // Transition indices are stored top of the stack first
+            auto&& push = [&](const CompiledTransition& transition,
+                              size_t baseDepth,
+                              size_t offset)
+            {
+                const auto size = transition.getSize();
+                for (size_t idx = 0; idx < size; ++idx)
+                {
+                    const auto stateIdx = transition[idx] + offset;
+                    const auto depth = baseDepth + size - idx;
+                    if (stateIdx >= slots.size() || depth <= depths[stateIdx])
+                        continue;
+
+                    overflow |= depth > limit;
+                    depths[stateIdx] = depth;
+                    queue.push_back(stateIdx);
+                }
+            };
+
+            // Error state can only be entered with an empty stack
+            auto&& isErrorTransition =
+                [&](const CompiledTransition& transition, size_t offset)
+            {
+                return transition.getSize() == 1u && 0 < transition[0] + offset
+                       && transition[0] + offset < model.errorStateEndIdx;
+            };
+
+            push(CompiledTransition { StateIdx {} }, 0, 0);
+            if (model.globalErrorTransition.onConditionHit)
+                push(model.globalErrorTransition.transition, 0, 0);
+            for (auto&& interrupt : model.globalInterrupts)
+                push(interrupt.transition, 0, 0);
+
+            while (!queue.empty() && !overflow)
+            {
+                const auto stateIdx = queue.back();
+                queue.pop_back();
+
+                const auto& slot = slots[stateIdx];
+                // Current state is popped before the transition
+                const auto base = depths[stateIdx] - 1u;
+                auto&& follow = [&](const CompiledTransition& transition,
+                                    size_t offset)
+                {
+                    push(
+                        transition,
+                        isErrorTransition(transition, offset) ? 0 : base,
+                        offset);
+                };
+
+                for (auto&& condition : slot.state->conditionalTransitions)
+                    follow(condition.transition, slot.offset);
+                if (slot.extras)
+                {
+                    for (auto&& switchCase : slot.extras->switchTable.cases)
+                        follow(switchCase.transition, slot.offset);
+                }
+                follow(slot.state->defaultTransition, slot.offset);
+
+                if (slot.machineIdx < model.machineInterrupts.size())
+                {
+                    for (auto&& interrupt :
+                         model.machineInterrupts[slot.machineIdx])
+                        follow(interrupt.transition, 0);
+                }
+            }
+
+            if (overflow) return std::nullopt;
+            return std::ranges::max(depths);
+        }
+
+        /**
+         * Submachine invocation is a transition from one machine into
+         * another, other than into or from the error machine.
+         */
+        [[nodiscard]] static bool isSubmachineInvocation(
+            const std::string& source, const TransitionContext& destination)
+        {
+            if (destination.primary.empty()) return false;
+
+            const auto sourceMachine = getMachineName(source);
+            const auto targetMachine = getMachineName(destination.primary);
+            return sourceMachine != targetMachine
+                   && sourceMachine != ERROR_MACHINE_NAME
+                   && targetMachine != ERROR_MACHINE_NAME;
+        }
+
+        [[nodiscard]] static std::string
+        getMachineName(const std::string& fullStateName)
+        {
+            return getMachineAndStateNameFromFullName(fullStateName).first;
+        }
+
+    private:
+        using Edges = std::set<std::string>;
+        using Graph = std::map<std::string, Edges>;
+
+        enum class Mark
+        {
+            InProgress,
+            Done
+        };
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static Graph
+        createConditionGraph(const BuilderContext<BbT>& context)
+        {
+            const auto&& returnDestinations = getReturnDestinations(context);
+            auto&& graph = Graph {};
+
+            forEachTransition(
+                context,
+                [&](const std::string& source,
+                    const TransitionContext& destination,
+                    bool isConditional)
+                {
+                    auto& edges = graph[source];
+                    if (!isConditional) return;
+
+                    if (!destination.primary.empty())
+                    {
+                        edges.insert(destination.primary);
+                        return;
+                    }
+
+                    const auto& returns =
+                        returnDestinations.at(getMachineName(source));
+                    edges.insert(returns.begin(), returns.end());
+                });
+
+            forEachEnclosingInterrupt(
+                context,
+                [&](const std::string& source,
+                    const std::string& outerMachine,
+                    const TransitionContext& destination)
+                {
+                    auto& edges = graph[source];
+                    if (!destination.primary.empty())
+                    {
+                        edges.insert(destination.primary);
+                        return;
+                    }
+
+                    const auto& returns = returnDestinations.at(outerMachine);
+                    edges.insert(returns.begin(), returns.end());
+                });
+
+            if (context.useGlobalError)
+            {
+                for (auto&& [source, edges] : graph)
+                {
+                    if (getMachineName(source) != ERROR_MACHINE_NAME)
+                        edges.insert(context.errorDestination.primary);
+                }
+            }
+
+            for (auto&& interrupt : context.globalInterrupts)
+            {
+                for (auto&& [source, edges] : graph)
+                {
+                    const auto machineName = getMachineName(source);
+                    if (machineName != ERROR_MACHINE_NAME
+                        && machineName != interrupt.targetMachine)
+                        edges.insert(interrupt.destination.primary);
+                }
+            }
+
+            return graph;
+        }
+
+        static bool findCycleFrom(
+            const std::string& node,
+            const Graph& graph,
+            std::map<std::string, Mark>& marks,
+            std::vector<std::string>& path)
+        {
+            if (marks.contains(node))
+            {
+                if (marks.at(node) == Mark::Done) return false;
+
+                // Back edge, strip the part of the path leading to the cycle
+                path.erase(path.begin(), std::ranges::find(path, node));
+                return true;
+            }
+
+            marks[node] = Mark::InProgress;
+            path.push_back(node);
+
+            if (graph.contains(node))
+            {
+                for (auto&& next : graph.at(node))
+                {
+                    if (findCycleFrom(next, graph, marks, path)) return true;
+                }
+            }
+
+            path.pop_back();
+            marks[node] = Mark::Done;
+            return false;
+        }
+
+        /**
+         * Collect the direct items of a machine and, transitively,
+         * of all machines that call it
+         */
+        static void collectFromCallers(
+            const std::string& machineName,
+            const std::map<std::string, Edges>& directItems,
+            const std::map<std::string, Edges>& callers,
+            std::set<std::string>& visited,
+            std::set<std::string>& result)
+        {
+            if (!visited.insert(machineName).second) return;
+
+            if (directItems.contains(machineName))
+            {
+                const auto& items = directItems.at(machineName);
+                result.insert(items.begin(), items.end());
+            }
+
+            if (callers.contains(machineName))
+            {
+                for (auto&& caller : callers.at(machineName))
+                    collectFromCallers(
+                        caller, directItems, callers, visited, result);
+            }
+        }
+    };
+} // namespace fsm::detail
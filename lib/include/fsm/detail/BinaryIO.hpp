@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace fsm::detail
+{
+    /**
+     * Appends little-endian integers and length-prefixed strings
+     * to a byte buffer.
+     */
+    class [[nodiscard]] BinaryWriter final
+    {
+    public:
+        void writeU8(std::uint8_t value);
+
+        void writeU32(std::uint32_t value);
+
+        void writeU64(std::uint64_t value);
+
+        /**
+         * \throws fsm::Error if the value does not fit into 32 bits
+         */
+        void writeSize(size_t value);
+
+        void writeString(std::string_view value);
+
+        [[nodiscard]] constexpr const std::string& getData() const noexcept
+        {
+            return data;
+        }
+
+    private:
+        std::string data;
+    };
+
+    /**
+     * Reads the data written by BinaryWriter directly from the source
+     * buffer. Strings are returned as views into the buffer.
+     */
+    class [[nodiscard]] BinaryReader final
+    {
+    public:
+        explicit BinaryReader(std::span<const char> data) noexcept
+            : data(data)
+        {
+        }
+
+    public:
+        /**
+         * \throws fsm::Error if there are not enough data left
+         */
+        [[nodiscard]] std::uint8_t readU8();
+
+        [[nodiscard]] std::uint32_t readU32();
+
+        [[nodiscard]] std::uint64_t readU64();
+
+        [[nodiscard]] size_t readSize();
+
+        /**
+         * Read the number of items that follow, each taking at least
+         * minItemSize bytes
+         *
+         * \throws fsm::Error if the data left cannot hold that many items,
+         * so a corrupt count never reaches an allocation
+         */
+        [[nodiscard]] size_t readCount(size_t minItemSize);
+
+        [[nodiscard]] std::string_view readString();
+
+        [[nodiscard]] constexpr bool isAtEnd() const noexcept
+        {
+            return position == data.size();
+        }
+
+    private:
+        [[nodiscard]] std::span<const char> take(size_t count);
+
+    private:
+        std::span<const char> data;
+        size_t position = 0;
+    };
+} // namespace fsm::detail
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fsm/MappedFile.hpp>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace fsm::detail
+{
+    /**
+     * Directory of saved models, each stored in a file named
+     * after the fingerprint of the builder context it was built from.
+     */
+    class [[nodiscard]] BuildCache final
+    {
+    public:
+        explicit BuildCache(std::filesystem::path directory)
+            : directory(std::move(directory))
+        {
+        }
+
+    public:
+        /**
+         * \return Mapped file with the saved model, or nothing if
+         * the cache has no entry for the fingerprint
+         */
+        [[nodiscard]] std::optional<MappedFile>
+        find(std::uint64_t fingerprint) const;
+
+        /**
+         * Write the entry through a temporary file, so concurrent builds
+         * never see an incomplete entry. Failures are ignored, the cache
+         * only speeds up the build.
+         */
+        void store(std::uint64_t fingerprint, std::string_view data) const;
+
+    private:
+        [[nodiscard]] std::filesystem::path
+        getEntryPath(std::uint64_t fingerprint) const;
+
+    private:
+        std::filesystem::path directory;
+    };
+} // namespace fsm::detail
@@ -4,9 +4,16 @@
 #include <fsm/Types.hpp>
 #include <fsm/detail/NonEmptyString.hpp>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+namespace fsm
+{
+    template<BlackboardTypeConcept BbT>
+    class CompiledSubmachine;
+}
+
 namespace fsm::detail
 {
     using StateId = NonEmptyString<char>;
@@ -23,6 +30,10 @@ namespace fsm::detail
     {
         Condition<BbT> condition;
         TransitionContext destination;
+        size_t declarationIdx = 0;
+
+        // Fields the condition reads, zero if unknown
+        FieldMask dependencies = 0;
     };
 
     template<BlackboardTypeConcept BbT>
@@ -30,7 +41,21 @@ namespace fsm::detail
     {
         std::vector<ConditionalTransitionContext<BbT>> conditions;
         Action<BbT> action;
+        // When set, action is fsm::doNothing and this coroutine
+        // is the behavior of the state
+        AsyncAction<BbT> asyncAction;
         TransitionContext destination;
+        bool conditionsAreExclusive = false;
+
+        // When set, the state is not evaluated until this condition
+        // is true and it is only re-checked after waitDependencies change
+        Condition<BbT> waitCondition;
+        FieldMask waitDependencies = 0;
+
+        // When set, the first caseValues.size() conditions are cases
+        // of a switch, i-th of them is hit when selector returns caseValues[i]
+        SwitchSelector<BbT> switchSelector;
+        std::vector<std::int64_t> caseValues;
     };
 
     template<BlackboardTypeConcept BbT>
@@ -39,6 +64,21 @@ namespace fsm::detail
         std::string entryState;
         std::string currentlyBuiltState;
         std::map<std::string, StateBuilderContext<BbT>> states;
+
+        // Evaluated before the state of this machine or of any submachine
+        // invoked from it, outer machines first
+        std::vector<ConditionalTransitionContext<BbT>> interrupts;
+    };
+
+    template<BlackboardTypeConcept BbT>
+    struct GlobalInterruptContext
+    {
+        // Exactly one of the conditions is set. World condition does not
+        // read the blackboard, so it is evaluated once per batch.
+        Condition<BbT> condition;
+        WorldCondition worldCondition;
+        std::string targetMachine;
+        TransitionContext destination;
     };
 
     template<BlackboardTypeConcept BbT>
@@ -49,5 +89,15 @@ namespace fsm::detail
         Condition<BbT> errorCondition;
         TransitionContext errorDestination;
         bool useGlobalError = false;
+        size_t microstepLimit = 1;
+
+        // Ordered by priority, evaluated after the global error condition
+        std::vector<GlobalInterruptContext<BbT>> globalInterrupts;
+
+        // Machines linked from a fsm::CompiledSubmachine. Their entries
+        // in machines have no callables and only serve for validation
+        // and exports.
+        std::map<std::string, std::shared_ptr<const CompiledSubmachine<BbT>>>
+            sharedMachines;
     };
 } // namespace fsm::detail
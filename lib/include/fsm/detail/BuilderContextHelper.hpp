@@ -21,16 +21,16 @@ namespace fsm::detail
     }
 
     template<BlackboardTypeConcept BbT>
-    static inline void
-    insertNewMachineIntoContext(MachineId name, BuilderContext<BbT>& context)
+    static inline void insertNewMachineIntoContext(
+        const std::string& name, BuilderContext<BbT>& context)
     {
         context.currentlyBuiltMachine = name;
         context.machines[name] = {};
     }
 
     template<BlackboardTypeConcept BbT>
-    static inline void
-    insertNewStateIntoContext(StateId name, BuilderContext<BbT>& context)
+    static inline void insertNewStateIntoContext(
+        const std::string& name, BuilderContext<BbT>& context)
     {
         auto& machine = getCurrentlyBuiltMachine(context);
 
@@ -38,7 +38,7 @@ namespace fsm::detail
             throw Error(std::format(
                 "Trying to redeclare state with name {} in machine "
                 "{}",
-                name.get(),
+                name,
                 context.currentlyBuiltMachine));
 
         machine.currentlyBuiltState = name;
@@ -48,7 +48,8 @@ namespace fsm::detail
     template<BlackboardTypeConcept BbT>
     static inline void addConditionalTransitionToStateInCurrentMachine(
         Condition<BbT>&& condition,
-        StateId stateName,
+        FieldMask dependencies,
+        const std::string& stateName,
         BuilderContext<BbT>& context)
     {
         getCurrentlyBuiltState(context).conditions.push_back(
@@ -56,12 +57,15 @@ namespace fsm::detail
                 .condition = std::move(condition),
                 .destination = TransitionContext {
                     .primary = createFullStateName(
-                        context.currentlyBuiltMachine, stateName) } });
+                        context.currentlyBuiltMachine, stateName) },
+                .dependencies = dependencies });
     }
 
     template<BlackboardTypeConcept BbT>
     static inline void addConditionalErrorTransition(
-        Condition<BbT>&& condition, BuilderContext<BbT>& context)
+        Condition<BbT>&& condition,
+        FieldMask dependencies,
+        BuilderContext<BbT>& context)
     {
         getCurrentlyBuiltState(context).conditions.push_back(
             ConditionalTransitionContext {
@@ -72,6 +76,7 @@ namespace fsm::detail
                             "__error__",
                             context.machines.at("__error__").entryState),
                     },
+                .dependencies = dependencies,
             });
     }
 } // namespace fsm::detail
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <fsm/Types.hpp>
+#include <map>
+#include <string>
+
+namespace fsm::detail
+{
+    constexpr const char* BYTE_ERROR_STATE_NAME = "__error__";
+
+    template<ByteBlackboardTypeConcept BbT>
+    struct ByteTransitionContext
+    {
+        // Name of the target state or BYTE_ERROR_STATE_NAME
+        std::string destination;
+        ByteAction<BbT> action;
+    };
+
+    template<ByteBlackboardTypeConcept BbT>
+    struct ByteStateBuilderContext
+    {
+        std::map<std::uint8_t, ByteTransitionContext<BbT>> transitions;
+        bool errorOnOtherBytes = false;
+        ByteAction<BbT> endOfInputAction;
+    };
+
+    template<ByteBlackboardTypeConcept BbT>
+    struct ByteBuilderContext
+    {
+        std::string entryState;
+        std::string currentlyBuiltState;
+        std::map<std::string, ByteStateBuilderContext<BbT>> states;
+    };
+} // namespace fsm::detail
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64)                                       \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FSM_BYTE_SCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace fsm::detail
+{
+    /**
+     * Finds the next byte from a set of 'stop' bytes. Bytes that are not
+     * in the set keep a byte machine in its current state without
+     * executing any action, so they can be skipped in bulk.
+     *
+     * Small sets are scanned with SSE2 16 bytes at a time, larger sets
+     * and targets without SSE2 use a lookup table.
+     */
+    class [[nodiscard]] ByteScanner final
+    {
+    public:
+        static constexpr size_t MAX_VECTORIZED_STOP_BYTES = 8;
+
+    public:
+        ByteScanner() = default;
+
+        explicit ByteScanner(std::span<const std::uint8_t> stopBytes);
+
+    public:
+        /**
+         * \return Position of the first stop byte at or after pos, or
+         * input.size() if there is none.
+         */
+        [[nodiscard]] size_t
+        findStop(std::string_view input, size_t pos) const noexcept;
+
+    private:
+        [[nodiscard]] size_t
+        findStopScalar(std::string_view input, size_t pos) const noexcept;
+
+    private:
+        std::array<bool, 256> isStopByte = {};
+        size_t stopByteCount = 0;
+#ifdef FSM_BYTE_SCANNER_SSE2
+        __m128i needles[MAX_VECTORIZED_STOP_BYTES] = {};
+#endif
+    };
+} // namespace fsm::detail
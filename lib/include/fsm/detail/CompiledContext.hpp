@@ -1,25 +1,44 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <limits>
 #include <fsm/Types.hpp>
+#include <fsm/detail/Constants.hpp>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 
+namespace fsm
+{
+    template<BlackboardTypeConcept BbT>
+    class CompiledSubmachine;
+}
+
 namespace fsm::detail
 {
     class [[nodiscard]] CompiledTransition final
     {
     public:
+        constexpr CompiledTransition() noexcept = default;
+
         constexpr CompiledTransition(
-            std::initializer_list<size_t> items) noexcept
+            std::initializer_list<StateIdx> items) noexcept
         {
             assert(items.size() <= 2u);
             std::copy(items.begin(), items.end(), std::begin(data));
-            size = items.size();
+            size = static_cast<std::uint8_t>(items.size());
         }
 
         CompiledTransition(CompiledTransition&&) = default;
         CompiledTransition(const CompiledTransition&&) = delete;
 
+        CompiledTransition& operator=(CompiledTransition&&) = default;
+
     public:
         [[nodiscard]] constexpr auto begin(this auto&& self) noexcept
         {
@@ -48,23 +67,322 @@ namespace fsm::detail
             return self.data[index];
         }
 
+        /**
+         * \return Copy of the transition with offset added to its indices
+         */
+        [[nodiscard]] constexpr CompiledTransition
+        relocate(size_t offset) const noexcept
+        {
+            CompiledTransition result;
+            for (size_t idx = 0; idx < size; ++idx)
+                result.data[idx] = static_cast<StateIdx>(data[idx] + offset);
+            result.size = size;
+            return result;
+        }
+
     private:
-        size_t data[2] = { 0u, 0u };
-        size_t size = 0;
+        StateIdx data[2] = { 0u, 0u };
+        std::uint8_t size = 0;
     };
 
+    // Transition shrinks with the width of state indices
+    static_assert(sizeof(CompiledTransition) == 3u * sizeof(StateIdx));
+
     template<BlackboardTypeConcept BbT>
     struct [[nodiscard]] CompiledConditionalTransition final
     {
         Condition<BbT> onConditionHit;
+        FieldMask dependencies = 0;
+        CompiledTransition transition;
+        // Only used by logs and variants, \see VariantBuilder
+        std::uint16_t declarationIdx = 0;
+    };
+
+    /**
+     * Cases of a switch indexed by the value of the selector, relative
+     * to the lowest case value.
+     */
+    template<BlackboardTypeConcept BbT>
+    struct [[nodiscard]] CompiledSwitch final
+    {
+        static constexpr std::uint32_t NO_CASE =
+            std::numeric_limits<std::uint32_t>::max();
+
+        SwitchSelector<BbT> selector;
+        std::int64_t lowestValue = 0;
+        std::vector<std::uint32_t> table;
+        std::vector<CompiledConditionalTransition<BbT>> cases;
+
+        /**
+         * \return Case matching the current value of the selector or
+         * nullptr if there is no such case.
+         */
+        [[nodiscard]] const CompiledConditionalTransition<BbT>*
+        findCase(const BbT& blackboard) const
+        {
+            if (cases.empty()) return nullptr;
+
+            const auto offset = static_cast<std::uint64_t>(selector(blackboard))
+                                - static_cast<std::uint64_t>(lowestValue);
+            if (offset >= table.size()) return nullptr;
+
+            const auto caseIdx = table[offset];
+            return caseIdx == NO_CASE ? nullptr : &cases[caseIdx];
+        }
+    };
+
+    template<BlackboardTypeConcept BbT>
+    struct [[nodiscard]] CompiledGlobalInterrupt final
+    {
+        Condition<BbT> condition;
+        WorldCondition worldCondition;
         CompiledTransition transition;
+        size_t targetMachineIdx = 0;
+    };
+
+    /**
+     * Parts of a state that few states have. They are stored in a side
+     * table next to the states, so the states evaluated on every tick
+     * stay small.
+     */
+    template<BlackboardTypeConcept BbT>
+    struct [[nodiscard]] CompiledStateExtras final
+    {
+        Condition<BbT> waitCondition;
+        FieldMask waitDependencies = 0;
+        CompiledSwitch<BbT> switchTable;
+        AsyncAction<BbT> startAsyncBehavior;
     };
 
     template<BlackboardTypeConcept BbT>
     struct [[nodiscard]] CompiledState final
     {
+        static constexpr StateIdx NO_EXTRAS = NO_STATE_IDX;
+
+        StateIdx machineIdx = 0;
+        // Index to the extras table of the owner of the state
+        StateIdx extrasIdx = NO_EXTRAS;
         std::vector<CompiledConditionalTransition<BbT>> conditionalTransitions;
         Action<BbT> executeBehavior;
         CompiledTransition defaultTransition;
     };
+
+    /**
+     * States of a fsm::CompiledSubmachine linked into a model. They occupy
+     * a contiguous block of state indices and their transitions are stored
+     * relative to the start of the block.
+     */
+    template<BlackboardTypeConcept BbT>
+    struct [[nodiscard]] LinkedSubmachine final
+    {
+        std::shared_ptr<const CompiledSubmachine<BbT>> owner;
+        std::span<const CompiledState<BbT>> states;
+        std::span<const CompiledStateExtras<BbT>> stateExtras;
+        size_t machineIdx = 0;
+    };
+
+    /**
+     * Where the state of given index is stored. Transitions of the state
+     * are relative to offset.
+     */
+    template<BlackboardTypeConcept BbT>
+    struct [[nodiscard]] StateSlot final
+    {
+        const CompiledState<BbT>* state = nullptr;
+        // Null if the state has no extras
+        const CompiledStateExtras<BbT>* extras = nullptr;
+        StateIdx machineIdx = 0;
+        StateIdx offset = 0;
+    };
+
+    /**
+     * Everything Fsm needs to tick blackboards, whether it was compiled
+     * from a builder context or loaded from a saved model.
+     *
+     * A variant of another model only owns the states it overrides,
+     * every other state is read from the base model.
+     */
+    template<BlackboardTypeConcept BbT>
+    struct [[nodiscard]] CompiledModel final
+    {
+        // Shared with the variants of the model
+        std::shared_ptr<const std::vector<std::string>> stateIdToName;
+        std::vector<CompiledState<BbT>> states;
+        // Indexed by CompiledState::extrasIdx of the states
+        std::vector<CompiledStateExtras<BbT>> stateExtras;
+        size_t errorStateEndIdx = 0;
+        size_t microstepLimit = 1;
+        CompiledConditionalTransition<BbT> globalErrorTransition;
+        std::vector<std::vector<CompiledConditionalTransition<BbT>>>
+            machineInterrupts;
+        std::vector<CompiledGlobalInterrupt<BbT>> globalInterrupts;
+        // Indexed after the states of the model, in this order
+        std::vector<LinkedSubmachine<BbT>> linkedSubmachines;
+        // Set for variants, states[k] replaces the state of index
+        // overriddenStateIdxs[k] of the base model
+        std::shared_ptr<const CompiledModel> base;
+        std::vector<size_t> overriddenStateIdxs;
+
+        // Derived from the fields above by link
+        std::vector<StateSlot<BbT>> slots;
+        bool hasInterrupts = false;
+        bool hasAgentGlobalInterrupts = false;
+        // Index of the first global interrupt targeting given machine
+        std::vector<size_t> globalInterruptLimits;
+        // Contexts read by the callables, checked once per tick
+        std::vector<ContextCheck> contextChecks;
+
+        // Incremented by each reload of the model
+        size_t generation = 0;
+        // k-th table maps state indices of generation (generation - 1 - k)
+        // to this model, NO_STATE_IDX if the state no longer exists
+        std::vector<std::vector<StateIdx>> remapTables;
+
+        /**
+         * Recompute the derived fields, must be called whenever
+         * the states or the interrupts change and after a copy.
+         */
+        void link()
+        {
+            slots.clear();
+            if (base)
+            {
+                // Variants don't override the extras, so the slots keep
+                // pointing to those of the base
+                slots = base->slots;
+                for (size_t idx = 0; idx < states.size(); ++idx)
+                    slots[overriddenStateIdxs[idx]].state = &states[idx];
+            }
+            else
+                linkOwnStates();
+
+            hasInterrupts = std::ranges::any_of(
+                machineInterrupts,
+                [](const auto& interrupts) { return !interrupts.empty(); });
+            hasAgentGlobalInterrupts = std::ranges::any_of(
+                globalInterrupts,
+                [](const auto& interrupt)
+                { return static_cast<bool>(interrupt.condition); });
+
+            // Going backwards so each machine ends up with the priority
+            // of the first interrupt targeting it
+            globalInterruptLimits.assign(
+                machineInterrupts.size(), globalInterrupts.size());
+            for (size_t idx = globalInterrupts.size(); idx-- > 0;)
+                globalInterruptLimits[globalInterrupts[idx].targetMachineIdx] =
+                    idx;
+
+            collectContextChecks();
+        }
+
+        /**
+         * Make this model the next generation of the previous one. States
+         * are matched by their full names.
+         */
+        void succeed(const CompiledModel& previous)
+        {
+            auto&& nameToIdx = std::map<std::string_view, StateIdx>();
+            for (size_t idx = 0; idx < stateIdToName->size(); ++idx)
+                nameToIdx.emplace(
+                    (*stateIdToName)[idx], static_cast<StateIdx>(idx));
+
+            auto&& remap = std::vector<StateIdx>();
+            remap.reserve(previous.stateIdToName->size());
+            for (auto&& name : *previous.stateIdToName)
+            {
+                auto&& itr = nameToIdx.find(name);
+                remap.push_back(
+                    itr == nameToIdx.end() ? NO_STATE_IDX : itr->second);
+            }
+
+            generation = previous.generation + 1;
+            remapTables.clear();
+            remapTables.push_back(std::move(remap));
+
+            // Older generations are remapped through the previous model
+            for (auto&& table : previous.remapTables)
+            {
+                if (remapTables.size() == MAX_REMAP_GENERATIONS) break;
+
+                auto&& composed = std::vector<StateIdx>(table);
+                for (auto&& idx : composed)
+                    if (idx != NO_STATE_IDX) idx = remapTables.front()[idx];
+                remapTables.push_back(std::move(composed));
+            }
+        }
+
+    private:
+        void collectContextChecks()
+        {
+            contextChecks.clear();
+            auto addCheck = [&](const auto& callable)
+            {
+                const auto check = callable.getContextCheck();
+                if (check
+                    && std::ranges::find(contextChecks, check)
+                           == contextChecks.end())
+                    contextChecks.push_back(check);
+            };
+            auto addTransitionChecks = [&](const auto& transitions)
+            {
+                for (auto&& transition : transitions)
+                    addCheck(transition.onConditionHit);
+            };
+
+            for (auto&& slot : slots)
+            {
+                addTransitionChecks(slot.state->conditionalTransitions);
+                addCheck(slot.state->executeBehavior);
+                if (!slot.extras) continue;
+
+                addCheck(slot.extras->waitCondition);
+                addCheck(slot.extras->switchTable.selector);
+                addTransitionChecks(slot.extras->switchTable.cases);
+                addCheck(slot.extras->startAsyncBehavior);
+            }
+
+            addCheck(globalErrorTransition.onConditionHit);
+            for (auto&& interrupts : machineInterrupts)
+                addTransitionChecks(interrupts);
+            for (auto&& interrupt : globalInterrupts)
+            {
+                addCheck(interrupt.condition);
+                addCheck(interrupt.worldCondition);
+            }
+        }
+
+        void linkOwnStates()
+        {
+            for (auto&& state : states)
+                slots.push_back(StateSlot<BbT> {
+                    .state = &state,
+                    .extras = findExtras(state, stateExtras),
+                    .machineIdx = state.machineIdx,
+                });
+
+            for (auto&& submachine : linkedSubmachines)
+            {
+                const auto offset = static_cast<StateIdx>(slots.size());
+                for (auto&& state : submachine.states)
+                    slots.push_back(StateSlot<BbT> {
+                        .state = &state,
+                        .extras = findExtras(state, submachine.stateExtras),
+                        .machineIdx =
+                            static_cast<StateIdx>(submachine.machineIdx),
+                        .offset = offset,
+                    });
+            }
+        }
+
+        [[nodiscard]] static const CompiledStateExtras<BbT>* findExtras(
+            const CompiledState<BbT>& state,
+            std::span<const CompiledStateExtras<BbT>> table) noexcept
+        {
+            if (state.extrasIdx == CompiledState<BbT>::NO_EXTRAS)
+                return nullptr;
+
+            assert(state.extrasIdx < table.size());
+            return &table[state.extrasIdx];
+        }
+    };
 } // namespace fsm::detail
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <format>
+#include <fsm/Error.hpp>
 #include <fsm/Types.hpp>
 #include <fsm/detail/BuilderContext.hpp>
 #include <fsm/detail/CompiledContext.hpp>
+#include <fsm/detail/Constants.hpp>
 #include <fsm/detail/Helper.hpp>
 #include <fsm/detail/StateIndex.hpp>
 #include <ranges>
@@ -20,11 +24,22 @@ namespace fsm::detail
         compileConditionalTransition(
             Condition<BbT>&& condition,
             const TransitionContext& destination,
-            const StateIndex& index)
+            const StateIndex& index,
+            size_t declarationIdx = 0,
+            FieldMask dependencies = 0)
         {
+            if (declarationIdx > MAX_DECLARATION_IDX)
+                throw Error(std::format(
+                    "Conditional transition declared as {} exceeds "
+                    "the supported maximum of {}",
+                    declarationIdx,
+                    MAX_DECLARATION_IDX));
+
             return CompiledConditionalTransition {
                 .onConditionHit = std::move(condition),
+                .dependencies = dependencies,
                 .transition = compileTransition(destination, index),
+                .declarationIdx = static_cast<std::uint16_t>(declarationIdx),
             };
         }
 
@@ -41,9 +56,8 @@ namespace fsm::detail
                     index);
             }
 
-            return CompiledConditionalTransition<BbT> {
-                .onConditionHit = [](const BbT&) { return false; },
-            };
+            // Empty condition is never evaluated
+            return CompiledConditionalTransition<BbT> {};
         }
 
         template<BlackboardTypeConcept BbT>
@@ -59,42 +73,251 @@ namespace fsm::detail
                            return compileConditionalTransition(
                                std::move(transition.condition),
                                transition.destination,
-                               index);
+                               index,
+                               transition.declarationIdx,
+                               transition.dependencies);
                        })
                    | std::ranges::to<std::vector>();
         }
 
+        /**
+         * Move the switch cases out of the state conditions into a lookup
+         * table indexed by the case value.
+         */
         template<BlackboardTypeConcept BbT>
-        [[nodiscard]] static CompiledState<BbT>
-        compileState(StateBuilderContext<BbT>& state, const StateIndex& index)
+        [[nodiscard]] static CompiledSwitch<BbT>
+        compileSwitch(StateBuilderContext<BbT>& state, const StateIndex& index)
         {
-            return CompiledState<BbT> {
+            if (state.caseValues.empty()) return {};
+
+            const auto [lowest, highest] =
+                std::ranges::minmax(state.caseValues);
+            const auto tableSize = static_cast<std::uint64_t>(highest)
+                                   - static_cast<std::uint64_t>(lowest) + 1u;
+            if (tableSize > MAX_SWITCH_TABLE_SIZE)
+                throw Error(std::format(
+                    "Switch cases span {} values which is more than "
+                    "supported maximum of {}",
+                    tableSize,
+                    MAX_SWITCH_TABLE_SIZE));
+
+            auto&& result = CompiledSwitch<BbT> {
+                .selector = std::move(state.switchSelector),
+                .lowestValue = lowest,
+                .table = std::vector<std::uint32_t>(
+                    tableSize, CompiledSwitch<BbT>::NO_CASE),
+            };
+
+            for (size_t caseIdx = 0; caseIdx < state.caseValues.size();
+                 ++caseIdx)
+            {
+                auto& condition = state.conditions[caseIdx];
+                result.table[state.caseValues[caseIdx] - lowest] =
+                    static_cast<std::uint32_t>(caseIdx);
+                result.cases.push_back(compileConditionalTransition(
+                    Condition<BbT> {},
+                    condition.destination,
+                    index,
+                    condition.declarationIdx));
+            }
+
+            state.conditions.erase(
+                state.conditions.begin(),
+                state.conditions.begin() + state.caseValues.size());
+            return result;
+        }
+
+        /**
+         * \param stateExtras Table the switch, the wait condition and
+         * the async behavior of the state are appended to, if it has any
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static CompiledState<BbT> compileState(
+            StateBuilderContext<BbT>& state,
+            const StateIndex& index,
+            size_t machineIdx,
+            std::vector<CompiledStateExtras<BbT>>& stateExtras)
+        {
+            // Must be compiled first, it removes cases from conditions
+            auto&& switchTable = compileSwitch(state, index);
+
+            auto&& result = CompiledState<BbT> {
+                .machineIdx = static_cast<StateIdx>(machineIdx),
                 .conditionalTransitions =
                     compileAllConditionalTransitions(state.conditions, index),
                 .executeBehavior = std::move(state.action),
                 .defaultTransition =
                     compileTransition(state.destination, index),
             };
+
+            if (state.waitCondition || switchTable.selector
+                || state.asyncAction)
+            {
+                result.extrasIdx = static_cast<StateIdx>(stateExtras.size());
+                stateExtras.push_back(CompiledStateExtras<BbT> {
+                    .waitCondition = std::move(state.waitCondition),
+                    .waitDependencies = state.waitDependencies,
+                    .switchTable = std::move(switchTable),
+                    .startAsyncBehavior = std::move(state.asyncAction),
+                });
+            }
+
+            return result;
         }
 
+        /**
+         * Compile all states except those of shared machines, which are
+         * indexed last and linked by compileLinkedSubmachines
+         */
         template<BlackboardTypeConcept BbT>
-        [[nodiscard]] static std::vector<CompiledState<BbT>>
-        compileMachine(BuilderContext<BbT>& context, const StateIndex& index)
+        [[nodiscard]] static std::vector<CompiledState<BbT>> compileMachine(
+            BuilderContext<BbT>& context,
+            const StateIndex& index,
+            std::vector<CompiledStateExtras<BbT>>& stateExtras)
         {
+            const auto ownStatesCount =
+                index.getSize() - getSharedStatesCount(context);
             return index.getIndexedStateNames()
+                   | std::views::take(ownStatesCount)
                    | std::views::transform(
                        [](const std::string& fullName)
                        { return getMachineAndStateNameFromFullName(fullName); })
                    | std::views::transform(
-                       [&context, &index](
+                       [&context, &index, &stateExtras](
                            const std::pair<std::string, std::string>& namePair)
                        {
+                           const auto machineIt =
+                               context.machines.find(namePair.first);
                            return compileState(
-                               context.machines[namePair.first]
-                                   .states[namePair.second],
-                               index);
+                               machineIt->second.states[namePair.second],
+                               index,
+                               static_cast<size_t>(std::distance(
+                                   context.machines.begin(), machineIt)),
+                               stateExtras);
+                       })
+                   | std::ranges::to<std::vector>();
+        }
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::vector<CompiledGlobalInterrupt<BbT>>
+        compileGlobalInterrupts(
+            BuilderContext<BbT>& context, const StateIndex& index)
+        {
+            return context.globalInterrupts
+                   | std::views::transform(
+                       [&context,
+                        &index](GlobalInterruptContext<BbT>& interrupt)
+                       {
+                           return CompiledGlobalInterrupt<BbT> {
+                               .condition = std::move(interrupt.condition),
+                               .worldCondition =
+                                   std::move(interrupt.worldCondition),
+                               .transition = compileTransition(
+                                   interrupt.destination, index),
+                               .targetMachineIdx =
+                                   static_cast<size_t>(std::distance(
+                                       context.machines.begin(),
+                                       context.machines.find(
+                                           interrupt.targetMachine))),
+                           };
+                       })
+                   | std::ranges::to<std::vector>();
+        }
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::vector<LinkedSubmachine<BbT>>
+        compileLinkedSubmachines(const BuilderContext<BbT>& context)
+        {
+            return context.sharedMachines
+                   | std::views::transform(
+                       [&context](const auto& pair)
+                       {
+                           return LinkedSubmachine<BbT> {
+                               .owner = pair.second,
+                               .states = pair.second->getStates(),
+                               .stateExtras = pair.second->getStateExtras(),
+                               .machineIdx = static_cast<size_t>(
+                                   std::distance(
+                                       context.machines.begin(),
+                                       context.machines.find(pair.first))),
+                           };
+                       })
+                   | std::ranges::to<std::vector>();
+        }
+
+        /**
+         * Interrupts of each machine, indexed by the same machine index
+         * as CompiledState::machineIdx. Interrupts of shared machines
+         * are copied from the submachine and relocated.
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::vector<
+            std::vector<CompiledConditionalTransition<BbT>>>
+        compileMachineInterrupts(
+            BuilderContext<BbT>& context, const StateIndex& index)
+        {
+            return context.machines
+                   | std::views::transform(
+                       [&context, &index](auto& pair)
+                       {
+                           auto&& shared =
+                               context.sharedMachines.find(pair.first);
+                           if (shared == context.sharedMachines.end())
+                               return compileAllConditionalTransitions(
+                                   pair.second.interrupts, index);
+
+                           return relocateInterrupts(
+                               shared->second->getInterrupts(),
+                               index.getStateIndex(createFullStateName(
+                                   pair.first,
+                                   shared->second->getStateNames().front())));
                        })
                    | std::ranges::to<std::vector>();
         }
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::vector<CompiledConditionalTransition<BbT>>
+        relocateInterrupts(
+            const std::vector<CompiledConditionalTransition<BbT>>& interrupts,
+            size_t offset)
+        {
+            return interrupts
+                   | std::views::transform(
+                       [offset](const auto& interrupt)
+                       {
+                           return CompiledConditionalTransition<BbT> {
+                               .onConditionHit = interrupt.onConditionHit,
+                               .dependencies = interrupt.dependencies,
+                               .transition =
+                                   interrupt.transition.relocate(offset),
+                               .declarationIdx = interrupt.declarationIdx,
+                           };
+                       })
+                   | std::ranges::to<std::vector>();
+        }
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static CompiledModel<BbT>
+        compileModel(BuilderContext<BbT>& context, const StateIndex& index)
+        {
+            auto&& stateExtras = std::vector<CompiledStateExtras<BbT>>();
+            auto&& states = compileMachine(context, index, stateExtras);
+            auto&& model = CompiledModel<BbT> {
+                .stateIdToName =
+                    std::make_shared<const std::vector<std::string>>(
+                        index.getIndexedStateNames()),
+                .states = std::move(states),
+                .stateExtras = std::move(stateExtras),
+                .errorStateEndIdx = getErrorStatesCount(context) + 1,
+                .microstepLimit = context.microstepLimit,
+                .globalErrorTransition =
+                    compileGlobalErrorTransition(context, index),
+                .machineInterrupts = compileMachineInterrupts(context, index),
+                .globalInterrupts = compileGlobalInterrupts(context, index),
+                .linkedSubmachines = compileLinkedSubmachines(context),
+            };
+            model.link();
+            return model;
+        }
     };
 } // namespace fsm::detail
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace fsm::detail
 {
     constexpr const char* MAIN_MACHINE_NAME = "__main__";
@@ -7,4 +9,16 @@ namespace fsm::detail
     constexpr const char* RESTART_METASTATE_NAME = "__restart__";
     constexpr const char* RESTART_METASTATE_TRANSITION =
         "__error__:__restart__";
+
+    // Maximum distance between the lowest and the highest case of a switch
+    constexpr size_t MAX_SWITCH_TABLE_SIZE = 4096;
+
+    // Global interrupts are evaluated into a 64-bit mask
+    constexpr size_t MAX_GLOBAL_INTERRUPTS = 64;
+
+    // Declaration indices of conditional transitions are stored in 16 bits
+    constexpr size_t MAX_DECLARATION_IDX = 65535;
+
+    // Blackboards ticked last by an older model fall back to the main entry
+    constexpr size_t MAX_REMAP_GENERATIONS = 16;
 } // namespace fsm::detail
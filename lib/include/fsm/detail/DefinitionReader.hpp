@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <string_view>
+
+namespace fsm::detail
+{
+    /**
+     * Splits a machine definition into lines of whitespace separated
+     * tokens. Empty lines and comments starting with # are skipped.
+     * Tokens are views into the source text, nothing is copied.
+     */
+    class [[nodiscard]] DefinitionReader final
+    {
+    public:
+        static constexpr size_t MAX_TOKENS_PER_LINE = 8;
+
+    public:
+        explicit DefinitionReader(std::string_view text) noexcept
+            : text(text)
+        {
+        }
+
+    public:
+        /**
+         * Move to the next non-empty line.
+         *
+         * \return false if there are no more lines
+         * \throws fsm::Error if the line has too many tokens
+         */
+        [[nodiscard]] bool nextLine();
+
+        [[nodiscard]] constexpr std::span<const std::string_view>
+        getTokens() const noexcept
+        {
+            return std::span(tokens).first(tokenCount);
+        }
+
+        [[nodiscard]] constexpr size_t getLineNumber() const noexcept
+        {
+            return lineNumber;
+        }
+
+    private:
+        std::string_view text;
+        size_t position = 0;
+        size_t lineNumber = 0;
+        std::array<std::string_view, MAX_TOKENS_PER_LINE> tokens;
+        size_t tokenCount = 0;
+    };
+} // namespace fsm::detail
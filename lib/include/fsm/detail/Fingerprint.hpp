@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <fsm/Types.hpp>
+#include <fsm/detail/BuilderContext.hpp>
+#include <functional>
+#include <string_view>
+
+namespace fsm::detail
+{
+    /**
+     * Stable structural hash (64-bit FNV-1a) of a builder context.
+     * Integers are hashed in little-endian order and strings
+     * with their length, so the hash is the same on every platform.
+     */
+    class [[nodiscard]] Fingerprint final
+    {
+    public:
+        void addU64(std::uint64_t number) noexcept;
+
+        void addString(std::string_view text) noexcept;
+
+        /**
+         * Hash everything the compiled model is built from. Callables
+         * are identified by the names they were registered under
+         * in fsm::CallableRegistry.
+         *
+         * \return False if the context contains a callable without a name,
+         * an async behavior, a switch, a world interrupt or a shared machine
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] bool addContext(const BuilderContext<BbT>& context)
+        {
+            if (!context.sharedMachines.empty()) return false;
+
+            bool complete = true;
+            auto&& addCallable = [&](const auto& callable)
+            { complete = addCallableName(callable) && complete; };
+
+            auto&& addDestination = [&](const TransitionContext& destination)
+            {
+                addString(destination.primary);
+                addString(destination.secondary);
+            };
+
+            auto&& addConditional =
+                [&](const ConditionalTransitionContext<BbT>& transition)
+            {
+                addCallable(transition.condition);
+                addDestination(transition.destination);
+                addU64(transition.declarationIdx);
+                addU64(transition.dependencies);
+            };
+
+            addU64(context.machines.size());
+            for (auto&& [machineName, machine] : context.machines)
+            {
+                addString(machineName);
+                addString(machine.entryState);
+
+                addU64(machine.interrupts.size());
+                for (auto&& interrupt : machine.interrupts)
+                    addConditional(interrupt);
+
+                addU64(machine.states.size());
+                for (auto&& [stateName, state] : machine.states)
+                {
+                    if (state.asyncAction || state.switchSelector)
+                        return false;
+
+                    addString(stateName);
+                    addU64(state.conditions.size());
+                    for (auto&& condition : state.conditions)
+                        addConditional(condition);
+                    addCallable(state.action);
+                    addDestination(state.destination);
+                    addU64(state.conditionsAreExclusive);
+                    addCallable(state.waitCondition);
+                    addU64(state.waitDependencies);
+                }
+            }
+
+            addCallable(context.errorCondition);
+            addDestination(context.errorDestination);
+            addU64(context.useGlobalError);
+            addU64(context.microstepLimit);
+
+            addU64(context.globalInterrupts.size());
+            for (auto&& interrupt : context.globalInterrupts)
+            {
+                if (interrupt.worldCondition) return false;
+
+                addCallable(interrupt.condition);
+                addString(interrupt.targetMachine);
+                addDestination(interrupt.destination);
+            }
+
+            return complete;
+        }
+
+        [[nodiscard]] constexpr std::uint64_t getValue() const noexcept
+        {
+            return value;
+        }
+
+    private:
+        template<class R, class... Args>
+        [[nodiscard]] bool
+        addCallableName(const TickCallable<R(Args...)>& callable)
+        {
+            if (!callable)
+            {
+                addString("none");
+                return true;
+            }
+
+            if constexpr (std::is_void_v<R>)
+            {
+                if (callable.template target<DoNothing>())
+                {
+                    addString("nothing");
+                    return true;
+                }
+            }
+
+            auto&& named = callable.template target<
+                NamedCallable<TickCallable<R(Args...)>>>();
+            if (!named) return false;
+
+            addString("named");
+            addString(named->name);
+            return true;
+        }
+
+    private:
+        std::uint64_t value = 0xcbf29ce484222325;
+    };
+} // namespace fsm::detail
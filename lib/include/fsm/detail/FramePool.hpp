@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+namespace fsm::detail
+{
+    /**
+     * Recycles memory of coroutine frames of async behaviors, so starting
+     * a behavior only allocates when no released frame of the same size
+     * is available.
+     *
+     * Each thread has its own free frames, so allocation takes no lock.
+     * A frame released on another thread than the one that allocated it
+     * joins the free frames of the releasing thread. Free frames are
+     * returned to the heap when their thread exits.
+     */
+    class FramePool final
+    {
+    public:
+        FramePool() = delete;
+
+    public:
+        [[nodiscard]] static void* allocate(size_t size);
+
+        static void deallocate(void* frame, size_t size) noexcept;
+
+        /**
+         * Number of released frames of the calling thread waiting
+         * to be reused
+         */
+        [[nodiscard]] static size_t getFreeFrameCount() noexcept;
+    };
+} // namespace fsm::detail
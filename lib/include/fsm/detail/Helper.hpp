@@ -1,10 +1,10 @@
 #pragma once
 
+#include <fsm/CompiledSubmachine.hpp>
 #include <fsm/detail/BuilderContext.hpp>
 #include <fsm/detail/CompiledContext.hpp>
 #include <fsm/detail/Constants.hpp>
 #include <fsm/detail/StateIndex.hpp>
-#include <ranges>
 
 namespace fsm::detail
 {
@@ -51,9 +51,13 @@ namespace fsm::detail
                 ERROR_MACHINE_NAME,
                 context.machines.at(ERROR_MACHINE_NAME));
 
+        // Shared machines are appended after the layout of the other
+        // states is final, \see appendSharedMachinesToIndex
         for (auto&& [machineName, machineContext] : context.machines)
         {
-            if (machineName == ERROR_MACHINE_NAME) continue;
+            if (machineName == ERROR_MACHINE_NAME
+                || context.sharedMachines.contains(machineName))
+                continue;
 
             updateIndexWithMachineContext(index, machineName, machineContext);
         }
@@ -61,16 +65,48 @@ namespace fsm::detail
         return index;
     }
 
-    [[nodiscard]] size_t popTopState(BlackboardBase& bb);
+    /**
+     * Index the states of each shared machine as a contiguous block
+     * in the order of the compiled submachine
+     */
+    template<BlackboardTypeConcept BbT>
+    void appendSharedMachinesToIndex(
+        StateIndex& index, const BuilderContext<BbT>& context)
+    {
+        for (auto&& [machineName, submachine] : context.sharedMachines)
+            for (auto&& stateName : submachine->getStateNames())
+                index.addNameToIndex(
+                    createFullStateName(machineName, stateName));
+    }
 
-    constexpr static void
-    executeTransition(BlackboardBase& bb, const CompiledTransition& transition)
+    template<BlackboardTypeConcept BbT>
+    [[nodiscard]] size_t
+    getSharedStatesCount(const BuilderContext<BbT>& context) noexcept
+    {
+        size_t count = 0;
+        for (auto&& [_, submachine] : context.sharedMachines)
+            count += submachine->getStates().size();
+        return count;
+    }
+
+    template<BlackboardTypeConcept BbT>
+    [[nodiscard]] constexpr StateIdx popTopState(BbT& bb)
+    {
+        auto idx = bb.__stateIdxs.back();
+        bb.__stateIdxs.pop_back();
+        return idx;
+    }
+
+    /**
+     * Execute a transition whose indices are relative to offset
+     */
+    template<BlackboardTypeConcept BbT>
+    constexpr void executeTransition(
+        BbT& bb, const CompiledTransition& transition, size_t offset = 0)
     {
-        auto reverseTransition = std::ranges::reverse_view(transition);
-        bb.__stateIdxs.insert(
-            bb.__stateIdxs.end(),
-            reverseTransition.begin(),
-            reverseTransition.end());
+        for (size_t idx = transition.getSize(); idx-- > 0;)
+            bb.__stateIdxs.push_back(
+                static_cast<StateIdx>(transition[idx] + offset));
     }
 
     template<BlackboardTypeConcept BbT>
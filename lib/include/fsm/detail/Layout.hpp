@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <fsm/Profile.hpp>
+#include <fsm/detail/BuilderContext.hpp>
+#include <fsm/detail/Helper.hpp>
+#include <fsm/detail/StateIndex.hpp>
+
+namespace fsm::detail
+{
+    /**
+     * Renumber the states of an index so that states that are often
+     * ticked one after another get neighbouring indices and the most
+     * ticked states get the lowest indices.
+     *
+     * Index 0 (main machine entry) is kept in place and error states
+     * are kept in the block 1..errorStatesCount, they are only reordered
+     * within that block. States missing from the profile keep their
+     * relative order and are placed after all profiled states of their
+     * block.
+     */
+    [[nodiscard]] StateIndex reorderStateIndexByProfile(
+        const StateIndex& index,
+        size_t errorStatesCount,
+        const Profile& profile);
+
+    /**
+     * Sort conditions of states marked as mutually exclusive so that
+     * the most often hit condition is evaluated first. Since at most one
+     * condition of such state can be true, the order does not change
+     * which transition is taken, only how many conditions are evaluated
+     * before it is found. Conditions with equal hit counts keep their
+     * declaration order. Switch cases are left in place, they are
+     * dispatched through a lookup table regardless of their order.
+     */
+    template<BlackboardTypeConcept BbT>
+    void reorderExclusiveConditions(
+        BuilderContext<BbT>& context, const Profile& profile)
+    {
+        for (auto&& [machineName, machineContext] : context.machines)
+        {
+            for (auto&& [stateName, stateContext] : machineContext.states)
+            {
+                if (!stateContext.conditionsAreExclusive) continue;
+
+                const auto fullName =
+                    createFullStateName(machineName, stateName);
+                auto& conditions = stateContext.conditions;
+                std::ranges::stable_sort(
+                    conditions.begin() + stateContext.caseValues.size(),
+                    conditions.end(),
+                    std::ranges::greater {},
+                    [&](const ConditionalTransitionContext<BbT>& condition)
+                    {
+                        return profile.getConditionHitCount(
+                            fullName, condition.declarationIdx);
+                    });
+            }
+        }
+    }
+} // namespace fsm::detail
@@ -0,0 +1,356 @@
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <fsm/CallableRegistry.hpp>
+#include <fsm/Error.hpp>
+#include <fsm/Types.hpp>
+#include <fsm/detail/BinaryIO.hpp>
+#include <fsm/detail/CompiledContext.hpp>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace fsm::detail
+{
+    /**
+     * Binary format of CompiledModel. The model is written as-is,
+     * conditions and actions are stored as indices into a table
+     * of callable names.
+     *
+     * Layout (all integers little-endian):
+     *  - magic, version
+     *  - callable names
+     *  - state names, error state end, microstep limit
+     *  - states
+     *  - global error transition
+     *  - interrupts of each machine
+     *  - global interrupts
+     */
+    class ModelSerializer final
+    {
+    public:
+        static constexpr std::uint32_t MAGIC = 0x4d4d5346; // "FSMM"
+        static constexpr std::uint32_t VERSION = 1;
+
+    public:
+        /**
+         * \throws fsm::Error if the model contains a callable that was not
+         * obtained from CallableRegistry, an async behavior, a switch,
+         * a world interrupt or a shared submachine.
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::string save(const CompiledModel<BbT>& model)
+        {
+            if (!model.linkedSubmachines.empty())
+                throw Error("Model with shared submachines cannot be saved");
+
+            auto&& callableNames = std::map<std::string, size_t>();
+            auto&& body = BinaryWriter();
+
+            auto&& writeCallable =
+                [&](const std::string& stateName, const auto& callable)
+            {
+                const auto ref =
+                    getCallableRef(stateName, callable, callableNames);
+                body.writeSize(ref);
+            };
+
+            auto&& writeConditional =
+                [&](const std::string& stateName,
+                    const CompiledConditionalTransition<BbT>& transition)
+            {
+                writeCallable(stateName, transition.onConditionHit);
+                writeTransition(body, transition.transition);
+                body.writeSize(transition.declarationIdx);
+                body.writeU64(transition.dependencies);
+            };
+
+            const auto& stateIdToName = *model.stateIdToName;
+            body.writeSize(stateIdToName.size());
+            for (auto&& name : stateIdToName)
+                body.writeString(name);
+            body.writeSize(model.errorStateEndIdx);
+            body.writeSize(model.microstepLimit);
+
+            // Variants store some of their states in the base model
+            for (size_t idx = 0; idx < model.slots.size(); ++idx)
+            {
+                const auto& name = stateIdToName[idx];
+                const auto& state = *model.slots[idx].state;
+                const auto* extras = model.slots[idx].extras;
+
+                if (extras && !extras->switchTable.cases.empty())
+                    throw Error(std::format(
+                        "State {} uses a switch, it cannot be saved", name));
+
+                if (extras && extras->startAsyncBehavior)
+                    throw Error(std::format(
+                        "State {} has an async behavior, it cannot be saved",
+                        name));
+
+                body.writeSize(state.machineIdx);
+                writeCallable(
+                    name, extras ? extras->waitCondition : Condition<BbT> {});
+                body.writeU64(extras ? extras->waitDependencies : 0);
+                body.writeSize(state.conditionalTransitions.size());
+                for (auto&& transition : state.conditionalTransitions)
+                    writeConditional(name, transition);
+                writeCallable(name, state.executeBehavior);
+                writeTransition(body, state.defaultTransition);
+            }
+
+            writeConditional("global error", model.globalErrorTransition);
+
+            body.writeSize(model.machineInterrupts.size());
+            for (auto&& interrupts : model.machineInterrupts)
+            {
+                body.writeSize(interrupts.size());
+                for (auto&& interrupt : interrupts)
+                    writeConditional("interrupt", interrupt);
+            }
+
+            body.writeSize(model.globalInterrupts.size());
+            for (auto&& interrupt : model.globalInterrupts)
+            {
+                if (interrupt.worldCondition)
+                    throw Error(
+                        "Model with world interrupts cannot be saved");
+
+                writeCallable("global interrupt", interrupt.condition);
+                writeTransition(body, interrupt.transition);
+                body.writeSize(interrupt.targetMachineIdx);
+            }
+
+            auto&& header = BinaryWriter();
+            header.writeU32(MAGIC);
+            header.writeU32(VERSION);
+
+            auto&& namesByIdx = std::vector<std::string>(callableNames.size());
+            for (auto&& [name, idx] : callableNames)
+                namesByIdx[idx] = name;
+
+            header.writeSize(namesByIdx.size());
+            for (auto&& name : namesByIdx)
+                header.writeString(name);
+
+            return header.getData() + body.getData();
+        }
+
+        /**
+         * \throws fsm::Error if the data are not a valid model or a callable
+         * is missing in the registry
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static CompiledModel<BbT> load(
+            std::span<const char> data, const CallableRegistry<BbT>& registry)
+        {
+            auto&& reader = BinaryReader(data);
+            if (reader.readU32() != MAGIC)
+                throw Error("Data do not contain a saved FSM model");
+
+            if (const auto version = reader.readU32(); version != VERSION)
+                throw Error(std::format(
+                    "Unsupported model version {}, expected {}",
+                    version,
+                    VERSION));
+
+            auto&& callableNames = std::vector<std::string_view>(
+                reader.readCount(MIN_STRING_SIZE));
+            for (auto&& name : callableNames)
+                name = reader.readString();
+
+            auto&& stateIdToName =
+                std::vector<std::string>(reader.readCount(MIN_STRING_SIZE));
+            for (auto&& name : stateIdToName)
+                name = reader.readString();
+
+            auto&& model = CompiledModel<BbT> {};
+            model.errorStateEndIdx = reader.readSize();
+            model.microstepLimit = reader.readSize();
+
+            const auto stateCount = stateIdToName.size();
+            if (stateCount >= NO_STATE_IDX)
+                throw Error(std::format(
+                    "Model has {} states, at most {} are supported, see "
+                    "FSM_STATE_INDEX_BITS",
+                    stateCount,
+                    size_t { NO_STATE_IDX }));
+
+            // Entry state of the main machine is always the first one
+            if (model.errorStateEndIdx == 0
+                || model.errorStateEndIdx > stateCount)
+                throw Error(std::format(
+                    "Invalid end of error states {} for {} states",
+                    model.errorStateEndIdx,
+                    stateCount));
+
+            if (model.microstepLimit == 0)
+                throw Error("Step limit of the model must be positive");
+
+            model.stateIdToName =
+                std::make_shared<const std::vector<std::string>>(
+                    std::move(stateIdToName));
+            auto&& readRef = [&]
+            {
+                const auto ref = reader.readSize();
+                if (ref >= FIRST_NAMED_REF + callableNames.size())
+                    throw Error(std::format("Invalid callable index {}", ref));
+                return ref;
+            };
+
+            auto&& getName = [&](size_t ref)
+            { return callableNames[ref - FIRST_NAMED_REF]; };
+
+            auto&& readCondition = [&]() -> Condition<BbT>
+            {
+                const auto ref = readRef();
+                if (ref == NONE_REF) return {};
+                if (ref == DO_NOTHING_REF)
+                    throw Error("Condition cannot be fsm::doNothing");
+                return registry.getCondition(getName(ref));
+            };
+
+            auto&& readAction = [&]() -> Action<BbT>
+            {
+                const auto ref = readRef();
+                if (ref == NONE_REF) return {};
+                if (ref == DO_NOTHING_REF) return doNothing;
+                return registry.getAction(getName(ref));
+            };
+
+            auto&& readConditional = [&]
+            {
+                auto&& result = CompiledConditionalTransition<BbT> {};
+                result.onConditionHit = readCondition();
+                result.transition = readTransition(reader, stateCount);
+                const auto declarationIdx = reader.readSize();
+                if (declarationIdx > MAX_DECLARATION_IDX)
+                    throw Error(std::format(
+                        "Invalid declaration index {}", declarationIdx));
+                result.declarationIdx =
+                    static_cast<std::uint16_t>(declarationIdx);
+                result.dependencies = reader.readU64();
+                return result;
+            };
+
+            model.states.reserve(stateCount);
+            for (size_t idx = 0; idx < stateCount; ++idx)
+            {
+                auto&& state = CompiledState<BbT> {};
+                // Each machine has a state, so a valid index is lower
+                const auto machineIdx = reader.readSize();
+                if (machineIdx >= stateCount)
+                    throw Error(
+                        std::format("Invalid machine index {}", machineIdx));
+                state.machineIdx = static_cast<StateIdx>(machineIdx);
+
+                auto&& waitCondition = readCondition();
+                const auto waitDependencies = reader.readU64();
+                if (waitCondition)
+                {
+                    state.extrasIdx =
+                        static_cast<StateIdx>(model.stateExtras.size());
+                    model.stateExtras.push_back(CompiledStateExtras<BbT> {
+                        .waitCondition = std::move(waitCondition),
+                        .waitDependencies = waitDependencies,
+                    });
+                }
+
+                state.conditionalTransitions.resize(
+                    reader.readCount(MIN_CONDITIONAL_SIZE));
+                for (auto&& transition : state.conditionalTransitions)
+                    transition = readConditional();
+                state.executeBehavior = readAction();
+                state.defaultTransition = readTransition(reader, stateCount);
+                model.states.push_back(std::move(state));
+            }
+
+            model.globalErrorTransition = readConditional();
+
+            model.machineInterrupts.resize(reader.readCount(MIN_COUNT_SIZE));
+            for (auto&& interrupts : model.machineInterrupts)
+            {
+                interrupts.resize(reader.readCount(MIN_CONDITIONAL_SIZE));
+                for (auto&& interrupt : interrupts)
+                    interrupt = readConditional();
+            }
+
+            model.globalInterrupts.resize(
+                reader.readCount(MIN_GLOBAL_INTERRUPT_SIZE));
+            for (auto&& interrupt : model.globalInterrupts)
+            {
+                interrupt.condition = readCondition();
+                interrupt.transition = readTransition(reader, stateCount);
+                interrupt.targetMachineIdx = reader.readSize();
+                if (interrupt.targetMachineIdx
+                    >= model.machineInterrupts.size())
+                    throw Error(std::format(
+                        "Invalid machine index {}",
+                        interrupt.targetMachineIdx));
+            }
+
+            for (auto&& state : model.states)
+                if (state.machineIdx >= model.machineInterrupts.size())
+                    throw Error(std::format(
+                        "Invalid machine index {}", state.machineIdx));
+
+            if (!reader.isAtEnd())
+                throw Error("Unexpected data after the end of the model");
+
+            model.link();
+            return model;
+        }
+
+    private:
+        static constexpr size_t NONE_REF = 0;
+        static constexpr size_t DO_NOTHING_REF = 1;
+        static constexpr size_t FIRST_NAMED_REF = 2;
+
+        // Smallest encodings of the items whose counts are read,
+        // counts, sizes and callable references take 4 bytes
+        static constexpr size_t MIN_COUNT_SIZE = 4u;
+        static constexpr size_t MIN_STRING_SIZE = 4u;
+        static constexpr size_t MIN_TRANSITION_SIZE = 1u;
+        static constexpr size_t MIN_CONDITIONAL_SIZE =
+            4u + MIN_TRANSITION_SIZE + 4u + 8u;
+        static constexpr size_t MIN_GLOBAL_INTERRUPT_SIZE =
+            4u + MIN_TRANSITION_SIZE + 4u;
+
+        template<class R, class... Args>
+        [[nodiscard]] static size_t getCallableRef(
+            const std::string& stateName,
+            const TickCallable<R(Args...)>& callable,
+            std::map<std::string, size_t>& callableNames)
+        {
+            if (!callable) return NONE_REF;
+
+            if constexpr (std::is_void_v<R>)
+            {
+                if (callable.template target<DoNothing>())
+                    return DO_NOTHING_REF;
+            }
+
+            auto&& named = callable.template target<
+                NamedCallable<TickCallable<R(Args...)>>>();
+            if (!named)
+                throw Error(std::format(
+                    "{} uses a callable that is not taken from "
+                    "fsm::CallableRegistry, it cannot be saved",
+                    stateName));
+
+            auto&& [itr, _] =
+                callableNames.try_emplace(named->name, callableNames.size());
+            return FIRST_NAMED_REF + itr->second;
+        }
+
+        static void
+        writeTransition(
+            BinaryWriter& writer, const CompiledTransition& transition);
+
+        [[nodiscard]] static CompiledTransition
+        readTransition(BinaryReader& reader, size_t stateCount);
+    };
+} // namespace fsm::detail
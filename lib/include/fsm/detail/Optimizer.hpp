@@ -0,0 +1,436 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <fsm/OptimizationReport.hpp>
+#include <fsm/Types.hpp>
+#include <fsm/detail/Analyzer.hpp>
+#include <fsm/detail/BuilderContext.hpp>
+#include <fsm/detail/Constants.hpp>
+#include <fsm/detail/Helper.hpp>
+#include <functional>
+#include <map>
+#include <optional>
+#include <queue>
+#include <set>
+#include <string>
+
+namespace fsm::detail
+{
+    /**
+     * Graph transformations performed on the BuilderContext before
+     * it is indexed and compiled. Shared machines are already compiled,
+     * so they are left intact.
+     */
+    class Optimizer final
+    {
+    public:
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static OptimizationReport
+        optimize(BuilderContext<BbT>& context)
+        {
+            auto&& report = OptimizationReport {};
+            collapsePassThroughStates(context, report);
+            mergeIdenticalStates(context, report);
+            removeUnreachableStates(context, report);
+            return report;
+        }
+
+        /**
+         * Pass-through state has no conditions, its behavior is
+         * fsm::doNothing and its default transition goes to another
+         * state of the same machine. All transitions into such state
+         * are redirected to its successor. Targets of interrupts are
+         * kept, interrupting into them must not skip their behavior.
+         */
+        template<BlackboardTypeConcept BbT>
+        static void collapsePassThroughStates(
+            BuilderContext<BbT>& context, OptimizationReport& report)
+        {
+            const auto interruptTargets = getInterruptTargets(context);
+
+            auto&& successors = std::map<std::string, std::string> {};
+            for (auto&& [machineName, machineContext] : context.machines)
+            {
+                if (context.sharedMachines.contains(machineName)) continue;
+
+                for (auto&& [stateName, stateContext] : machineContext.states)
+                {
+                    const auto fullName =
+                        createFullStateName(machineName, stateName);
+                    if (!interruptTargets.contains(fullName)
+                        && isPassThroughState(fullName, stateContext))
+                        successors[fullName] =
+                            stateContext.destination.primary;
+                }
+            }
+
+            for (auto&& [fullName, _] : successors)
+            {
+                auto&& target =
+                    resolvePassThroughChain(fullName, successors);
+                if (!target) continue;
+
+                redirectTransitions(context, fullName, *target);
+                removeState(context, fullName);
+                report.mergedStates[fullName] = *target;
+            }
+        }
+
+        /**
+         * States of the same machine are identical if they have the same
+         * conditions, behavior and transitions. Callables can only be
+         * compared when they are plain function pointers or
+         * fsm::doNothing.
+         */
+        template<BlackboardTypeConcept BbT>
+        static void mergeIdenticalStates(
+            BuilderContext<BbT>& context, OptimizationReport& report)
+        {
+            const auto interruptTargets = getInterruptTargets(context);
+
+            bool merged = true;
+            while (merged)
+            {
+                merged = false;
+
+                for (auto&& [machineName, machineContext] : context.machines)
+                {
+                    if (context.sharedMachines.contains(machineName))
+                        continue;
+
+                    auto&& duplicates = findDuplicateStates(
+                        machineName, machineContext, interruptTargets);
+
+                    for (auto&& [duplicate, original] : duplicates)
+                    {
+                        redirectTransitions(context, duplicate, original);
+                        removeState(context, duplicate);
+                        report.mergedStates[duplicate] = original;
+                        merged = true;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Remove all states that cannot be reached from the entry of
+         * the main machine nor from the entry of the error machine.
+         * Machines left with no states are removed as well.
+         */
+        template<BlackboardTypeConcept BbT>
+        static void removeUnreachableStates(
+            BuilderContext<BbT>& context, OptimizationReport& report)
+        {
+            auto&& reachable = findReachableStates(context);
+
+            for (auto&& [machineName, machineContext] : context.machines)
+            {
+                if (context.sharedMachines.contains(machineName)) continue;
+
+                std::erase_if(
+                    machineContext.states,
+                    [&](const auto& pair)
+                    {
+                        const auto fullName =
+                            createFullStateName(machineName, pair.first);
+                        if (reachable.contains(fullName)) return false;
+
+                        report.removedStates.push_back(fullName);
+                        return true;
+                    });
+            }
+
+            std::erase_if(
+                context.machines,
+                [](const auto& pair) { return pair.second.states.empty(); });
+        }
+
+    private:
+        /**
+         * Full names of states that machine and global interrupts
+         * transition to
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::set<std::string>
+        getInterruptTargets(const BuilderContext<BbT>& context)
+        {
+            auto&& targets = std::set<std::string> {};
+            for (auto&& [_, machineContext] : context.machines)
+            {
+                for (auto&& interrupt : machineContext.interrupts)
+                    targets.insert(interrupt.destination.primary);
+            }
+
+            for (auto&& interrupt : context.globalInterrupts)
+                targets.insert(interrupt.destination.primary);
+
+            return targets;
+        }
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static bool isPassThroughState(
+            const std::string& fullName, const StateBuilderContext<BbT>& state)
+        {
+            const auto& destination = state.destination;
+            return state.conditions.empty() && !state.asyncAction
+                   && !state.waitCondition
+                   && state.action.template target<DoNothing>() != nullptr
+                   && destination.secondary.empty()
+                   && !destination.primary.empty()
+                   && destination.primary != fullName
+                   && Analyzer::getMachineName(destination.primary)
+                          == Analyzer::getMachineName(fullName);
+        }
+
+        /**
+         * Follow successors of pass-through states until a regular state
+         * is found. Returns nullopt if the chain forms a cycle.
+         */
+        [[nodiscard]] static std::optional<std::string>
+        resolvePassThroughChain(
+            const std::string& fullName,
+            const std::map<std::string, std::string>& successors)
+        {
+            auto&& visited = std::set<std::string> { fullName };
+            auto current = successors.at(fullName);
+
+            while (successors.contains(current))
+            {
+                if (!visited.insert(current).second) return std::nullopt;
+                current = successors.at(current);
+            }
+
+            return current;
+        }
+
+        /**
+         * Returns pairs of (duplicate, original) full state names.
+         */
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::map<std::string, std::string>
+        findDuplicateStates(
+            const std::string& machineName,
+            const MachineBuilderContext<BbT>& machineContext,
+            const std::set<std::string>& interruptTargets)
+        {
+            auto&& originals = std::map<std::string, std::string> {};
+            auto&& duplicates = std::map<std::string, std::string> {};
+
+            // Entry state must be kept, so it is always treated
+            // as the original
+            auto&& orderedStateNames =
+                std::vector<std::string> { machineContext.entryState };
+            for (auto&& [stateName, _] : machineContext.states)
+            {
+                if (stateName != machineContext.entryState)
+                    orderedStateNames.push_back(stateName);
+            }
+
+            for (auto&& stateName : orderedStateNames)
+            {
+                const auto fullName =
+                    createFullStateName(machineName, stateName);
+
+                // Interrupts are not evaluated in their target state,
+                // so the target differs from otherwise identical states
+                if (interruptTargets.contains(fullName)) continue;
+                auto&& signature = getStateSignature(
+                    fullName, machineContext.states.at(stateName));
+                if (!signature) continue;
+
+                if (originals.contains(*signature))
+                    duplicates[fullName] = originals.at(*signature);
+                else
+                    originals[*signature] = fullName;
+            }
+
+            return duplicates;
+        }
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::optional<std::string> getStateSignature(
+            const std::string& fullName, const StateBuilderContext<BbT>& state)
+        {
+            // Coroutines cannot be compared
+            if (state.asyncAction) return std::nullopt;
+
+            auto&& signature = std::string(
+                state.conditionsAreExclusive ? "exclusive;" : "");
+
+            if (state.waitCondition)
+            {
+                auto&& key = getCallableKey(state.waitCondition);
+                if (!key) return std::nullopt;
+
+                signature += std::format(
+                    "wait {} {:#x};", *key, state.waitDependencies);
+            }
+
+            for (auto&& condition : state.conditions)
+            {
+                auto&& key = getCallableKey(condition.condition);
+                if (!key) return std::nullopt;
+
+                signature += std::format(
+                    "when {} {:#x} {};",
+                    *key,
+                    condition.dependencies,
+                    getDestinationKey(fullName, condition.destination));
+            }
+
+            auto&& actionKey = getCallableKey(state.action);
+            if (!actionKey) return std::nullopt;
+
+            signature += std::format(
+                "exec {} {}",
+                *actionKey,
+                getDestinationKey(fullName, state.destination));
+
+            return signature;
+        }
+
+        template<class R, class... Args>
+        [[nodiscard]] static std::optional<std::string>
+        getCallableKey(const TickCallable<R(Args...)>& callable)
+        {
+            if (!callable) return "none";
+
+            if constexpr (std::is_void_v<R>)
+            {
+                if (callable.template target<DoNothing>()) return "nothing";
+            }
+
+            if (auto ptr = callable.template target<
+                           NamedCallable<TickCallable<R(Args...)>>>())
+                return std::format("named:{}", ptr->name);
+
+            if (auto ptr = callable.template target<R (*)(Args...)>())
+                return std::format(
+                    "{:#x}", reinterpret_cast<std::uintptr_t>(*ptr));
+
+            if (auto ptr =
+                    callable.template target<R (*)(Args...) noexcept>())
+                return std::format(
+                    "{:#x}", reinterpret_cast<std::uintptr_t>(*ptr));
+
+            return std::nullopt;
+        }
+
+        [[nodiscard]] static std::string getDestinationKey(
+            const std::string& fullName, const TransitionContext& destination)
+        {
+            auto&& normalize = [&](const std::string& name)
+            { return name == fullName ? std::string("<self>") : name; };
+
+            return std::format(
+                "{}|{}",
+                normalize(destination.primary),
+                normalize(destination.secondary));
+        }
+
+        template<BlackboardTypeConcept BbT>
+        static void redirectTransitions(
+            BuilderContext<BbT>& context,
+            const std::string& from,
+            const std::string& to)
+        {
+            auto&& redirect = [&](TransitionContext& destination)
+            {
+                if (destination.primary == from) destination.primary = to;
+                if (destination.secondary == from) destination.secondary = to;
+            };
+
+            for (auto&& [_, machineContext] : context.machines)
+            {
+                for (auto&& [__, stateContext] : machineContext.states)
+                {
+                    for (auto&& condition : stateContext.conditions)
+                        redirect(condition.destination);
+                    redirect(stateContext.destination);
+                }
+
+                for (auto&& interrupt : machineContext.interrupts)
+                    redirect(interrupt.destination);
+            }
+
+            redirect(context.errorDestination);
+            for (auto&& interrupt : context.globalInterrupts)
+                redirect(interrupt.destination);
+
+            const auto [machineName, stateName] =
+                getMachineAndStateNameFromFullName(from);
+            auto& machine = context.machines.at(machineName);
+            if (machine.entryState == stateName)
+                machine.entryState =
+                    getMachineAndStateNameFromFullName(to).second;
+        }
+
+        template<BlackboardTypeConcept BbT>
+        static void
+        removeState(BuilderContext<BbT>& context, const std::string& fullName)
+        {
+            const auto [machineName, stateName] =
+                getMachineAndStateNameFromFullName(fullName);
+            context.machines.at(machineName).states.erase(stateName);
+        }
+
+        template<BlackboardTypeConcept BbT>
+        [[nodiscard]] static std::set<std::string>
+        findReachableStates(const BuilderContext<BbT>& context)
+        {
+            auto&& edges = std::map<std::string, std::set<std::string>> {};
+            Analyzer::forEachTransition(
+                context,
+                [&](const std::string& source,
+                    const TransitionContext& destination,
+                    bool)
+                {
+                    auto& targets = edges[source];
+                    if (!destination.primary.empty())
+                        targets.insert(destination.primary);
+                    if (!destination.secondary.empty())
+                        targets.insert(destination.secondary);
+                });
+            Analyzer::forEachEnclosingInterrupt(
+                context,
+                [&](const std::string& source,
+                    const std::string&,
+                    const TransitionContext& destination)
+                {
+                    if (!destination.primary.empty())
+                        edges[source].insert(destination.primary);
+                });
+
+            auto&& reachable = std::set<std::string> {};
+            auto&& queue = std::queue<std::string> {};
+            auto&& enqueue = [&](const std::string& name)
+            {
+                if (reachable.insert(name).second) queue.push(name);
+            };
+
+            enqueue(createFullStateName(
+                MAIN_MACHINE_NAME,
+                context.machines.at(MAIN_MACHINE_NAME).entryState));
+
+            if (context.machines.contains(ERROR_MACHINE_NAME))
+                enqueue(context.errorDestination.primary);
+
+            for (auto&& interrupt : context.globalInterrupts)
+                enqueue(interrupt.destination.primary);
+
+            while (!queue.empty())
+            {
+                const auto current = queue.front();
+                queue.pop();
+
+                if (!edges.contains(current)) continue;
+                for (auto&& next : edges.at(current))
+                    enqueue(next);
+            }
+
+            return reachable;
+        }
+    };
+} // namespace fsm::detail
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace fsm::detail
+{
+    /**
+     * Stack of state indices packed into a single 64-bit word, used
+     * by fsm::PackedBlackboardBase in place of std::vector.
+     *
+     * Each level takes IndexBits bits, the bottom of the stack is stored
+     * in the lowest bits. Only the subset of the std::vector interface
+     * that Fsm needs is provided. Pushing more than CAPACITY indices
+     * or an index above MAX_INDEX is a precondition violation,
+     * fsm::FinalBuilder::build makes sure the machine never does it.
+     */
+    template<std::unsigned_integral IndexT, size_t IndexBits>
+    class [[nodiscard]] PackedStateStack final
+    {
+        static_assert(
+            IndexBits > 0u && IndexBits <= 32u
+                && IndexBits <= sizeof(IndexT) * 8u,
+            "Index width must fit into the index type and leave room "
+            "for at least two levels");
+
+    public:
+        static constexpr size_t INDEX_BITS = IndexBits;
+        static constexpr size_t CAPACITY = 64u / INDEX_BITS;
+        static constexpr std::uint64_t MAX_INDEX =
+            (std::uint64_t { 1 } << INDEX_BITS) - 1u;
+
+        /**
+         * Writable element of the stack, \see operator[]
+         */
+        class [[nodiscard]] Reference final
+        {
+        public:
+            constexpr Reference(
+                PackedStateStack& stack, size_t level) noexcept
+                : stack(stack), level(level)
+            {
+            }
+
+        public:
+            constexpr operator IndexT() const noexcept
+            {
+                return stack.get(level);
+            }
+
+            constexpr Reference& operator=(IndexT value) noexcept
+            {
+                stack.set(level, value);
+                return *this;
+            }
+
+        private:
+            PackedStateStack& stack;
+            size_t level;
+        };
+
+    public:
+        constexpr PackedStateStack() noexcept = default;
+
+        constexpr PackedStateStack(
+            std::initializer_list<IndexT> items) noexcept
+        {
+            for (auto&& item : items)
+                push_back(item);
+        }
+
+    public:
+        [[nodiscard]] constexpr bool empty() const noexcept
+        {
+            return depth == 0;
+        }
+
+        [[nodiscard]] constexpr size_t size() const noexcept
+        {
+            return depth;
+        }
+
+        [[nodiscard]] constexpr IndexT back() const noexcept
+        {
+            assert(depth > 0);
+            return get(depth - 1u);
+        }
+
+        [[nodiscard]] constexpr IndexT operator[](size_t level) const noexcept
+        {
+            return get(level);
+        }
+
+        [[nodiscard]] constexpr Reference operator[](size_t level) noexcept
+        {
+            return Reference(*this, level);
+        }
+
+        constexpr void push_back(IndexT value) noexcept
+        {
+            assert(depth < CAPACITY);
+            assert(value <= MAX_INDEX);
+            bits |= static_cast<std::uint64_t>(value) << (depth * INDEX_BITS);
+            ++depth;
+        }
+
+        constexpr void pop_back() noexcept
+        {
+            assert(depth > 0);
+            resize(depth - 1u);
+        }
+
+        constexpr void clear() noexcept
+        {
+            bits = 0;
+            depth = 0;
+        }
+
+        /**
+         * Drop the levels above count, the stack cannot grow this way
+         */
+        constexpr void resize(size_t count) noexcept
+        {
+            assert(count <= depth);
+            bits &= getLevelsMask(count);
+            depth = static_cast<std::uint8_t>(count);
+        }
+
+        constexpr void assign(size_t count, IndexT value) noexcept
+        {
+            clear();
+            for (size_t idx = 0; idx < count; ++idx)
+                push_back(value);
+        }
+
+        [[nodiscard]] constexpr bool
+        operator==(const PackedStateStack&) const noexcept = default;
+
+    private:
+        [[nodiscard]] constexpr IndexT get(size_t level) const noexcept
+        {
+            assert(level < depth);
+            return static_cast<IndexT>(
+                (bits >> (level * INDEX_BITS)) & MAX_INDEX);
+        }
+
+        constexpr void set(size_t level, IndexT value) noexcept
+        {
+            assert(level < depth);
+            assert(value <= MAX_INDEX);
+            const auto shift = level * INDEX_BITS;
+            bits = (bits & ~(MAX_INDEX << shift))
+                   | (static_cast<std::uint64_t>(value) << shift);
+        }
+
+        [[nodiscard]] static constexpr std::uint64_t
+        getLevelsMask(size_t levels) noexcept
+        {
+            return levels == 0
+                       ? 0u
+                       : ~std::uint64_t {} >> (64u - levels * INDEX_BITS);
+        }
+
+    private:
+        std::uint64_t bits = 0;
+        std::uint8_t depth = 0;
+    };
+} // namespace fsm::detail
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace fsm::detail
+{
+    /**
+     * Shared pointer that can be replaced while other threads read it.
+     *
+     * Reading is a single acquire load, readers neither announce nor pin
+     * anything. Instead, replaced values are retired rather than released
+     * and stay alive until the pointer itself is destroyed, so a reader
+     * that loaded the old value can keep using it and a writer never waits
+     * for readers. This suits values that are replaced rarely, each
+     * replacement keeps one more value alive.
+     */
+    template<class T>
+    class [[nodiscard]] RetiringPointer final
+    {
+    public:
+        explicit RetiringPointer(std::shared_ptr<T> value) noexcept
+            : owner(std::move(value)), current(owner.get())
+        {
+        }
+
+        RetiringPointer(RetiringPointer&&) = delete;
+
+        RetiringPointer(const RetiringPointer&) = delete;
+
+    public:
+        /**
+         * \return Current value, valid until the pointer is destroyed
+         */
+        [[nodiscard]] const T* read() const noexcept
+        {
+            return current.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Replace the value. Writers must not run concurrently.
+         *
+         * \return The old value, which is also kept alive by the pointer
+         */
+        std::shared_ptr<T> exchange(std::shared_ptr<T> value)
+        {
+            auto&& old = std::exchange(owner, std::move(value));
+            current.store(owner.get(), std::memory_order_release);
+            if (old) retired.push_back(old);
+            return std::move(old);
+        }
+
+        /**
+         * Access the value from the writer, \see exchange
+         */
+        [[nodiscard]] const std::shared_ptr<T>& getForWriter() const noexcept
+        {
+            return owner;
+        }
+
+    private:
+        // Only accessed by the writer
+        std::shared_ptr<T> owner;
+        std::vector<std::shared_ptr<T>> retired;
+        std::atomic<T*> current;
+    };
+} // namespace fsm::detail
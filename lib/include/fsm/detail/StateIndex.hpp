@@ -17,7 +17,7 @@ namespace fsm::detail
     public:
         void addNameToIndex(const std::string& name);
 
-        unsigned getStateIndex(const std::string& name) const;
+        StateIdx getStateIndex(const std::string& name) const;
 
         [[nodiscard]] inline size_t getSize() const noexcept
         {
@@ -27,8 +27,8 @@ namespace fsm::detail
         std::vector<std::string> getIndexedStateNames() const;
 
     private:
-        unsigned cnt = 0;
-        std::unordered_map<std::string, unsigned> nameToId;
+        StateIdx cnt = 0;
+        std::unordered_map<std::string, StateIdx> nameToId;
     };
 
 } // namespace fsm::detail
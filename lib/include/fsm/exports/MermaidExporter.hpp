@@ -36,6 +36,7 @@ namespace fsm
         {
             printHeader(context);
             printErrorTransition(context);
+            printGlobalInterrupts(context);
             printAllIntraStateTransitions(context);
         }
 
@@ -78,6 +79,20 @@ namespace fsm
             }
         }
 
+        template<BlackboardTypeConcept BbT>
+        void printGlobalInterrupts(const detail::BuilderContext<BbT>& context)
+        {
+            const auto& interrupts = context.globalInterrupts;
+            for (size_t idx = 0; idx < interrupts.size(); ++idx)
+            {
+                std::println(
+                    save,
+                    "  __( ) -->|interrupt {}| {}",
+                    idx,
+                    interrupts[idx].destination.primary);
+            }
+        }
+
         template<BlackboardTypeConcept BbT>
         void printAllIntraStateTransitions(
             const fsm::detail::BuilderContext<BbT>& context)
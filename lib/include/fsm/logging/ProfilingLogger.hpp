@@ -0,0 +1,31 @@
+#pragma once
+
+#include <fsm/Profile.hpp>
+#include <fsm/logging/LoggerInterface.hpp>
+
+namespace fsm
+{
+    /**
+     * \brief Logger that collects a fsm::Profile
+     *
+     * Every logged tick increments the tick count of the current state
+     * and the count of the transition from the current state to the target
+     * state. Transitions into a finished machine are not recorded.
+     * Hits of state conditions are recorded under their declaration
+     * index.
+     */
+    class [[nodiscard]] ProfilingLogger final : public LoggerInterface
+    {
+    public:
+        [[nodiscard]] constexpr const Profile& getProfile() const noexcept
+        {
+            return profile;
+        }
+
+    protected:
+        void logImplementation(const Log& log) override;
+
+    private:
+        Profile profile;
+    };
+} // namespace fsm
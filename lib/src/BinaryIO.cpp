@@ -0,0 +1,108 @@
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/detail/BinaryIO.hpp>
+#include <limits>
+
+namespace
+{
+    template<class T>
+    void writeLittleEndian(std::string& data, T value)
+    {
+        for (size_t byte = 0; byte < sizeof(T); ++byte)
+            data.push_back(static_cast<char>((value >> (byte * 8u)) & 0xffu));
+    }
+
+    template<class T>
+    [[nodiscard]] T readLittleEndian(std::span<const char> bytes) noexcept
+    {
+        T result = 0;
+        for (size_t byte = 0; byte < sizeof(T); ++byte)
+            result |= static_cast<T>(static_cast<unsigned char>(bytes[byte]))
+                      << (byte * 8u);
+        return result;
+    }
+} // namespace
+
+namespace fsm::detail
+{
+    void BinaryWriter::writeU8(std::uint8_t value)
+    {
+        data.push_back(static_cast<char>(value));
+    }
+
+    void BinaryWriter::writeU32(std::uint32_t value)
+    {
+        writeLittleEndian(data, value);
+    }
+
+    void BinaryWriter::writeU64(std::uint64_t value)
+    {
+        writeLittleEndian(data, value);
+    }
+
+    void BinaryWriter::writeSize(size_t value)
+    {
+        if (value > std::numeric_limits<std::uint32_t>::max())
+            throw Error(
+                std::format("Value {} does not fit into 32 bits", value));
+        writeU32(static_cast<std::uint32_t>(value));
+    }
+
+    void BinaryWriter::writeString(std::string_view value)
+    {
+        writeSize(value.size());
+        data.append(value);
+    }
+
+    std::uint8_t BinaryReader::readU8()
+    {
+        return static_cast<std::uint8_t>(take(1u)[0]);
+    }
+
+    std::uint32_t BinaryReader::readU32()
+    {
+        return readLittleEndian<std::uint32_t>(take(sizeof(std::uint32_t)));
+    }
+
+    std::uint64_t BinaryReader::readU64()
+    {
+        return readLittleEndian<std::uint64_t>(take(sizeof(std::uint64_t)));
+    }
+
+    size_t BinaryReader::readSize()
+    {
+        return readU32();
+    }
+
+    size_t BinaryReader::readCount(size_t minItemSize)
+    {
+        const auto count = readSize();
+        const auto left = data.size() - position;
+        if (minItemSize != 0 && count > left / minItemSize)
+            throw Error(std::format(
+                "Count {} at offset {} exceeds the {} bytes left",
+                count,
+                position,
+                left));
+        return count;
+    }
+
+    std::string_view BinaryReader::readString()
+    {
+        auto&& bytes = take(readSize());
+        return { bytes.data(), bytes.size() };
+    }
+
+    std::span<const char> BinaryReader::take(size_t count)
+    {
+        if (data.size() - position < count)
+            throw Error(std::format(
+                "Unexpected end of data at offset {}, {} more bytes expected",
+                position,
+                count));
+
+        auto&& result = data.subspan(position, count);
+        position += count;
+        return result;
+    }
+} // namespace fsm::detail
@@ -0,0 +1,59 @@
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/detail/BuildCache.hpp>
+#include <fstream>
+#include <random>
+#include <system_error>
+
+namespace fsm::detail
+{
+    std::optional<MappedFile>
+    BuildCache::find(std::uint64_t fingerprint) const
+    {
+        const auto path = getEntryPath(fingerprint);
+        auto&& error = std::error_code();
+        if (!std::filesystem::is_regular_file(path, error))
+            return std::nullopt;
+
+        try
+        {
+            return MappedFile(path);
+        }
+        catch (const Error&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    void
+    BuildCache::store(std::uint64_t fingerprint, std::string_view data) const
+    {
+        auto&& error = std::error_code();
+        std::filesystem::create_directories(directory, error);
+        if (error) return;
+
+        const auto path = getEntryPath(fingerprint);
+        auto&& temporaryPath = std::filesystem::path(path);
+        temporaryPath += std::format(".{}.tmp", std::random_device {}());
+
+        {
+            auto&& out = std::ofstream(temporaryPath, std::ios::binary);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!out)
+            {
+                out.close();
+                std::filesystem::remove(temporaryPath, error);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) std::filesystem::remove(temporaryPath, error);
+    }
+
+    std::filesystem::path
+    BuildCache::getEntryPath(std::uint64_t fingerprint) const
+    {
+        return directory / std::format("{:016x}.fsmm", fingerprint);
+    }
+} // namespace fsm::detail
@@ -0,0 +1,54 @@
+#include <bit>
+#include <fsm/detail/ByteScanner.hpp>
+
+fsm::detail::ByteScanner::ByteScanner(std::span<const std::uint8_t> stopBytes)
+{
+    for (auto&& byte : stopBytes)
+    {
+        if (isStopByte[byte]) continue;
+
+        isStopByte[byte] = true;
+#ifdef FSM_BYTE_SCANNER_SSE2
+        if (stopByteCount < MAX_VECTORIZED_STOP_BYTES)
+            needles[stopByteCount] =
+                _mm_set1_epi8(static_cast<char>(byte));
+#endif
+        ++stopByteCount;
+    }
+}
+
+size_t fsm::detail::ByteScanner::findStop(
+    std::string_view input, size_t pos) const noexcept
+{
+#ifdef FSM_BYTE_SCANNER_SSE2
+    if (0 < stopByteCount && stopByteCount <= MAX_VECTORIZED_STOP_BYTES)
+    {
+        while (pos + sizeof(__m128i) <= input.size())
+        {
+            const auto chunk = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(input.data() + pos));
+
+            auto hits = _mm_cmpeq_epi8(chunk, needles[0]);
+            for (size_t i = 1; i < stopByteCount; ++i)
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[i]));
+
+            const auto mask =
+                static_cast<unsigned>(_mm_movemask_epi8(hits));
+            if (mask != 0) return pos + std::countr_zero(mask);
+
+            pos += sizeof(__m128i);
+        }
+    }
+#endif
+
+    return findStopScalar(input, pos);
+}
+
+size_t fsm::detail::ByteScanner::findStopScalar(
+    std::string_view input, size_t pos) const noexcept
+{
+    while (pos < input.size()
+           && !isStopByte[static_cast<std::uint8_t>(input[pos])])
+        ++pos;
+    return pos;
+}
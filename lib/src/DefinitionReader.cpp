@@ -0,0 +1,56 @@
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/detail/DefinitionReader.hpp>
+
+namespace
+{
+    [[nodiscard]] constexpr bool isSpace(char c) noexcept
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+} // namespace
+
+namespace fsm::detail
+{
+    bool DefinitionReader::nextLine()
+    {
+        while (position < text.size())
+        {
+            auto lineEnd = text.find('\n', position);
+            if (lineEnd == std::string_view::npos) lineEnd = text.size();
+
+            auto&& line = text.substr(position, lineEnd - position);
+            position = lineEnd + 1;
+            ++lineNumber;
+
+            if (const auto comment = line.find('#');
+                comment != std::string_view::npos)
+                line = line.substr(0, comment);
+
+            tokenCount = 0;
+            size_t idx = 0;
+            while (idx < line.size())
+            {
+                if (isSpace(line[idx]))
+                {
+                    ++idx;
+                    continue;
+                }
+
+                const auto start = idx;
+                while (idx < line.size() && !isSpace(line[idx]))
+                    ++idx;
+
+                if (tokenCount == tokens.size())
+                    throw Error(std::format(
+                        "Line {} of the definition has too many tokens",
+                        lineNumber));
+                tokens[tokenCount++] = line.substr(start, idx - start);
+            }
+
+            if (tokenCount > 0) return true;
+        }
+
+        return false;
+    }
+} // namespace fsm::detail
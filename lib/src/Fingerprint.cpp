@@ -0,0 +1,28 @@
+#include <fsm/detail/Fingerprint.hpp>
+
+namespace
+{
+    constexpr std::uint64_t FNV_PRIME = 0x100000001b3;
+}
+
+namespace fsm::detail
+{
+    void Fingerprint::addU64(std::uint64_t number) noexcept
+    {
+        for (size_t byte = 0; byte < sizeof(number); ++byte)
+        {
+            value ^= (number >> (byte * 8u)) & 0xffu;
+            value *= FNV_PRIME;
+        }
+    }
+
+    void Fingerprint::addString(std::string_view text) noexcept
+    {
+        addU64(text.size());
+        for (auto&& character : text)
+        {
+            value ^= static_cast<unsigned char>(character);
+            value *= FNV_PRIME;
+        }
+    }
+} // namespace fsm::detail
@@ -0,0 +1,75 @@
+#include <fsm/detail/FramePool.hpp>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct ThreadFrames
+    {
+        std::unordered_map<size_t, std::vector<void*>> freeFrames;
+
+        ~ThreadFrames();
+    };
+
+    // Frames released while the thread exits go straight to the heap
+    thread_local bool threadExiting = false;
+    thread_local ThreadFrames threadFrames;
+
+    ThreadFrames::~ThreadFrames()
+    {
+        threadExiting = true;
+        for (auto&& [_, frames] : freeFrames)
+        {
+            for (auto&& frame : frames)
+                ::operator delete(frame);
+        }
+    }
+} // namespace
+
+namespace fsm::detail
+{
+    void* FramePool::allocate(size_t size)
+    {
+        if (!threadExiting)
+        {
+            auto&& itr = threadFrames.freeFrames.find(size);
+            if (itr != threadFrames.freeFrames.end() && !itr->second.empty())
+            {
+                auto* frame = itr->second.back();
+                itr->second.pop_back();
+                return frame;
+            }
+        }
+
+        return ::operator new(size);
+    }
+
+    void FramePool::deallocate(void* frame, size_t size) noexcept
+    {
+        if (threadExiting)
+        {
+            ::operator delete(frame);
+            return;
+        }
+
+        try
+        {
+            threadFrames.freeFrames[size].push_back(frame);
+        }
+        catch (...)
+        {
+            ::operator delete(frame);
+        }
+    }
+
+    size_t FramePool::getFreeFrameCount() noexcept
+    {
+        if (threadExiting) return 0;
+
+        size_t result = 0;
+        for (auto&& [_, frames] : threadFrames.freeFrames)
+            result += frames.size();
+        return result;
+    }
+} // namespace fsm::detail
@@ -17,10 +17,3 @@ fsm::detail::getMachineAndStateNameFromFullName(const std::string& fullName)
     return { fullName.substr(0, separatorIdx),
              fullName.substr(separatorIdx + 1) };
 }
-
-size_t fsm::detail::popTopState(BlackboardBase& bb)
-{
-    auto idx = bb.__stateIdxs.back();
-    bb.__stateIdxs.pop_back();
-    return idx;
-}
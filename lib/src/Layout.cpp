@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <fsm/detail/Layout.hpp>
+#include <map>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Successors =
+        std::map<std::string, std::vector<std::pair<size_t, std::string>>>;
+
+    Successors createSuccessorLists(const fsm::Profile& profile)
+    {
+        auto&& result = Successors {};
+
+        for (auto&& [key, count] : profile.getTransitionCounts())
+        {
+            if (key.first == key.second) continue;
+            result[key.first].emplace_back(count, key.second);
+        }
+
+        // Hottest successor first, ties are broken by name for determinism
+        for (auto&& [_, successors] : result)
+            std::ranges::sort(
+                successors,
+                [](const auto& a, const auto& b)
+                {
+                    return a.first != b.first ? a.first > b.first
+                                              : a.second < b.second;
+                });
+
+        return result;
+    }
+
+    /**
+     * Greedily build chains of states. Each chain starts with the hottest
+     * state not yet placed and continues with its most frequent successor
+     * from the same block as long as there is one that was not placed yet.
+     */
+    void layoutBlock(
+        std::span<const std::string> block,
+        const fsm::Profile& profile,
+        const Successors& successors,
+        fsm::detail::StateIndex& result)
+    {
+        auto&& remaining = std::set<std::string>(block.begin(), block.end());
+        auto&& seeds = std::vector<std::string>(block.begin(), block.end());
+        std::ranges::stable_sort(
+            seeds,
+            [&](const std::string& a, const std::string& b)
+            { return profile.getTickCount(a) > profile.getTickCount(b); });
+
+        auto&& place = [&](const std::string& name)
+        {
+            remaining.erase(name);
+            result.addNameToIndex(name);
+        };
+
+        for (auto&& seed : seeds)
+        {
+            if (!remaining.contains(seed)) continue;
+
+            place(seed);
+            auto current = seed;
+
+            while (successors.contains(current))
+            {
+                auto&& next = std::ranges::find_if(
+                    successors.at(current),
+                    [&](const auto& pair)
+                    { return remaining.contains(pair.second); });
+                if (next == successors.at(current).end()) break;
+
+                current = next->second;
+                place(current);
+            }
+        }
+    }
+} // namespace
+
+fsm::detail::StateIndex fsm::detail::reorderStateIndexByProfile(
+    const StateIndex& index, size_t errorStatesCount, const Profile& profile)
+{
+    const auto&& names = index.getIndexedStateNames();
+    const auto&& successors = createSuccessorLists(profile);
+    const auto errorStateEndIdx = errorStatesCount + 1;
+    auto&& result = StateIndex();
+
+    result.addNameToIndex(names.front());
+    layoutBlock(
+        std::span(names).subspan(1, errorStatesCount),
+        profile,
+        successors,
+        result);
+    layoutBlock(
+        std::span(names).subspan(errorStateEndIdx),
+        profile,
+        successors,
+        result);
+
+    return result;
+}
@@ -0,0 +1,107 @@
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/MappedFile.hpp>
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+fsm::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    auto&& load = std::ifstream(path, std::ios::binary);
+    if (!load)
+        throw Error(std::format("Cannot open {} for reading", path.string()));
+
+    fallbackBuffer.assign(
+        std::istreambuf_iterator<char>(load), std::istreambuf_iterator<char>());
+    data = fallbackBuffer.data();
+    size = fallbackBuffer.size();
+}
+
+void fsm::MappedFile::unmap() noexcept
+{
+    fallbackBuffer.clear();
+}
+
+#else
+
+fsm::MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw Error(std::format(
+            "Cannot open {} for reading: {}",
+            path.string(),
+            std::strerror(errno)));
+
+    struct stat info = {};
+    if (::fstat(fd, &info) != 0)
+    {
+        const auto error = errno;
+        ::close(fd);
+        throw Error(std::format(
+            "Cannot read size of {}: {}", path.string(), std::strerror(error)));
+    }
+
+    size = static_cast<size_t>(info.st_size);
+
+    // Mapping of zero bytes is not allowed
+    if (size == 0)
+    {
+        ::close(fd);
+        return;
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const auto error = errno;
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+        throw Error(std::format(
+            "Cannot map {} into memory: {}",
+            path.string(),
+            std::strerror(error)));
+
+    // Only a hint, failure is not an error
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapping);
+}
+
+void fsm::MappedFile::unmap() noexcept
+{
+    if (data) ::munmap(const_cast<char*>(data), size);
+}
+
+#endif
+
+fsm::MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+fsm::MappedFile& fsm::MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == &other) return *this;
+
+    unmap();
+    fallbackBuffer = std::move(other.fallbackBuffer);
+    data = std::exchange(other.data, nullptr);
+    size = std::exchange(other.size, 0u);
+    return *this;
+}
+
+fsm::MappedFile::~MappedFile()
+{
+    unmap();
+}
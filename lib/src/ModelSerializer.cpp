@@ -0,0 +1,35 @@
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/detail/ModelSerializer.hpp>
+
+namespace fsm::detail
+{
+    void ModelSerializer::writeTransition(
+        BinaryWriter& writer, const CompiledTransition& transition)
+    {
+        writer.writeU8(static_cast<std::uint8_t>(transition.getSize()));
+        for (auto&& stateIdx : transition)
+            writer.writeSize(stateIdx);
+    }
+
+    CompiledTransition
+    ModelSerializer::readTransition(BinaryReader& reader, size_t stateCount)
+    {
+        const auto size = reader.readU8();
+        if (size > 2u)
+            throw Error(std::format("Invalid transition size {}", size));
+
+        StateIdx stateIdxs[2] = { 0u, 0u };
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            const auto stateIdx = reader.readSize();
+            if (stateIdx >= stateCount)
+                throw Error(std::format("Invalid state index {}", stateIdx));
+            stateIdxs[idx] = static_cast<StateIdx>(stateIdx);
+        }
+
+        if (size == 0u) return CompiledTransition {};
+        if (size == 1u) return CompiledTransition { stateIdxs[0] };
+        return CompiledTransition { stateIdxs[0], stateIdxs[1] };
+    }
+} // namespace fsm::detail
@@ -0,0 +1,176 @@
+#include <charconv>
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/Profile.hpp>
+#include <fstream>
+#include <print>
+#include <vector>
+
+namespace
+{
+    constexpr const char* TICK_RECORD = "tick";
+    constexpr const char* TRANSITION_RECORD = "transition";
+    constexpr const char* CONDITION_RECORD = "condition";
+
+    std::vector<std::string> splitByTabs(const std::string& line)
+    {
+        auto&& result = std::vector<std::string> {};
+        size_t start = 0;
+
+        while (true)
+        {
+            const auto end = line.find('\t', start);
+            result.push_back(line.substr(start, end - start));
+            if (end == std::string::npos) break;
+            start = end + 1;
+        }
+
+        return result;
+    }
+
+    size_t parseCount(const std::string& str, size_t lineNumber)
+    {
+        size_t result = 0;
+        const auto [ptr, ec] =
+            std::from_chars(str.data(), str.data() + str.size(), result);
+
+        if (ec != std::errc() || ptr != str.data() + str.size())
+            throw fsm::Error(std::format(
+                "Invalid count '{}' on line {} of the profile",
+                str,
+                lineNumber));
+
+        return result;
+    }
+} // namespace
+
+void fsm::Profile::recordTick(const std::string& stateName)
+{
+    ++tickCounts[stateName];
+}
+
+void fsm::Profile::recordTransition(
+    const std::string& sourceStateName, const std::string& targetStateName)
+{
+    ++transitionCounts[{ sourceStateName, targetStateName }];
+}
+
+void fsm::Profile::recordConditionHit(
+    const std::string& stateName, size_t conditionDeclarationIdx)
+{
+    ++conditionHitCounts[{ stateName, conditionDeclarationIdx }];
+}
+
+size_t fsm::Profile::getTickCount(const std::string& stateName) const noexcept
+{
+    auto itr = tickCounts.find(stateName);
+    return itr == tickCounts.end() ? 0u : itr->second;
+}
+
+size_t fsm::Profile::getTransitionCount(
+    const std::string& sourceStateName,
+    const std::string& targetStateName) const noexcept
+{
+    auto itr = transitionCounts.find({ sourceStateName, targetStateName });
+    return itr == transitionCounts.end() ? 0u : itr->second;
+}
+
+size_t fsm::Profile::getConditionHitCount(
+    const std::string& stateName, size_t conditionDeclarationIdx) const noexcept
+{
+    auto itr = conditionHitCounts.find({ stateName, conditionDeclarationIdx });
+    return itr == conditionHitCounts.end() ? 0u : itr->second;
+}
+
+void fsm::Profile::merge(const Profile& other)
+{
+    for (auto&& [stateName, count] : other.tickCounts)
+        tickCounts[stateName] += count;
+
+    for (auto&& [key, count] : other.transitionCounts)
+        transitionCounts[key] += count;
+
+    for (auto&& [key, count] : other.conditionHitCounts)
+        conditionHitCounts[key] += count;
+}
+
+void fsm::Profile::save(std::ostream& stream) const
+{
+    for (auto&& [stateName, count] : tickCounts)
+        std::println(stream, "{}\t{}\t{}", TICK_RECORD, stateName, count);
+
+    for (auto&& [key, count] : transitionCounts)
+        std::println(
+            stream,
+            "{}\t{}\t{}\t{}",
+            TRANSITION_RECORD,
+            key.first,
+            key.second,
+            count);
+
+    for (auto&& [key, count] : conditionHitCounts)
+        std::println(
+            stream,
+            "{}\t{}\t{}\t{}",
+            CONDITION_RECORD,
+            key.first,
+            key.second,
+            count);
+}
+
+void fsm::Profile::saveToFile(const std::filesystem::path& path) const
+{
+    auto&& stream = std::ofstream(path);
+    if (!stream)
+        throw Error(
+            std::format("Cannot open {} for writing", path.string()));
+
+    save(stream);
+}
+
+fsm::Profile fsm::Profile::load(std::istream& stream)
+{
+    auto&& profile = Profile {};
+    auto&& line = std::string {};
+    size_t lineNumber = 0;
+
+    while (std::getline(stream, line))
+    {
+        ++lineNumber;
+        if (line.empty()) continue;
+
+        const auto&& fields = splitByTabs(line);
+        if (fields[0] == TICK_RECORD && fields.size() == 3u)
+        {
+            profile.tickCounts[fields[1]] += parseCount(fields[2], lineNumber);
+        }
+        else if (fields[0] == TRANSITION_RECORD && fields.size() == 4u)
+        {
+            profile.transitionCounts[{ fields[1], fields[2] }] +=
+                parseCount(fields[3], lineNumber);
+        }
+        else if (fields[0] == CONDITION_RECORD && fields.size() == 4u)
+        {
+            profile.conditionHitCounts[{
+                fields[1], parseCount(fields[2], lineNumber) }] +=
+                parseCount(fields[3], lineNumber);
+        }
+        else
+        {
+            throw Error(std::format(
+                "Malformed record on line {} of the profile", lineNumber));
+        }
+    }
+
+    return profile;
+}
+
+fsm::Profile fsm::Profile::loadFromFile(const std::filesystem::path& path)
+{
+    auto&& stream = std::ifstream(path);
+    if (!stream)
+        throw Error(
+            std::format("Cannot open {} for reading", path.string()));
+
+    return load(stream);
+}
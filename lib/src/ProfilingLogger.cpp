@@ -0,0 +1,26 @@
+#include <charconv>
+#include <fsm/logging/ProfilingLogger.hpp>
+#include <string_view>
+
+namespace
+{
+    constexpr std::string_view CONDITION_HIT_PREFIX = "Condition ";
+}
+
+void fsm::ProfilingLogger::logImplementation(const Log& log)
+{
+    profile.recordTick(log.currentStateName);
+
+    if (log.targetStateName != "Finishing")
+        profile.recordTransition(log.currentStateName, log.targetStateName);
+
+    if (log.message.starts_with(CONDITION_HIT_PREFIX))
+    {
+        const auto* begin = log.message.data() + CONDITION_HIT_PREFIX.size();
+        const auto* end = log.message.data() + log.message.size();
+        size_t conditionIdx = 0;
+
+        if (std::from_chars(begin, end, conditionIdx).ec == std::errc())
+            profile.recordConditionHit(log.currentStateName, conditionIdx);
+    }
+}
@@ -12,10 +12,20 @@ void fsm::detail::StateIndex::addNameToIndex(const std::string& name)
             name));
     }
 
+    if (cnt == NO_STATE_IDX)
+    {
+        throw Error(std::format(
+            "Cannot index state {}, machine can have at most {} states, "
+            "see FSM_STATE_INDEX_BITS",
+            name,
+            size_t { NO_STATE_IDX }));
+    }
+
     nameToId[name] = cnt++;
 }
 
-unsigned fsm::detail::StateIndex::getStateIndex(const std::string& name) const
+fsm::StateIdx
+fsm::detail::StateIndex::getStateIndex(const std::string& name) const
 
 {
     if (!nameToId.contains(name))
@@ -32,21 +42,21 @@ std::vector<std::string> fsm::detail::StateIndex::getIndexedStateNames() const
     auto&& indexedStateNames =
         std::views::transform(
             nameToId,
-            [](const std::pair<std::string, unsigned>& kv)
-                -> std::pair<unsigned, std::string> {
+            [](const std::pair<std::string, StateIdx>& kv)
+                -> std::pair<StateIdx, std::string> {
                 return { kv.second, kv.first };
             })
         | std::ranges::to<std::vector>();
 
     std::ranges::sort(
         indexedStateNames,
-        [](const std::pair<unsigned, std::string>& a,
-           const std::pair<unsigned, std::string>& b) -> bool
+        [](const std::pair<StateIdx, std::string>& a,
+           const std::pair<StateIdx, std::string>& b) -> bool
         { return a.first < b.first; });
 
     return indexedStateNames
            | std::views::transform(
-               [](const std::pair<unsigned, std::string>& kv) -> std::string
+               [](const std::pair<StateIdx, std::string>& kv) -> std::string
                { return kv.second; })
            | std::ranges::to<std::vector>();
 }
@@ -0,0 +1,39 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fsm/Error.hpp>
+#include <fsm/StreamDriver.hpp>
+#include <limits>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+size_t fsm::detail::readFromFileDescriptor(
+    int fileDescriptor, std::span<char> buffer)
+{
+    while (true)
+    {
+#ifdef _WIN32
+        const auto bytesRead = ::_read(
+            fileDescriptor,
+            buffer.data(),
+            static_cast<unsigned>(std::min<size_t>(
+                buffer.size(), std::numeric_limits<int>::max())));
+#else
+        const auto bytesRead =
+            ::read(fileDescriptor, buffer.data(), buffer.size());
+#endif
+
+        if (bytesRead >= 0) return static_cast<size_t>(bytesRead);
+        if (errno == EINTR) continue;
+
+        throw Error(std::format(
+            "Reading from file descriptor {} failed: {}",
+            fileDescriptor,
+            std::strerror(errno)));
+    }
+}
@@ -0,0 +1,144 @@
+#include "Blackboard.hpp"
+#include "CsvParser.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/detail/Analyzer.hpp>
+
+TEST_CASE("[Analyzer]")
+{
+    using namespace fsm::detail;
+
+    auto&& condition = [](const std::string& primary,
+                          const std::string& secondary = "")
+    {
+        return ConditionalTransitionContext<Blackboard> {
+            .condition = alwaysTrue,
+            .destination = { .primary = primary, .secondary = secondary },
+        };
+    };
+
+    SECTION("findConditionOnlyCycle")
+    {
+        SECTION("Ignores cycles closed by a behavior")
+        {
+            auto&& context = BuilderContext<Blackboard> {
+                .machines = { { "__main__",
+                                MachineBuilderContext<Blackboard> {
+                                    .entryState = "A",
+                                    .states = {
+                                        { "A",
+                                          { .conditions = { condition(
+                                                "__main__:B") } } },
+                                        { "B",
+                                          { .destination = {
+                                                .primary = "__main__:A" } } },
+                                    } } } }
+            };
+
+            REQUIRE(Analyzer::findConditionOnlyCycle(context).empty());
+        }
+
+        SECTION("Finds a cycle through a return from submachine")
+        {
+            auto&& context = BuilderContext<Blackboard> {
+                .machines = {
+                    { "__main__",
+                      MachineBuilderContext<Blackboard> {
+                          .entryState = "A",
+                          .states = {
+                              { "A",
+                                { .conditions = { condition(
+                                      "Sub:S", "__main__:B") } } },
+                              { "B",
+                                { .conditions = { condition(
+                                      "__main__:A") } } },
+                          } } },
+                    { "Sub",
+                      MachineBuilderContext<Blackboard> {
+                          .entryState = "S",
+                          .states = {
+                              { "S", { .conditions = { condition("") } } },
+                          } } },
+                }
+            };
+
+            auto&& cycle = Analyzer::findConditionOnlyCycle(context);
+
+            REQUIRE(cycle.size() == 3u);
+            REQUIRE(cycle[0] == "Sub:S");
+            REQUIRE(cycle[1] == "__main__:B");
+            REQUIRE(cycle[2] == "__main__:A");
+        }
+
+        SECTION("Finds a cycle through an interrupt of an enclosing machine")
+        {
+            auto&& context = BuilderContext<Blackboard> {
+                .machines = {
+                    { "__main__",
+                      MachineBuilderContext<Blackboard> {
+                          .entryState = "A",
+                          .states = {
+                              { "A",
+                                { .destination = { .primary = "Sub:S",
+                                                   .secondary =
+                                                       "__main__:A" } } },
+                              { "C",
+                                { .conditions = { condition(
+                                      "Sub:S", "__main__:A") } } },
+                          },
+                          .interrupts = { condition("__main__:C") } } },
+                    { "Sub",
+                      MachineBuilderContext<Blackboard> {
+                          .entryState = "S",
+                          .states = { { "S", {} } } } },
+                }
+            };
+
+            REQUIRE(
+                Analyzer::getEnclosingMachines(context).at("Sub")
+                == std::set<std::string> { "__main__" });
+
+            auto&& cycle = Analyzer::findConditionOnlyCycle(context);
+
+            REQUIRE(cycle.size() == 2u);
+            REQUIRE(cycle[0] == "Sub:S");
+            REQUIRE(cycle[1] == "__main__:C");
+        }
+    }
+
+    SECTION("getReturnDestinations")
+    {
+        SECTION("Submachine finishing with its caller inherits its returns")
+        {
+            auto&& context = BuilderContext<Blackboard> {
+                .machines = {
+                    { "__main__",
+                      MachineBuilderContext<Blackboard> {
+                          .entryState = "A",
+                          .states = {
+                              { "A",
+                                { .destination = { .primary = "Outer:S",
+                                                   .secondary =
+                                                       "__main__:A" } } },
+                          } } },
+                    { "Outer",
+                      MachineBuilderContext<Blackboard> {
+                          .entryState = "S",
+                          .states = {
+                              { "S",
+                                { .destination = { .primary = "Inner:S" } } },
+                          } } },
+                    { "Inner",
+                      MachineBuilderContext<Blackboard> {
+                          .entryState = "S",
+                          .states = { { "S", {} } } } },
+                }
+            };
+
+            auto&& returns = Analyzer::getReturnDestinations(context);
+
+            REQUIRE(returns.at("Inner").contains("__main__:A"));
+            REQUIRE(returns.at("Outer").contains("__main__:A"));
+            REQUIRE(returns.at("__main__").empty());
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#include "catch_amalgamated.hpp"
+#include <fsm/Archetype.hpp>
+#include <fsm/Builder.hpp>
+#include <vector>
+
+struct MonsterBlackboard : fsm::BlackboardBase
+{
+    int playerDistance = 10;
+    int travelled = 0;
+};
+
+struct MonsterParams
+{
+    int aggroRange = 0;
+    int speed = 0;
+};
+
+struct Arena
+{
+    int hazardLevel = 0;
+};
+
+static bool isPlayerInRange(
+    const MonsterBlackboard& bb, const MonsterParams& params)
+{
+    return bb.playerDistance <= params.aggroRange;
+}
+
+static void chase(MonsterBlackboard& bb, const MonsterParams& params)
+{
+    bb.travelled += params.speed;
+}
+
+TEST_CASE("[Archetype]")
+{
+    // clang-format off
+    auto&& machine = fsm::Builder<MonsterBlackboard>()
+        .withNoErrorMachine()
+        .withMainMachine()
+            .withEntryState("Idle")
+                .when(fsm::withParams<MonsterParams>(isPlayerInRange))
+                    .goToState("Chase")
+                .otherwiseExec(fsm::doNothing).andLoop()
+            .withState("Chase")
+                .exec(fsm::withParams<MonsterParams>(chase)).andLoop()
+            .done()
+        .build();
+    // clang-format on
+
+    auto&& goblin =
+        fsm::Archetype(MonsterParams { .aggroRange = 5, .speed = 1 });
+    auto&& troll =
+        fsm::Archetype(MonsterParams { .aggroRange = 12, .speed = 3 });
+
+    SECTION("Conditions and actions read the params of the archetype")
+    {
+        auto&& goblins = std::vector<MonsterBlackboard>(2);
+        auto&& trolls = std::vector<MonsterBlackboard>(1);
+
+        machine.tickAll(goblins, goblin);
+        machine.tickAll(goblins, goblin);
+        machine.tickAll(trolls, troll);
+        machine.tickAll(trolls, troll);
+        REQUIRE(goblins[0].travelled == 0);
+        REQUIRE(trolls[0].travelled == 3);
+
+        goblins[0].playerDistance = 4;
+        machine.tickAll(goblins, goblin);
+        machine.tickAll(goblins, goblin);
+        machine.tickAll(trolls, troll);
+        machine.tickAll(trolls, troll);
+        REQUIRE(goblins[0].travelled == 1);
+        REQUIRE(goblins[1].travelled == 0);
+        REQUIRE(trolls[0].travelled == 9);
+    }
+
+    SECTION("Agent uses the params of the archetype of each tick")
+    {
+        MonsterBlackboard bb;
+        bb.playerDistance = 8;
+        machine.tick(bb, goblin);
+        REQUIRE(bb.__stateIdxs.back() == 0u);
+
+        machine.tick(bb, troll);
+        machine.tick(bb, troll);
+        REQUIRE(bb.travelled == 3);
+    }
+
+    SECTION("Archetype is passed together with other contexts")
+    {
+        MonsterBlackboard bb;
+        bb.playerDistance = 1;
+        machine.tick(bb, Arena { .hazardLevel = 2 }, goblin);
+        machine.tick(bb, goblin, Arena { .hazardLevel = 3 });
+        REQUIRE(bb.travelled == 1);
+    }
+
+    SECTION("Tick without the archetype throws")
+    {
+        MonsterBlackboard bb;
+        REQUIRE_THROWS_AS(machine.tick(bb), fsm::Error);
+
+        MonsterBlackboard other;
+        REQUIRE_THROWS_AS(
+            machine.tick(other, fsm::Archetype(42)), fsm::Error);
+    }
+
+    SECTION("Blackboard is left intact by a tick without the archetype")
+    {
+        MonsterBlackboard bb;
+        bb.playerDistance = 1;
+        machine.tick(bb, goblin);
+        const auto stateIdxs = bb.__stateIdxs;
+
+        REQUIRE_THROWS_AS(machine.tick(bb), fsm::Error);
+        REQUIRE(bb.__stateIdxs == stateIdxs);
+
+        machine.tick(bb, goblin);
+        REQUIRE(bb.travelled == 1);
+        REQUIRE(bb.__stateIdxs == stateIdxs);
+    }
+}
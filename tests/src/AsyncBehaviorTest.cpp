@@ -0,0 +1,345 @@
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+struct AsyncBlackboard
+    : fsm::BlackboardBase
+    , fsm::TrackedBlackboard
+{
+    bool alarm = false;
+    bool doorOpen = false;
+    size_t steps = 0;
+    size_t conditionChecks = 0;
+};
+
+static fsm::AsyncBehavior walkThreeSteps(AsyncBlackboard& bb)
+{
+    for (size_t i = 0; i < 3; ++i)
+    {
+        ++bb.steps;
+        co_await fsm::nextTick();
+    }
+}
+
+static fsm::AsyncBehavior waitForDoor(AsyncBlackboard& bb)
+{
+    ++bb.steps;
+    co_await fsm::until([&bb] { return bb.doorOpen; });
+    ++bb.steps;
+}
+
+static bool isAlarmRaised(const AsyncBlackboard& bb)
+{
+    return bb.alarm;
+}
+
+static bool isAlarmRaisedCounted(const AsyncBlackboard& bb)
+{
+    ++const_cast<AsyncBlackboard&>(bb).conditionChecks;
+    return bb.alarm;
+}
+
+static void idle(AsyncBlackboard&) {}
+
+TEST_CASE("[AsyncBehavior]")
+{
+    AsyncBlackboard bb;
+
+    SECTION("Default transition is taken after the coroutine returns")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Walk")
+                    .execAsync(walkThreeSteps).andGoToState("Rest")
+                .withState("Rest")
+                    .exec(idle).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        for (size_t tick = 1; tick <= 3; ++tick)
+        {
+            machine.tick(bb);
+            REQUIRE(bb.steps == tick);
+            REQUIRE(bb.__stateIdxs.back() == 0u);
+        }
+
+        machine.tick(bb);
+        REQUIRE(bb.steps == 3u);
+        REQUIRE(bb.__stateIdxs.back() != 0u);
+        REQUIRE_FALSE(bb.__asyncBehavior.behavior.isRunning());
+    }
+
+    SECTION("Suspended agent is not evaluated until the predicate holds")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Guard")
+                    .when(isAlarmRaisedCounted).finish()
+                    .otherwiseExecAsync(waitForDoor).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE(bb.steps == 1u);
+        REQUIRE(bb.conditionChecks == 1u);
+
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(bb.steps == 1u);
+        REQUIRE(bb.conditionChecks == 1u);
+
+        bb.doorOpen = true;
+        machine.tick(bb);
+        REQUIRE(bb.steps == 2u);
+        REQUIRE(bb.conditionChecks == 2u);
+
+        // Looping state restarts the behavior, which does not suspend
+        // as the door is already open
+        machine.tick(bb);
+        REQUIRE(bb.steps == 4u);
+    }
+
+    SECTION("Hit condition cancels the behavior")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Walk")
+                    .when(isAlarmRaised).goToState("Flee")
+                    .otherwiseExecAsync(walkThreeSteps).andLoop()
+                .withState("Flee")
+                    .exec(idle).andGoToState("Walk")
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE(bb.__asyncBehavior.behavior.isRunning());
+
+        bb.alarm = true;
+        machine.tick(bb);
+        REQUIRE_FALSE(bb.__asyncBehavior.behavior.isRunning());
+
+        bb.alarm = false;
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(bb.steps == 2u);
+        REQUIRE(bb.__stateIdxs.back() == 0u);
+    }
+
+    SECTION("Sleeping agent is resumed after the duration elapses")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Nap")
+                    .execAsync([](AsyncBlackboard& bb) -> fsm::AsyncBehavior
+                    {
+                        co_await fsm::sleepFor(std::chrono::hours(1));
+                        ++bb.steps;
+                    }).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(bb.steps == 0u);
+        REQUIRE(bb.__asyncBehavior.behavior.isWaiting(fsm::detail::TickClock()));
+    }
+
+    SECTION("Interrupt preempts a sleeping behavior")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .interruptWhen(isAlarmRaised).goToState("Flee")
+                .withEntryState("Nap")
+                    .execAsync([](AsyncBlackboard& bb) -> fsm::AsyncBehavior
+                    {
+                        co_await fsm::sleepFor(std::chrono::hours(1));
+                        ++bb.steps;
+                    }).andLoop()
+                .withState("Flee")
+                    .exec(idle).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(bb.__asyncBehavior.behavior.isWaiting(fsm::detail::TickClock()));
+        REQUIRE(bb.__stateIdxs.back() == 0u);
+
+        bb.alarm = true;
+        machine.tick(bb);
+        REQUIRE_FALSE(bb.__asyncBehavior.behavior.isRunning());
+        REQUIRE(bb.__stateIdxs.back() != 0u);
+        REQUIRE(bb.steps == 0u);
+    }
+
+    SECTION("Global error condition preempts a waiting behavior")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withErrorMachine()
+                .useGlobalEntryCondition(isAlarmRaised)
+                .withEntryState("Panic")
+                    .exec(idle).andLoop()
+                .done()
+            .withMainMachine()
+                .withEntryState("Guard")
+                    .execAsync(waitForDoor).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE(bb.__asyncBehavior.behavior.isWaiting(fsm::detail::TickClock()));
+
+        bb.alarm = true;
+        machine.tick(bb);
+        REQUIRE(machine.isErrored(bb));
+        REQUIRE_FALSE(bb.__asyncBehavior.behavior.isRunning());
+        REQUIRE(bb.steps == 1u);
+    }
+
+    SECTION("Predicate with dependencies is only polled after they are dirty")
+    {
+        constexpr fsm::FieldMask DOOR = 1u << 0;
+        size_t predicateChecks = 0;
+
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Guard")
+                    .execAsync([&](AsyncBlackboard& bb) -> fsm::AsyncBehavior
+                    {
+                        co_await fsm::until(
+                            [&]
+                            {
+                                ++predicateChecks;
+                                return bb.doorOpen;
+                            },
+                            DOOR);
+                        ++bb.steps;
+                    }).andGoToState("Inside")
+                .withState("Inside")
+                    .exec(idle).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE(predicateChecks == 1u);
+
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(predicateChecks == 1u);
+
+        fsm::markDirty(bb, DOOR);
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(predicateChecks == 2u);
+        REQUIRE(bb.steps == 0u);
+
+        bb.doorOpen = true;
+        fsm::markDirty(bb, DOOR);
+        machine.tick(bb);
+        REQUIRE(bb.steps == 1u);
+        REQUIRE(bb.__stateIdxs.back() != 0u);
+    }
+
+    SECTION("Moving blackboard cancels the behavior of the moved-to one")
+    {
+        static_assert(!std::is_copy_constructible_v<AsyncBlackboard>);
+
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Walk")
+                    .execAsync(walkThreeSteps).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE(bb.__asyncBehavior.behavior.isRunning());
+
+        auto&& moved = AsyncBlackboard(std::move(bb));
+        REQUIRE_FALSE(moved.__asyncBehavior.behavior.isRunning());
+        REQUIRE(moved.steps == 1u);
+
+        // Restarts the behavior instead of resuming the one bound to bb
+        machine.tick(moved);
+        REQUIRE(moved.steps == 2u);
+        REQUIRE(moved.__asyncBehavior.behavior.isRunning());
+    }
+
+    SECTION("Exception thrown by the coroutine is propagated")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<AsyncBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Fail")
+                    .execAsync([](AsyncBlackboard&) -> fsm::AsyncBehavior
+                    {
+                        co_await fsm::nextTick();
+                        throw std::runtime_error("failure");
+                    }).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE_THROWS_AS(machine.tick(bb), std::runtime_error);
+        REQUIRE_FALSE(bb.__asyncBehavior.behavior.isRunning());
+    }
+}
+
+TEST_CASE("[FramePool]")
+{
+    SECTION("Released frame is reused by the same thread")
+    {
+        const auto freeFrames = fsm::detail::FramePool::getFreeFrameCount();
+
+        void* first = fsm::detail::FramePool::allocate(64);
+        fsm::detail::FramePool::deallocate(first, 64);
+        REQUIRE(fsm::detail::FramePool::getFreeFrameCount() == freeFrames + 1u);
+
+        void* second = fsm::detail::FramePool::allocate(64);
+        REQUIRE(second == first);
+        REQUIRE(fsm::detail::FramePool::getFreeFrameCount() == freeFrames);
+        fsm::detail::FramePool::deallocate(second, 64);
+    }
+
+    SECTION("Frames are not shared between threads")
+    {
+        void* frame = fsm::detail::FramePool::allocate(64);
+        fsm::detail::FramePool::deallocate(frame, 64);
+
+        void* otherThreadFrame = nullptr;
+        std::thread(
+            [&]
+            {
+                otherThreadFrame = fsm::detail::FramePool::allocate(64);
+                fsm::detail::FramePool::deallocate(otherThreadFrame, 64);
+            })
+            .join();
+        REQUIRE(otherThreadFrame != frame);
+    }
+}
@@ -0,0 +1,122 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <filesystem>
+#include <fsm/Builder.hpp>
+#include <fsm/CallableRegistry.hpp>
+#include <fstream>
+
+struct BakerBlackboard : fsm::BlackboardBase
+{
+    size_t kneaded = 0;
+    size_t baked = 0;
+};
+
+static void knead(BakerBlackboard& bb)
+{
+    ++bb.kneaded;
+}
+
+static void bake(BakerBlackboard& bb)
+{
+    ++bb.baked;
+}
+
+static size_t countEntries(const std::filesystem::path& directory)
+{
+    return static_cast<size_t>(std::distance(
+        std::filesystem::directory_iterator(directory),
+        std::filesystem::directory_iterator()));
+}
+
+TEST_CASE("[BuildCache]")
+{
+    const auto directory =
+        std::filesystem::temp_directory_path() / "fsm-build-cache-test";
+    std::filesystem::remove_all(directory);
+
+    auto&& registry = fsm::CallableRegistry<BakerBlackboard>();
+    registry.addAction("knead", knead).addAction("bake", bake);
+
+    auto&& build = [&](const char* firstActionName)
+    {
+        // clang-format off
+        return fsm::Builder<BakerBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("First")
+                    .exec(registry.getAction(firstActionName))
+                        .andGoToState("Second")
+                .withState("Second")
+                    .exec(registry.getAction("bake")).andLoop()
+                .done()
+            .withBuildCache(directory, registry)
+            .build();
+        // clang-format on
+    };
+
+    SECTION("Compiled model is stored under the fingerprint")
+    {
+        std::ignore = build("knead");
+        REQUIRE(countEntries(directory) == 1u);
+
+        std::ignore = build("knead");
+        REQUIRE(countEntries(directory) == 1u);
+
+        std::ignore = build("bake");
+        REQUIRE(countEntries(directory) == 2u);
+    }
+
+    SECTION("Cached model is loaded instead of compiling")
+    {
+        std::ignore = build("bake");
+        const auto bakePath =
+            std::filesystem::directory_iterator(directory)->path();
+        std::ignore = build("knead");
+
+        // Replace the entry of the 'knead' machine with the 'bake' one
+        for (auto&& entry : std::filesystem::directory_iterator(directory))
+            if (entry.path() != bakePath)
+                std::filesystem::copy_file(
+                    bakePath,
+                    entry.path(),
+                    std::filesystem::copy_options::overwrite_existing);
+
+        auto&& machine = build("knead");
+        BakerBlackboard bb;
+        machine.tick(bb);
+        REQUIRE(bb.kneaded == 0u);
+        REQUIRE(bb.baked == 1u);
+    }
+
+    SECTION("Corrupted entry is rebuilt")
+    {
+        std::ignore = build("knead");
+        const auto path =
+            std::filesystem::directory_iterator(directory)->path();
+        std::ofstream(path, std::ios::binary) << "garbage";
+
+        auto&& machine = build("knead");
+        BakerBlackboard bb;
+        machine.tick(bb);
+        REQUIRE(bb.kneaded == 1u);
+        REQUIRE(std::filesystem::file_size(path) > 7u);
+    }
+
+    SECTION("Unnamed callables cannot be cached")
+    {
+        // clang-format off
+        REQUIRE_THROWS_AS(
+            fsm::Builder<BakerBlackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                    .withEntryState("First")
+                        .exec(knead).andLoop()
+                    .done()
+                .withBuildCache(directory, registry)
+                .build(),
+            fsm::Error);
+        // clang-format on
+    }
+
+    std::filesystem::remove_all(directory);
+}
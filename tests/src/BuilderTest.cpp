@@ -104,4 +104,22 @@ TEST_CASE("[Builder]")
             .build();
         // clang-format on
     }
-}
\ No newline at end of file
+
+    SECTION("Run-to-behavior mode rejects cycles of conditional transitions")
+    {
+        // clang-format off
+        REQUIRE_THROWS(fsm::Builder<Blackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("A")
+                    .when(alwaysTrue).goToState("B")
+                    .otherwiseExec(nothing).andLoop()
+                .withState("B")
+                    .when(alwaysTrue).goToState("A")
+                    .otherwiseExec(nothing).andLoop()
+                .done()
+            .runToBehavior()
+            .build());
+        // clang-format on
+    }
+}
@@ -0,0 +1,158 @@
+#include "catch_amalgamated.hpp"
+#include <fsm/ByteBuilder.hpp>
+#include <string>
+#include <vector>
+
+struct ByteBlackboard : fsm::ByteBlackboardBase
+{
+    std::vector<std::vector<std::string>> csv = { {} };
+};
+
+static void storeField(ByteBlackboard& bb, std::string_view token)
+{
+    bb.csv.back().emplace_back(token);
+}
+
+static void storeLastField(ByteBlackboard& bb, std::string_view token)
+{
+    storeField(bb, token);
+    bb.csv.emplace_back();
+}
+
+static fsm::ByteFsm<ByteBlackboard> buildCsvMachine()
+{
+    // clang-format off
+    return fsm::ByteBuilder<ByteBlackboard>()
+        .withEntryState("Field")
+            .on(',').exec(storeField).andLoop()
+            .on('\n').exec(storeLastField).andLoop()
+            .on('"').error()
+            .atEndOfInputExec(storeField)
+            .otherwiseConsume()
+        .build();
+    // clang-format on
+}
+
+TEST_CASE("[ByteFsm]")
+{
+    ByteBlackboard bb;
+
+    SECTION("Parses CSV")
+    {
+        auto&& machine = buildCsvMachine();
+        const auto input = std::string_view(
+            "first,second,a much longer third field\nx,,z");
+
+        REQUIRE(machine.process(bb, input) == input.size());
+        machine.finish(bb);
+
+        REQUIRE(
+            bb.csv
+            == std::vector<std::vector<std::string>> {
+                { "first", "second", "a much longer third field" },
+                { "x", "", "z" } });
+    }
+
+    SECTION("Tokens can span multiple chunks")
+    {
+        auto&& machine = buildCsvMachine();
+        const auto input =
+            std::string("abcdefghijklmnopqrstuvwxyz,0123456789\nend");
+
+        for (size_t i = 0; i < input.size(); i += 5)
+            REQUIRE(
+                machine.process(bb, std::string_view(input).substr(i, 5))
+                == std::min<size_t>(5u, input.size() - i));
+        machine.finish(bb);
+
+        REQUIRE(
+            bb.csv
+            == std::vector<std::vector<std::string>> {
+                { "abcdefghijklmnopqrstuvwxyz", "0123456789" }, { "end" } });
+    }
+
+    SECTION("Stops at error")
+    {
+        auto&& machine = buildCsvMachine();
+
+        REQUIRE(machine.process(bb, "ab,\"cd") == 4u);
+        REQUIRE(machine.isErrored(bb));
+        REQUIRE(machine.process(bb, "more") == 0u);
+    }
+
+    SECTION("Transitions between states")
+    {
+        // Accepts runs of digits separated by single spaces
+        // clang-format off
+        auto&& machine = fsm::ByteBuilder<ByteBlackboard>()
+            .withEntryState("Number")
+                .onAnyOf("0123456789").goToState("Number")
+                .on(' ').exec(storeField).andGoToState("Space")
+                .atEndOfInputExec(storeField)
+                .otherwiseError()
+            .withState("Space")
+                .onAnyOf("0123456789").goToState("Number")
+                .otherwiseError()
+            .build();
+        // clang-format on
+
+        REQUIRE(machine.process(bb, "12 345 6") == 8u);
+        machine.finish(bb);
+        REQUIRE(!machine.isErrored(bb));
+        REQUIRE(
+            bb.csv
+            == std::vector<std::vector<std::string>> { { "12", "345", "6" } });
+
+        machine.process(bb, "1  2");
+        REQUIRE(machine.isErrored(bb));
+    }
+
+    SECTION("Throws on multiple transitions for the same byte")
+    {
+        REQUIRE_THROWS_AS(
+            fsm::ByteBuilder<ByteBlackboard>()
+                .withEntryState("A")
+                .on('a')
+                .error()
+                .onAnyOf("cba"),
+            fsm::Error);
+    }
+
+    SECTION("Throws on undefined target state")
+    {
+        REQUIRE_THROWS_AS(
+            fsm::ByteBuilder<ByteBlackboard>()
+                .withEntryState("A")
+                .on('a')
+                .goToState("B")
+                .otherwiseConsume()
+                .build(),
+            fsm::Error);
+    }
+}
+
+TEST_CASE("[ByteScanner]")
+{
+    const auto input = std::string(100u, 'a') + "b" + std::string(20u, 'a');
+
+    SECTION("With few stop bytes")
+    {
+        const auto stopBytes = std::vector<std::uint8_t> { 'b', 'c' };
+        auto&& scanner = fsm::detail::ByteScanner(stopBytes);
+
+        REQUIRE(scanner.findStop(input, 0u) == 100u);
+        REQUIRE(scanner.findStop(input, 100u) == 100u);
+        REQUIRE(scanner.findStop(input, 101u) == input.size());
+    }
+
+    SECTION("With many stop bytes")
+    {
+        auto&& stopBytes = std::vector<std::uint8_t> {};
+        for (unsigned byte = 'b'; byte <= 'z'; ++byte)
+            stopBytes.push_back(static_cast<std::uint8_t>(byte));
+        auto&& scanner = fsm::detail::ByteScanner(stopBytes);
+
+        REQUIRE(scanner.findStop(input, 0u) == 100u);
+        REQUIRE(scanner.findStop(input, 101u) == input.size());
+    }
+}
@@ -1,3 +1,4 @@
+#include "Blackboard.hpp"
 #include "catch_amalgamated.hpp"
 #include <fsm/detail/Compiler.hpp>
 
@@ -42,4 +43,56 @@ TEST_CASE("[Compiler]")
                 TransitionContext { .secondary = "b" }, index));
         }
     }
+
+    SECTION("compileState")
+    {
+        auto&& index = StateIndex();
+        index.addNameToIndex("a");
+        auto&& stateExtras = std::vector<CompiledStateExtras<Blackboard>>();
+
+        SECTION("Plain state has no extras")
+        {
+            auto&& state = StateBuilderContext<Blackboard> {
+                .action = fsm::doNothing,
+                .destination = TransitionContext { .primary = "a" },
+            };
+
+            auto&& compiled =
+                Compiler::compileState(state, index, 0u, stateExtras);
+            REQUIRE(
+                compiled.extrasIdx == CompiledState<Blackboard>::NO_EXTRAS);
+            REQUIRE(stateExtras.empty());
+        }
+
+        SECTION("Wait condition is stored in the extras")
+        {
+            auto&& state = StateBuilderContext<Blackboard> {
+                .action = fsm::doNothing,
+                .destination = TransitionContext { .primary = "a" },
+                .waitCondition = [](const Blackboard&) { return true; },
+                .waitDependencies = 2u,
+            };
+
+            auto&& compiled =
+                Compiler::compileState(state, index, 0u, stateExtras);
+            REQUIRE(compiled.extrasIdx == 0u);
+            REQUIRE(stateExtras.size() == 1u);
+            REQUIRE(stateExtras[0].waitCondition);
+            REQUIRE(stateExtras[0].waitDependencies == 2u);
+        }
+    }
+
+    SECTION("Declaration index must fit into 16 bits")
+    {
+        auto&& index = StateIndex();
+        index.addNameToIndex("a");
+
+        REQUIRE_THROWS_AS(
+            Compiler::compileConditionalTransition(
+                Condition<Blackboard> {},
+                TransitionContext { .primary = "a" },
+                index,
+                MAX_DECLARATION_IDX + 1u),
+            fsm::Error);
+    }
 }
\ No newline at end of file
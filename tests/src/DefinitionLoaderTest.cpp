@@ -0,0 +1,142 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <fsm/DefinitionLoader.hpp>
+#include <fsm/exports/MermaidExporter.hpp>
+#include <sstream>
+
+struct MinerBlackboard
+    : fsm::BlackboardBase
+    , fsm::TrackedBlackboard
+{
+    bool full = false;
+    bool collapsed = false;
+    size_t digs = 0;
+};
+
+static bool isFull(const MinerBlackboard& bb)
+{
+    return bb.full;
+}
+
+static bool isCollapsed(const MinerBlackboard& bb)
+{
+    return bb.collapsed;
+}
+
+static void dig(MinerBlackboard& bb)
+{
+    ++bb.digs;
+}
+
+static void unload(MinerBlackboard& bb)
+{
+    bb.full = false;
+}
+
+static constexpr const char* DEFINITION = R"(
+# Miner digs until full, then unloads in a submachine
+error on isCollapsed
+    state Trapped
+        exec nothing -> loop
+
+machine Unload
+    state Walk
+        exec unload -> finish
+
+main
+    state Dig
+        when isFull 0x1 -> machine Unload then Rest
+        exec dig -> loop
+    state Rest
+        exec nothing -> state Dig
+)";
+
+TEST_CASE("[DefinitionLoader]")
+{
+    auto&& logger = TestableLogger();
+    auto&& registry = fsm::CallableRegistry<MinerBlackboard>();
+    registry.addCondition("isFull", isFull)
+        .addCondition("isCollapsed", isCollapsed)
+        .addAction("dig", dig)
+        .addAction("unload", unload);
+
+    auto&& load = [&](std::string_view text)
+    { return fsm::DefinitionLoader<MinerBlackboard>::load(text, registry); };
+
+    SECTION("Definition produces the same machine as the builder")
+    {
+        auto&& loadedDiagram = std::ostringstream();
+        std::ignore =
+            load(DEFINITION)
+                .exportDiagram(fsm::MermaidExporter(loadedDiagram))
+                .build();
+
+        auto&& builtDiagram = std::ostringstream();
+        // clang-format off
+        std::ignore = fsm::Builder<MinerBlackboard>()
+            .withErrorMachine()
+                .useGlobalEntryCondition(isCollapsed)
+                .withEntryState("Trapped")
+                    .exec(fsm::doNothing).andLoop()
+                .done()
+            .withSubmachine("Unload")
+                .withEntryState("Walk")
+                    .exec(unload).andFinish()
+                .done()
+            .withMainMachine()
+                .withEntryState("Dig")
+                    .when(isFull, 0x1)
+                        .goToMachine("Unload").thenGoToState("Rest")
+                    .otherwiseExec(dig).andLoop()
+                .withState("Rest")
+                    .exec(fsm::doNothing).andGoToState("Dig")
+                .done()
+            .exportDiagram(fsm::MermaidExporter(builtDiagram))
+            .build();
+        // clang-format on
+
+        REQUIRE(loadedDiagram.str() == builtDiagram.str());
+    }
+
+    SECTION("Loaded machine can be ticked")
+    {
+        auto&& machine = load(DEFINITION).build();
+        machine.setLogger(logger);
+
+        MinerBlackboard bb;
+        machine.tick(bb);
+        REQUIRE(bb.digs == 1u);
+
+        bb.full = true;
+        fsm::markDirty(bb, 0x1);
+        machine.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "Unload:Walk");
+
+        machine.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "__main__:Rest");
+        REQUIRE_FALSE(bb.full);
+
+        bb.collapsed = true;
+        machine.tick(bb);
+        REQUIRE(machine.isErrored(bb));
+    }
+
+    SECTION("Malformed definitions are rejected")
+    {
+        REQUIRE_THROWS_AS(load("main\nstate A\n"), fsm::Error);
+        REQUIRE_THROWS_AS(
+            load("main\nstate A\nexec dig -> jump\n"), fsm::Error);
+        REQUIRE_THROWS_AS(
+            load("main\nstate A\nexec sing -> loop\n"), fsm::Error);
+        REQUIRE_THROWS_AS(
+            load("main\nstate A\nexec dig -> machine B\n"), fsm::Error);
+        REQUIRE_THROWS_AS(
+            load("main\nstate A\nwhen isFull -> error\nexec dig -> loop\n"),
+            fsm::Error);
+        REQUIRE_THROWS_AS(
+            load("main\nstate __A\nexec dig -> loop\n"), fsm::Error);
+        REQUIRE_THROWS_AS(
+            load("machine B\nstate A\nexec dig -> loop\n"), fsm::Error);
+    }
+}
@@ -233,4 +233,97 @@ TEST_CASE("[FSM]")
         machine.tick(bb);
         REQUIRE(bb.__stateIdxs.back() == 4u); // __main__:End
     }
-}
\ No newline at end of file
+
+    SECTION("tickWithBudget resumes where the previous call stopped")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<Blackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Start")
+                    .exec(advanceChar).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        auto&& blackboards = std::vector<Blackboard>(5);
+        auto&& cursor = fsm::BatchCursor {
+            .clockCheckInterval = 1,
+            .minTicksPerCall = 2,
+        };
+
+        SECTION("Depleted budget ticks only the guaranteed minimum")
+        {
+            using namespace std::chrono_literals;
+
+            REQUIRE(machine.tickWithBudget(blackboards, 0ns, cursor) == 2u);
+            REQUIRE(cursor.nextIdx == 2u);
+            REQUIRE(machine.tickWithBudget(blackboards, 0ns, cursor) == 2u);
+            REQUIRE(machine.tickWithBudget(blackboards, 0ns, cursor) == 2u);
+            REQUIRE(cursor.nextIdx == 1u);
+            REQUIRE(cursor.completedPasses == 1u);
+
+            REQUIRE(blackboards[0].charIdx == 2u);
+            REQUIRE(blackboards[1].charIdx == 1u);
+            REQUIRE(blackboards[4].charIdx == 1u);
+        }
+
+        SECTION("Each blackboard is ticked at most once per call")
+        {
+            using namespace std::chrono_literals;
+
+            REQUIRE(machine.tickWithBudget(blackboards, 1h, cursor) == 5u);
+            REQUIRE(cursor.nextIdx == 0u);
+            REQUIRE(cursor.completedPasses == 1u);
+
+            for (auto&& bb : blackboards)
+                REQUIRE(bb.charIdx == 1u);
+        }
+    }
+
+    SECTION("Run-to-behavior mode follows conditional transitions in one tick")
+    {
+        auto&& createMachine = [](size_t stepLimit)
+        {
+            // clang-format off
+            return fsm::Builder<Blackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                    .withEntryState("Start")
+                        .when(alwaysTrue).goToState("Route")
+                        .otherwiseExec(nothing).andLoop()
+                    .withState("Route")
+                        .when(alwaysTrue).goToState("Work")
+                        .otherwiseExec(nothing).andLoop()
+                    .withState("Work")
+                        .exec(advanceChar).andLoop()
+                    .done()
+                .runToBehavior(stepLimit)
+                .build();
+            // clang-format on
+        };
+
+        // Ordering:
+        // 0: __main__:Start
+        // 1: __main__:Route
+        // 2: __main__:Work
+
+        SECTION("Tick stops after executing the behavior")
+        {
+            auto&& machine = createMachine(16);
+
+            machine.tick(bb);
+            REQUIRE(bb.__stateIdxs.back() == 2u);
+            REQUIRE(bb.charIdx == 1u);
+        }
+
+        SECTION("Tick stops when step limit is reached")
+        {
+            auto&& machine = createMachine(2);
+
+            machine.tick(bb);
+            REQUIRE(bb.__stateIdxs.back() == 2u);
+            REQUIRE(bb.charIdx == 0u);
+        }
+    }
+}
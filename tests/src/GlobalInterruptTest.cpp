@@ -0,0 +1,131 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <vector>
+
+struct VillagerBlackboard : fsm::BlackboardBase
+{
+    bool stunned = false;
+    size_t behaviors = 0;
+};
+
+static bool isStunned(const VillagerBlackboard& bb)
+{
+    return bb.stunned;
+}
+
+static bool isRecovered(const VillagerBlackboard& bb)
+{
+    return !bb.stunned;
+}
+
+static void act(VillagerBlackboard& bb)
+{
+    ++bb.behaviors;
+}
+
+TEST_CASE("[GlobalInterrupt]")
+{
+    auto&& logger = TestableLogger();
+    bool night = false;
+    size_t nightChecks = 0;
+
+    // clang-format off
+    auto&& machine = fsm::Builder<VillagerBlackboard>()
+        .withNoErrorMachine()
+        .withSubmachine("Stunned")
+            .withEntryState("Dazed")
+                .when(isRecovered).finish()
+                .otherwiseExec(act).andLoop()
+            .done()
+        .withSubmachine("Sleep")
+            .withEntryState("Snore")
+                .exec(act).andLoop()
+            .done()
+        .withMainMachine()
+            .withEntryState("Work")
+                .exec(act).andLoop()
+            .done()
+        .withGlobalInterrupt(isStunned).goToMachine("Stunned").thenRestart()
+        .withWorldInterrupt([&]
+            {
+                ++nightChecks;
+                return night;
+            }).goToMachine("Sleep").thenFinish()
+        .build();
+    // clang-format on
+
+    machine.setLogger(logger);
+
+    SECTION("Interrupt enters its submachine and is not re-evaluated there")
+    {
+        VillagerBlackboard bb;
+        machine.tick(bb);
+
+        bb.stunned = true;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Global interrupt 0 hit");
+        REQUIRE(logger.lastLogTargetState == "Stunned:Dazed");
+
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Behavior executed");
+
+        bb.stunned = false;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "__main__:Work");
+        REQUIRE(bb.__stateIdxs == std::vector<fsm::StateIdx> { 0u });
+    }
+
+    SECTION("World interrupt is evaluated once per batch")
+    {
+        auto&& agents = std::vector<VillagerBlackboard>(4);
+        machine.tickAll(agents);
+        REQUIRE(nightChecks == 1u);
+
+        night = true;
+        machine.tickAll(agents);
+        REQUIRE(nightChecks == 2u);
+        REQUIRE(logger.lastLogMessage == "Global interrupt 1 hit");
+        REQUIRE(logger.lastLogTargetState == "Sleep:Snore");
+
+        machine.tickAll(agents);
+        for (auto&& agent : agents)
+            REQUIRE(agent.behaviors == 2u);
+    }
+
+    SECTION("Interrupt is preempted only by interrupts of higher priority")
+    {
+        auto&& agents = std::vector<VillagerBlackboard>(1);
+        night = true;
+        machine.tickAll(agents);
+        REQUIRE(logger.lastLogTargetState == "Sleep:Snore");
+
+        agents[0].stunned = true;
+        machine.tickAll(agents);
+        REQUIRE(logger.lastLogMessage == "Global interrupt 0 hit");
+
+        machine.tickAll(agents);
+        REQUIRE(logger.lastLogMessage == "Behavior executed");
+        REQUIRE(logger.lastLogCurrentState == "Stunned:Dazed");
+    }
+
+    SECTION("Global interrupt must target a submachine")
+    {
+        auto&& build = []
+        {
+            // clang-format off
+            return fsm::Builder<VillagerBlackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                    .withEntryState("Work")
+                        .exec(act).andLoop()
+                    .done()
+                .withGlobalInterrupt(isStunned)
+                    .goToMachine("__main__").thenFinish()
+                .build();
+            // clang-format on
+        };
+
+        REQUIRE_THROWS_AS(build(), fsm::Error);
+    }
+}
@@ -0,0 +1,155 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <atomic>
+#include <fsm/Builder.hpp>
+#include <thread>
+
+struct FarmerBlackboard
+    : fsm::BlackboardBase
+    , fsm::ReloadableBlackboard
+{
+    size_t sowed = 0;
+    size_t harvested = 0;
+};
+
+static void sow(FarmerBlackboard& bb)
+{
+    ++bb.sowed;
+}
+
+static void harvest(FarmerBlackboard& bb)
+{
+    ++bb.harvested;
+}
+
+static fsm::Fsm<FarmerBlackboard> createFarmer()
+{
+    // clang-format off
+    return fsm::Builder<FarmerBlackboard>()
+        .withNoErrorMachine()
+        .withMainMachine()
+            .withEntryState("Sow")
+                .exec(sow).andGoToState("Harvest")
+            .withState("Harvest")
+                .exec(harvest).andGoToState("Sow")
+            .done()
+        .build();
+    // clang-format on
+}
+
+TEST_CASE("[HotReload]")
+{
+    auto&& logger = TestableLogger();
+    auto&& machine = createFarmer();
+    machine.setLogger(logger);
+
+    FarmerBlackboard bb;
+    machine.tick(bb);
+    REQUIRE(bb.__stateIdxs.back() == 1u);
+
+    SECTION("Surviving state is found by its name")
+    {
+        // clang-format off
+        machine.reload(fsm::Builder<FarmerBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Rest")
+                    .exec(fsm::doNothing).andLoop()
+                .withState("Sow")
+                    .exec(sow).andLoop()
+                .withState("Harvest")
+                    .exec(harvest).andGoToState("Rest")
+                .done()
+            .build());
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE(bb.harvested == 1u);
+        REQUIRE(logger.lastLogTargetState == "__main__:Rest");
+
+        // Index 0 of a fresh blackboard is the new entry state, not Sow
+        FarmerBlackboard fresh;
+        machine.tick(fresh);
+        REQUIRE(fresh.sowed == 0u);
+        REQUIRE(logger.lastLogTargetState == "__main__:Rest");
+    }
+
+    SECTION("Agent in a removed state restarts from the main entry")
+    {
+        // clang-format off
+        machine.reload(fsm::Builder<FarmerBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Sow")
+                    .exec(sow).andLoop()
+                .done()
+            .build());
+        // clang-format on
+
+        machine.tick(bb);
+        REQUIRE(bb.sowed == 2u);
+        REQUIRE(bb.harvested == 0u);
+    }
+
+    SECTION("Agent is remapped across several reloads")
+    {
+        machine.reload(createFarmer());
+        machine.reload(createFarmer());
+
+        machine.tick(bb);
+        REQUIRE(bb.harvested == 1u);
+        REQUIRE(bb.__modelGeneration == 2u);
+    }
+
+    SECTION("Machine can be reloaded from its own action")
+    {
+        fsm::Fsm<FarmerBlackboard>* self = nullptr;
+
+        // clang-format off
+        auto&& reloading = fsm::Builder<FarmerBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Reload")
+                    .exec([&](FarmerBlackboard&)
+                        { self->reload(createFarmer()); })
+                    .andLoop()
+                .done()
+            .build();
+        // clang-format on
+        self = &reloading;
+
+        FarmerBlackboard agent;
+        reloading.tick(agent);
+        REQUIRE(agent.__modelGeneration == 0u);
+
+        // State Reload no longer exists
+        reloading.tick(agent);
+        REQUIRE(agent.sowed == 1u);
+        REQUIRE(agent.__modelGeneration == 1u);
+    }
+
+    SECTION("Machine can be reloaded while another thread ticks it")
+    {
+        auto&& blackboards = std::vector<FarmerBlackboard>(64);
+        auto&& running = std::atomic<bool>(true);
+        auto&& worker = std::thread(
+            [&]
+            {
+                while (running)
+                    machine.tickAll(blackboards);
+            });
+
+        for (size_t reload = 0; reload < 32; ++reload)
+            machine.reload(createFarmer());
+
+        running = false;
+        worker.join();
+
+        machine.tickAll(blackboards);
+        for (auto&& blackboard : blackboards)
+        {
+            REQUIRE(blackboard.__modelGeneration == 32u);
+            REQUIRE(blackboard.sowed + blackboard.harvested > 0u);
+        }
+    }
+}
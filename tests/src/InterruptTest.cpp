@@ -0,0 +1,159 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+
+struct SquadBlackboard : fsm::BlackboardBase
+{
+    bool enemySeen = false;
+    bool hurt = false;
+    bool outOfAmmo = false;
+    bool alarm = false;
+    size_t hurtChecks = 0;
+    size_t behaviors = 0;
+};
+
+static bool isEnemySeen(const SquadBlackboard& bb)
+{
+    return bb.enemySeen;
+}
+
+static bool isHurt(const SquadBlackboard& bb)
+{
+    ++const_cast<SquadBlackboard&>(bb).hurtChecks;
+    return bb.hurt;
+}
+
+static bool isOutOfAmmo(const SquadBlackboard& bb)
+{
+    return bb.outOfAmmo;
+}
+
+static bool isAlarm(const SquadBlackboard& bb)
+{
+    return bb.alarm;
+}
+
+static void act(SquadBlackboard& bb)
+{
+    ++bb.behaviors;
+}
+
+TEST_CASE("[Interrupt]")
+{
+    auto&& logger = TestableLogger();
+
+    // clang-format off
+    auto&& machine = fsm::Builder<SquadBlackboard>()
+        .withNoErrorMachine()
+        .withSubmachine("Combat")
+            .interruptWhen(isHurt).goToState("Heal")
+            .interruptWhen(isOutOfAmmo).finish()
+            .withEntryState("Aim")
+                .exec(act).andGoToState("Shoot")
+            .withState("Shoot")
+                .exec(act).andGoToState("Aim")
+            .withState("Heal")
+                .exec(act).andGoToState("Aim")
+            .done()
+        .withMainMachine()
+            .interruptWhen(isAlarm).goToState("Flee")
+            .withEntryState("Patrol")
+                .when(isEnemySeen).goToMachine("Combat").thenGoToState("Patrol")
+                .otherwiseExec(act).andLoop()
+            .withState("Flee")
+                .exec(act).andLoop()
+            .done()
+        .build();
+    // clang-format on
+
+    machine.setLogger(logger);
+
+    SquadBlackboard bb;
+    bb.enemySeen = true;
+    machine.tick(bb);
+    REQUIRE(logger.lastLogTargetState == "Combat:Aim");
+
+    SECTION("Interrupt of the submachine is checked once per tick")
+    {
+        bb.hurtChecks = 0;
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(bb.hurtChecks == 2u);
+        REQUIRE(bb.behaviors == 2u);
+
+        bb.hurt = true;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Interrupt 0 hit");
+        REQUIRE(logger.lastLogTargetState == "Combat:Heal");
+        REQUIRE(bb.__stateIdxs.size() == 2u);
+
+        // Interrupt is not evaluated in its target state
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Behavior executed");
+        REQUIRE(bb.behaviors == 3u);
+    }
+
+    SECTION("Finishing interrupt returns to the calling machine")
+    {
+        bb.outOfAmmo = true;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Interrupt 1 hit");
+        REQUIRE(logger.lastLogTargetState == "__main__:Patrol");
+        REQUIRE(bb.__stateIdxs.size() == 1u);
+    }
+
+    SECTION("Interrupts of outer machines are evaluated first")
+    {
+        bb.hurt = true;
+        bb.alarm = true;
+        bb.hurtChecks = 0;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Interrupt 0 hit");
+        REQUIRE(logger.lastLogTargetState == "__main__:Flee");
+        REQUIRE(bb.__stateIdxs.size() == 1u);
+        REQUIRE(bb.hurtChecks == 0u);
+
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Behavior executed");
+    }
+}
+
+TEST_CASE("[Interrupt] Submachine invoked without a return state")
+{
+    // clang-format off
+    auto&& machine = fsm::Builder<SquadBlackboard>()
+        .withNoErrorMachine()
+        .withSubmachine("Combat")
+            .interruptWhen(isOutOfAmmo).finish()
+            .withEntryState("Aim")
+                .exec(act).andLoop()
+            .done()
+        .withMainMachine()
+            .interruptWhen(isAlarm).goToState("Flee")
+            .withEntryState("Patrol")
+                .when(isEnemySeen).goToMachine("Combat").thenFinish()
+                .otherwiseExec(act).andLoop()
+            .withState("Flee")
+                .exec(act).andLoop()
+            .done()
+        .build();
+    // clang-format on
+
+    SquadBlackboard bb;
+    bb.enemySeen = true;
+    machine.tick(bb);
+    REQUIRE(bb.__stateIdxs.size() == 1u);
+    const auto aimIdx = bb.__stateIdxs.back();
+
+    // Main machine keeps no state on the stack, so it is already finished
+    // and its interrupts are not checked
+    bb.alarm = true;
+    machine.tick(bb);
+    REQUIRE(bb.behaviors == 1u);
+    REQUIRE(bb.__stateIdxs.size() == 1u);
+    REQUIRE(bb.__stateIdxs.back() == aimIdx);
+
+    bb.outOfAmmo = true;
+    machine.tick(bb);
+    REQUIRE(machine.isFinished(bb));
+}
@@ -0,0 +1,55 @@
+#include "catch_amalgamated.hpp"
+#include <filesystem>
+#include <fsm/Error.hpp>
+#include <fsm/MappedFile.hpp>
+#include <fstream>
+#include <string>
+
+TEST_CASE("[MappedFile]")
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "fsm-mapped-file-test.txt";
+
+    auto&& writeFile = [&path](const std::string& content)
+    {
+        auto&& save = std::ofstream(path, std::ios::binary);
+        save << content;
+    };
+
+    SECTION("Exposes contents of the file")
+    {
+        const auto content = std::string(10'000u, 'x') + "end";
+        writeFile(content);
+
+        {
+            auto&& file = fsm::MappedFile(path);
+            const auto data = file.getData();
+            REQUIRE(std::string(data.begin(), data.end()) == content);
+
+            auto&& moved = fsm::MappedFile(std::move(file));
+            REQUIRE(file.getData().empty());
+            REQUIRE(moved.getData().size() == content.size());
+            REQUIRE(moved.getData().back() == 'd');
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Maps empty file")
+    {
+        writeFile("");
+
+        {
+            auto&& file = fsm::MappedFile(path);
+            REQUIRE(file.getData().empty());
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Throws if file does not exist")
+    {
+        std::filesystem::remove(path);
+        REQUIRE_THROWS_AS(fsm::MappedFile(path), fsm::Error);
+    }
+}
@@ -0,0 +1,226 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <fsm/CallableRegistry.hpp>
+#include <fsm/detail/BinaryIO.hpp>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+struct GuardBlackboard : fsm::BlackboardBase
+{
+    bool intruder = false;
+    bool alarm = false;
+    size_t patrols = 0;
+};
+
+static bool hasIntruder(const GuardBlackboard& bb)
+{
+    return bb.intruder;
+}
+
+static bool isAlarm(const GuardBlackboard& bb)
+{
+    return bb.alarm;
+}
+
+static void patrol(GuardBlackboard& bb)
+{
+    ++bb.patrols;
+}
+
+static void idle(GuardBlackboard&) {}
+
+/**
+ * Offset of the end of error states in the saved data,
+ * the step limit follows it
+ */
+static size_t getErrorStateEndOffset(std::string_view data)
+{
+    auto&& reader = fsm::detail::BinaryReader(data);
+    std::ignore = reader.readU32();
+    std::ignore = reader.readU32();
+
+    const char* end = data.data();
+    for (size_t list = 0; list < 2u; ++list)
+    {
+        const auto count = reader.readSize();
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+            const auto name = reader.readString();
+            end = name.data() + name.size();
+        }
+    }
+    return static_cast<size_t>(end - data.data());
+}
+
+static std::string
+overwriteSize(std::string data, size_t offset, std::uint32_t value)
+{
+    for (size_t byte = 0; byte < sizeof(value); ++byte)
+        data[offset + byte] = static_cast<char>((value >> (byte * 8u)) & 0xffu);
+    return data;
+}
+
+static fsm::CallableRegistry<GuardBlackboard> createRegistry()
+{
+    auto&& registry = fsm::CallableRegistry<GuardBlackboard>();
+    registry.addCondition("hasIntruder", hasIntruder)
+        .addCondition("isAlarm", isAlarm)
+        .addAction("patrol", patrol)
+        .addAction("idle", idle);
+    return registry;
+}
+
+TEST_CASE("[ModelSerialization]")
+{
+    auto&& logger = TestableLogger();
+    auto&& registry = createRegistry();
+
+    // clang-format off
+    auto&& machine = fsm::Builder<GuardBlackboard>()
+        .withErrorMachine()
+            .useGlobalEntryCondition(registry.getCondition("isAlarm"))
+            .withEntryState("Panic")
+                .exec(registry.getAction("idle")).andLoop()
+            .done()
+        .withSubmachine("Chase")
+            .withEntryState("Run")
+                .exec(registry.getAction("patrol")).andFinish()
+            .done()
+        .withMainMachine()
+            .withEntryState("Patrol")
+                .when(registry.getCondition("hasIntruder"))
+                    .goToMachine("Chase").thenGoToState("Rest")
+                .otherwiseExec(registry.getAction("patrol")).andLoop()
+            .withState("Rest")
+                .exec(fsm::doNothing).andGoToState("Patrol")
+            .done()
+        .build();
+    // clang-format on
+
+    auto&& out = std::ostringstream();
+    machine.saveModel(out);
+    const auto data = out.str();
+
+    SECTION("Loaded model behaves like the original one")
+    {
+        auto&& loaded = fsm::Fsm<GuardBlackboard>::loadModel(data, registry);
+        loaded.setLogger(logger);
+
+        GuardBlackboard bb;
+        loaded.tick(bb);
+        REQUIRE(bb.patrols == 1u);
+
+        bb.intruder = true;
+        loaded.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "Chase:Run");
+
+        loaded.tick(bb);
+        REQUIRE(bb.patrols == 2u);
+        REQUIRE(logger.lastLogTargetState == "__main__:Rest");
+
+        bb.alarm = true;
+        loaded.tick(bb);
+        REQUIRE(loaded.isErrored(bb));
+    }
+
+    SECTION("Loaded model can be saved again")
+    {
+        auto&& loaded = fsm::Fsm<GuardBlackboard>::loadModel(data, registry);
+        auto&& resaved = std::ostringstream();
+        loaded.saveModel(resaved);
+        REQUIRE(resaved.str() == data);
+    }
+
+    SECTION("Loading fails without a registered callable")
+    {
+        auto&& incomplete = fsm::CallableRegistry<GuardBlackboard>();
+        incomplete.addCondition("hasIntruder", hasIntruder)
+            .addAction("patrol", patrol);
+
+        REQUIRE_THROWS_AS(
+            fsm::Fsm<GuardBlackboard>::loadModel(data, incomplete),
+            fsm::Error);
+    }
+
+    SECTION("Loading fails on truncated data")
+    {
+        auto&& truncated = std::span(data).first(data.size() / 2);
+        REQUIRE_THROWS_AS(
+            fsm::Fsm<GuardBlackboard>::loadModel(truncated, registry),
+            fsm::Error);
+    }
+
+    SECTION("Loading fails on counts larger than the data")
+    {
+        // Count of callable names follows magic and version
+        const auto offset = 2 * sizeof(std::uint32_t);
+        REQUIRE_THROWS_WITH(
+            fsm::Fsm<GuardBlackboard>::loadModel(
+                overwriteSize(data, offset, 0xffffffffu), registry),
+            Catch::Matchers::ContainsSubstring("exceeds"));
+    }
+
+    SECTION("Loading fails on invalid end of error states")
+    {
+        const auto offset = getErrorStateEndOffset(data);
+        REQUIRE(
+            fsm::detail::BinaryReader(std::span(data).subspan(offset))
+                .readSize()
+            == 2u);
+
+        for (auto&& value : { 0u, 100u })
+            REQUIRE_THROWS_AS(
+                fsm::Fsm<GuardBlackboard>::loadModel(
+                    overwriteSize(data, offset, value), registry),
+                fsm::Error);
+    }
+
+    SECTION("Loading fails on zero step limit")
+    {
+        const auto offset = getErrorStateEndOffset(data) + sizeof(std::uint32_t);
+        REQUIRE_THROWS_AS(
+            fsm::Fsm<GuardBlackboard>::loadModel(
+                overwriteSize(data, offset, 0u), registry),
+            fsm::Error);
+    }
+
+    SECTION("Loading fails on more states than the index width allows")
+    {
+        if constexpr (sizeof(fsm::StateIdx) <= sizeof(std::uint16_t))
+        {
+            // Magic and version are taken from the saved model
+            auto&& writer = fsm::detail::BinaryWriter();
+            writer.writeSize(0);
+            writer.writeSize(fsm::NO_STATE_IDX);
+            for (size_t idx = 0; idx < fsm::NO_STATE_IDX; ++idx)
+                writer.writeString(std::to_string(idx));
+            writer.writeSize(1);
+            writer.writeSize(1);
+
+            REQUIRE_THROWS_WITH(
+                fsm::Fsm<GuardBlackboard>::loadModel(
+                    data.substr(0, 2 * sizeof(std::uint32_t))
+                        + writer.getData(),
+                    registry),
+                Catch::Matchers::ContainsSubstring("FSM_STATE_INDEX_BITS"));
+        }
+    }
+
+    SECTION("Saving fails with an unnamed callable")
+    {
+        // clang-format off
+        auto&& unnamed = fsm::Builder<GuardBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Patrol")
+                    .exec(patrol).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        auto&& sink = std::ostringstream();
+        REQUIRE_THROWS_AS(unnamed.saveModel(sink), fsm::Error);
+    }
+}
@@ -0,0 +1,161 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <fsm/VariantBuilder.hpp>
+
+struct KnightBlackboard
+    : fsm::BlackboardBase
+    , fsm::ReloadableBlackboard
+{
+    size_t health = 10;
+    size_t attacks = 0;
+    size_t charges = 0;
+    size_t retreats = 0;
+};
+
+static bool isWounded(const KnightBlackboard& bb)
+{
+    return bb.health < 5;
+}
+
+static bool isDying(const KnightBlackboard& bb)
+{
+    return bb.health < 2;
+}
+
+static void attack(KnightBlackboard& bb)
+{
+    ++bb.attacks;
+}
+
+static void charge(KnightBlackboard& bb)
+{
+    ++bb.charges;
+}
+
+static void retreat(KnightBlackboard& bb)
+{
+    ++bb.retreats;
+}
+
+TEST_CASE("[ModelVariant]")
+{
+    auto&& logger = TestableLogger();
+
+    auto&& build = [](void (*retreatAction)(KnightBlackboard&))
+    {
+        // clang-format off
+        return fsm::Builder<KnightBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Attack")
+                    .when(isWounded).goToState("Retreat")
+                    .otherwiseExec(attack).andLoop()
+                .withState("Retreat")
+                    .exec(retreatAction).andGoToState("Attack")
+                .done()
+            .build();
+        // clang-format on
+    };
+
+    auto&& soldier = build(retreat);
+
+    SECTION("Variant runs the overridden action")
+    {
+        auto&& berserker = fsm::VariantBuilder(soldier)
+                               .overrideAction("__main__:Attack", charge)
+                               .build();
+
+        KnightBlackboard bb;
+        berserker.tick(bb);
+        REQUIRE(bb.charges == 1u);
+        REQUIRE(bb.attacks == 0u);
+
+        soldier.tick(bb);
+        REQUIRE(bb.charges == 1u);
+        REQUIRE(bb.attacks == 1u);
+    }
+
+    SECTION("Variant evaluates the overridden condition")
+    {
+        auto&& berserker = fsm::VariantBuilder(soldier)
+                               .overrideCondition("__main__:Attack", 0, isDying)
+                               .build();
+        berserker.setLogger(logger);
+
+        KnightBlackboard bb;
+        bb.health = 3;
+        berserker.tick(bb);
+        REQUIRE(bb.attacks == 1u);
+
+        bb.health = 1;
+        berserker.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "__main__:Retreat");
+        berserker.tick(bb);
+        REQUIRE(bb.retreats == 1u);
+    }
+
+    SECTION("State can be overridden several times")
+    {
+        auto&& coward = fsm::VariantBuilder(soldier)
+                            .overrideAction("__main__:Attack", retreat)
+                            .overrideCondition("__main__:Attack", 0, isDying)
+                            .overrideAction("__main__:Retreat", charge)
+                            .build();
+
+        KnightBlackboard bb;
+        bb.health = 3;
+        coward.tick(bb);
+        REQUIRE(bb.retreats == 1u);
+
+        bb.health = 1;
+        coward.tick(bb);
+        coward.tick(bb);
+        REQUIRE(bb.charges == 1u);
+        REQUIRE(bb.attacks == 0u);
+    }
+
+    SECTION("Variant keeps its model when the base is reloaded")
+    {
+        auto&& berserker = fsm::VariantBuilder(soldier)
+                               .overrideAction("__main__:Attack", charge)
+                               .build();
+        soldier.reload(build(charge));
+
+        KnightBlackboard bb;
+        bb.health = 1;
+        berserker.tick(bb);
+        berserker.tick(bb);
+        REQUIRE(bb.retreats == 1u);
+    }
+
+    SECTION("Variant of a reloaded base shares blackboards with it")
+    {
+        soldier.reload(build(retreat));
+        auto&& berserker = fsm::VariantBuilder(soldier)
+                               .overrideAction("__main__:Attack", charge)
+                               .build();
+
+        KnightBlackboard bb;
+        soldier.tick(bb);
+        berserker.tick(bb);
+        REQUIRE(bb.attacks == 1u);
+        REQUIRE(bb.charges == 1u);
+
+        bb.health = 1;
+        soldier.tick(bb);
+        berserker.tick(bb);
+        REQUIRE(bb.retreats == 1u);
+        REQUIRE(bb.__modelGeneration == 1u);
+    }
+
+    SECTION("Unknown state or condition cannot be overridden")
+    {
+        auto&& builder = fsm::VariantBuilder(soldier);
+        REQUIRE_THROWS_AS(
+            builder.overrideAction("__main__:Sleep", charge), fsm::Error);
+        REQUIRE_THROWS_AS(
+            builder.overrideCondition("__main__:Retreat", 0, isDying),
+            fsm::Error);
+    }
+}
@@ -0,0 +1,134 @@
+#include "Blackboard.hpp"
+#include "CsvParser.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+
+TEST_CASE("[Optimizer]")
+{
+    Blackboard bb;
+    auto&& report = fsm::OptimizationReport {};
+
+    SECTION("Removes, collapses and merges states")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<Blackboard>()
+            .withErrorMachine()
+                .noGlobalEntryCondition()
+                .withEntryState("Start")
+                    .exec(nothing).andLoop()
+                .withState("Dead")
+                    .exec(advanceChar).andLoop()
+                .done()
+            .withSubmachine("Unused")
+                .withEntryState("A")
+                    .exec(nothing).andFinish()
+                .done()
+            .withMainMachine()
+                .withEntryState("Start")
+                    .exec(fsm::doNothing).andGoToState("Route")
+                .withState("Route")
+                    .exec(fsm::doNothing).andGoToState("Work")
+                .withState("Work")
+                    .when(isEof).goToState("Finish1")
+                    .orWhen(isExclamationMark).goToState("Finish2")
+                    .otherwiseExec(advanceChar).andLoop()
+                .withState("Finish1")
+                    .exec(nothing).andFinish()
+                .withState("Finish2")
+                    .exec(nothing).andFinish()
+                .done()
+            .optimize(report)
+            .build();
+        // clang-format on
+
+        REQUIRE(report.mergedStates.size() == 3u);
+        REQUIRE(report.mergedStates.at("__main__:Start") == "__main__:Work");
+        REQUIRE(report.mergedStates.at("__main__:Route") == "__main__:Work");
+        REQUIRE(
+            report.mergedStates.at("__main__:Finish2") == "__main__:Finish1");
+
+        REQUIRE(report.removedStates.size() == 2u);
+        REQUIRE(report.removedStates[0] == "Unused:A");
+        REQUIRE(report.removedStates[1] == "__error__:Dead");
+
+        // Ordering:
+        // 0: __main__:Work
+        // 1: __error__:Start
+        // 2: __main__:Finish1
+
+        bb.data = "a!";
+        machine.tick(bb);
+        REQUIRE(bb.__stateIdxs.back() == 0u);
+        machine.tick(bb);
+        REQUIRE(bb.__stateIdxs.back() == 2u);
+        machine.tick(bb);
+        REQUIRE(machine.isFinished(bb));
+    }
+
+    SECTION("Keeps cycles of pass-through states")
+    {
+        // clang-format off
+        std::ignore = fsm::Builder<Blackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("A")
+                    .exec(fsm::doNothing).andGoToState("B")
+                .withState("B")
+                    .exec(fsm::doNothing).andGoToState("A")
+                .done()
+            .optimize(report)
+            .build();
+        // clang-format on
+
+        REQUIRE(report.mergedStates.empty());
+        REQUIRE(report.removedStates.empty());
+    }
+
+    SECTION("Keeps pass-through states that interrupts transition to")
+    {
+        // clang-format off
+        std::ignore = fsm::Builder<Blackboard>()
+            .withNoErrorMachine()
+            .withSubmachine("Alarm")
+                .withEntryState("Start")
+                    .exec(fsm::doNothing).andGoToState("Ring")
+                .withState("Ring")
+                    .exec(advanceChar).andFinish()
+                .done()
+            .withMainMachine()
+                .interruptWhen(isExclamationMark).goToState("Skip")
+                .withEntryState("Read")
+                    .exec(advanceChar).andGoToState("Route")
+                .withState("Route")
+                    .exec(fsm::doNothing).andGoToState("Read")
+                .withState("Skip")
+                    .exec(fsm::doNothing).andGoToState("Read")
+                .done()
+            .withGlobalInterrupt(isEof).goToMachine("Alarm").thenRestart()
+            .optimize(report)
+            .build();
+        // clang-format on
+
+        REQUIRE(report.mergedStates.size() == 1u);
+        REQUIRE(report.mergedStates.at("__main__:Route") == "__main__:Read");
+        REQUIRE(report.removedStates.empty());
+    }
+
+    SECTION("Does not merge states with lambdas")
+    {
+        // clang-format off
+        std::ignore = fsm::Builder<Blackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("A")
+                    .exec([](Blackboard&) {}).andGoToState("B")
+                .withState("B")
+                    .exec([](Blackboard&) {}).andGoToState("A")
+                .done()
+            .optimize(report)
+            .build();
+        // clang-format on
+
+        REQUIRE(report.mergedStates.empty());
+    }
+}
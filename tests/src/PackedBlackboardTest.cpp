@@ -0,0 +1,269 @@
+#include "catch_amalgamated.hpp"
+#include <cstring>
+#include <format>
+#include <sstream>
+#include <fsm/Builder.hpp>
+#include <fsm/DefinitionLoader.hpp>
+#include <type_traits>
+
+template<class BaseT>
+struct GuardBlackboard : BaseT
+{
+    int enemyHealth = 3;
+    int strikes = 0;
+    int reloads = 0;
+    int rests = 0;
+};
+
+using PackedGuardBlackboard = GuardBlackboard<fsm::PackedBlackboardBase<>>;
+using NarrowGuardBlackboard = GuardBlackboard<fsm::PackedBlackboardBase<8>>;
+
+static_assert(std::is_trivially_copyable_v<PackedGuardBlackboard>);
+static_assert(std::is_trivially_copyable_v<NarrowGuardBlackboard>);
+static_assert(NarrowGuardBlackboard::PackedStateStack::CAPACITY == 8u);
+
+template<class BbT>
+static bool isEnemyDown(const BbT& bb)
+{
+    return bb.enemyHealth <= 0;
+}
+
+template<class BbT>
+static void strike(BbT& bb)
+{
+    --bb.enemyHealth;
+    ++bb.strikes;
+}
+
+template<class BbT>
+static void reload(BbT& bb)
+{
+    ++bb.reloads;
+}
+
+template<class BbT>
+static void rest(BbT& bb)
+{
+    bb.enemyHealth = 3;
+    ++bb.rests;
+}
+
+template<class BbT>
+static fsm::Fsm<BbT> buildGuard()
+{
+    // clang-format off
+    return fsm::Builder<BbT>()
+        .withNoErrorMachine()
+        .withSubmachine("Reload")
+            .withEntryState("Load")
+                .exec(reload<BbT>).andFinish()
+            .done()
+        .withSubmachine("Fight")
+            .withEntryState("Strike")
+                .when(isEnemyDown<BbT>).finish()
+                .otherwiseExec(strike<BbT>)
+                    .andGoToMachine("Reload").thenGoToState("Strike")
+            .done()
+        .withMainMachine()
+            .withEntryState("Patrol")
+                .exec(fsm::doNothing)
+                    .andGoToMachine("Fight").thenGoToState("Rest")
+            .withState("Rest")
+                .exec(rest<BbT>).andGoToState("Patrol")
+            .done()
+        .build();
+    // clang-format on
+}
+
+// Chain of submachines, each invoking the previous one
+template<class BbT>
+static auto loadSubmachineChain(size_t submachineCount)
+{
+    auto&& registry = fsm::CallableRegistry<BbT>();
+    auto&& definition = std::string(
+        "machine M0\n"
+        "state A\n"
+        "exec nothing -> finish\n");
+    for (size_t idx = 1; idx < submachineCount; ++idx)
+        definition += std::format(
+            "machine M{}\n"
+            "state A\n"
+            "exec nothing -> machine M{} then B\n"
+            "state B\n"
+            "exec nothing -> finish\n",
+            idx,
+            idx - 1);
+    definition += std::format(
+        "main\n"
+        "state A\n"
+        "exec nothing -> machine M{} then B\n"
+        "state B\n"
+        "exec nothing -> loop\n",
+        submachineCount - 1);
+
+    return fsm::DefinitionLoader<BbT>::load(definition, registry);
+}
+
+static fsm::AsyncBehavior lookAround(PackedGuardBlackboard&)
+{
+    co_await fsm::nextTick();
+}
+
+TEST_CASE("[PackedBlackboard]")
+{
+    auto&& packedGuard = buildGuard<PackedGuardBlackboard>();
+
+    SECTION("Packed stack follows the same states as a vector stack")
+    {
+        using VectorGuardBlackboard = GuardBlackboard<fsm::BlackboardBase>;
+        auto&& vectorGuard = buildGuard<VectorGuardBlackboard>();
+
+        PackedGuardBlackboard packedBb;
+        VectorGuardBlackboard vectorBb;
+        for (size_t tick = 0; tick < 20u; ++tick)
+        {
+            packedGuard.tick(packedBb);
+            vectorGuard.tick(vectorBb);
+
+            REQUIRE(
+                packedBb.__stateIdxs.size() == vectorBb.__stateIdxs.size());
+            for (size_t level = 0; level < vectorBb.__stateIdxs.size();
+                 ++level)
+                REQUIRE(
+                    packedBb.__stateIdxs[level]
+                    == vectorBb.__stateIdxs[level]);
+        }
+
+        REQUIRE(packedBb.strikes == vectorBb.strikes);
+        REQUIRE(packedBb.reloads == vectorBb.reloads);
+        REQUIRE(packedBb.rests > 0);
+    }
+
+    SECTION("Blackboard can be restored from a byte copy")
+    {
+        PackedGuardBlackboard bb;
+        packedGuard.tick(bb);
+        packedGuard.tick(bb);
+        REQUIRE(bb.__stateIdxs.size() == 3u);
+
+        PackedGuardBlackboard snapshot;
+        std::memcpy(&snapshot, &bb, sizeof(bb));
+
+        packedGuard.tick(bb);
+        packedGuard.tick(bb);
+        const auto expectedStack = bb.__stateIdxs;
+        const auto expectedStrikes = bb.strikes;
+
+        std::memcpy(&bb, &snapshot, sizeof(bb));
+        REQUIRE(bb.__stateIdxs == snapshot.__stateIdxs);
+
+        packedGuard.tick(bb);
+        packedGuard.tick(bb);
+        REQUIRE(bb.__stateIdxs == expectedStack);
+        REQUIRE(bb.strikes == expectedStrikes);
+    }
+
+    SECTION("Machine nesting deeper than the stack capacity is rejected")
+    {
+        constexpr auto CAPACITY =
+            PackedGuardBlackboard::PackedStateStack::CAPACITY;
+
+        auto&& machine =
+            loadSubmachineChain<PackedGuardBlackboard>(CAPACITY - 1).build();
+        PackedGuardBlackboard bb;
+        for (size_t idx = 1; idx < CAPACITY; ++idx)
+            machine.tick(bb);
+        REQUIRE(bb.__stateIdxs.size() == CAPACITY);
+
+        REQUIRE_THROWS_AS(
+            loadSubmachineChain<PackedGuardBlackboard>(CAPACITY).build(),
+            fsm::Error);
+    }
+
+    SECTION("Narrower indices allow deeper nesting of small machines")
+    {
+        auto&& machine =
+            loadSubmachineChain<NarrowGuardBlackboard>(7u).build();
+        NarrowGuardBlackboard bb;
+        for (size_t idx = 1; idx < 8u; ++idx)
+            machine.tick(bb);
+        REQUIRE(bb.__stateIdxs.size() == 8u);
+
+        REQUIRE_THROWS_AS(
+            loadSubmachineChain<NarrowGuardBlackboard>(8u).build(),
+            fsm::Error);
+    }
+
+    SECTION("Loaded model nesting deeper than the stack capacity is rejected")
+    {
+        using VectorGuardBlackboard = GuardBlackboard<fsm::BlackboardBase>;
+        constexpr auto CAPACITY =
+            PackedGuardBlackboard::PackedStateStack::CAPACITY;
+
+        auto&& deep =
+            loadSubmachineChain<VectorGuardBlackboard>(CAPACITY).build();
+        auto&& out = std::ostringstream();
+        deep.saveModel(out);
+        const auto data = out.str();
+
+        auto&& registry = fsm::CallableRegistry<PackedGuardBlackboard>();
+        REQUIRE_THROWS_WITH(
+            fsm::Fsm<PackedGuardBlackboard>::loadModel(data, registry),
+            Catch::Matchers::ContainsSubstring("nested states"));
+
+        if constexpr (NarrowGuardBlackboard::PackedStateStack::CAPACITY
+                      > CAPACITY)
+        {
+            auto&& narrowRegistry =
+                fsm::CallableRegistry<NarrowGuardBlackboard>();
+            auto&& loaded = fsm::Fsm<NarrowGuardBlackboard>::loadModel(
+                data, narrowRegistry);
+            NarrowGuardBlackboard bb;
+            for (size_t idx = 0; idx < CAPACITY; ++idx)
+                loaded.tick(bb);
+            REQUIRE(bb.__stateIdxs.size() == CAPACITY + 1u);
+        }
+    }
+
+    SECTION("Machine with more states than the index width allows is rejected")
+    {
+        auto&& definition = std::string("main\n");
+        for (size_t idx = 0; idx < 300u; ++idx)
+            definition += std::format(
+                "state S{}\n"
+                "exec nothing -> state S{}\n",
+                idx,
+                (idx + 1u) % 300u);
+
+        auto&& narrowRegistry =
+            fsm::CallableRegistry<NarrowGuardBlackboard>();
+        REQUIRE_THROWS_WITH(
+            fsm::DefinitionLoader<NarrowGuardBlackboard>::load(
+                definition, narrowRegistry)
+                .build(),
+            Catch::Matchers::ContainsSubstring("8-bit indices"));
+
+        if constexpr (PackedGuardBlackboard::PackedStateStack::INDEX_BITS > 8u)
+        {
+            auto&& registry = fsm::CallableRegistry<PackedGuardBlackboard>();
+            REQUIRE_NOTHROW(
+                fsm::DefinitionLoader<PackedGuardBlackboard>::load(
+                    definition, registry)
+                    .build());
+        }
+    }
+
+    SECTION("Async behaviors are rejected")
+    {
+        // clang-format off
+        auto&& builder = fsm::Builder<PackedGuardBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Watch")
+                    .execAsync(lookAround).andLoop()
+                .done();
+        // clang-format on
+
+        REQUIRE_THROWS_AS(builder.build(), fsm::Error);
+    }
+}
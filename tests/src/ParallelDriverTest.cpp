@@ -0,0 +1,107 @@
+#include "catch_amalgamated.hpp"
+#include <fsm/ByteBuilder.hpp>
+#include <fsm/ParallelDriver.hpp>
+#include <string>
+#include <vector>
+
+struct FieldBlackboard : fsm::ByteBlackboardBase
+{
+    std::vector<std::string> fields;
+};
+
+static void storeField(FieldBlackboard& bb, std::string_view field)
+{
+    bb.fields.emplace_back(field);
+}
+
+static std::vector<std::string>
+mergeFields(const std::vector<FieldBlackboard>& blackboards)
+{
+    auto&& result = std::vector<std::string> {};
+    for (auto&& bb : blackboards)
+        result.insert(result.end(), bb.fields.begin(), bb.fields.end());
+    return result;
+}
+
+TEST_CASE("[ParallelDriver]")
+{
+    // CSV with quoted fields that may contain separators. Whether
+    // a comma is a separator depends on the state, so a segment
+    // cannot be processed without knowing where the previous one ended.
+    // clang-format off
+    auto&& machine = fsm::ByteBuilder<FieldBlackboard>()
+        .withEntryState("Field")
+            .onAnyOf(",\n").exec(storeField).andLoop()
+            .on('"').goToState("Quoted")
+            .on('!').error()
+            .atEndOfInputExec(storeField)
+            .otherwiseConsume()
+        .withState("Quoted")
+            .on('"').goToState("Field")
+            .otherwiseConsume()
+        .build();
+    // clang-format on
+
+    auto&& input = std::string {};
+    for (unsigned i = 0; i < 50; ++i)
+        input += std::format(
+            "plain{},\"quoted, with {} commas, inside\",x\n", i, i);
+
+    auto&& expected = FieldBlackboard {};
+    machine.process(expected, input);
+    machine.finish(expected);
+
+    SECTION("Speculative run gives the same result as sequential run")
+    {
+        for (size_t threadCount : { 1u, 2u, 3u, 7u, 16u })
+        {
+            auto&& driver = fsm::ParallelDriver(machine, threadCount);
+            auto&& blackboards = driver.run(input, FieldBlackboard {});
+
+            REQUIRE(blackboards.size() == threadCount);
+            REQUIRE(mergeFields(blackboards) == expected.fields);
+        }
+    }
+
+    SECTION("Error stops processing of following segments")
+    {
+        input[input.find("plain", input.size() / 4)] = '!';
+
+        auto&& driver = fsm::ParallelDriver(machine, 4u);
+        auto&& blackboards = driver.run(input, FieldBlackboard {});
+
+        REQUIRE(machine.isErrored(blackboards.back()));
+        REQUIRE(blackboards.back().fields.empty());
+    }
+
+    SECTION("Exception thrown by an action is rethrown by the caller")
+    {
+        // clang-format off
+        auto&& throwing = fsm::ByteBuilder<FieldBlackboard>()
+            .withEntryState("Field")
+                .on('\n').exec(storeField).andLoop()
+                .on('#').exec([](FieldBlackboard&, std::string_view)
+                    { throw fsm::Error("Comment is not allowed"); })
+                    .andLoop()
+                .otherwiseConsume()
+            .build();
+        // clang-format on
+
+        input[input.find('\n', input.size() / 2)] = '#';
+
+        auto&& driver = fsm::ParallelDriver(throwing, 4u);
+        REQUIRE_THROWS_AS(driver.run(input, FieldBlackboard {}), fsm::Error);
+        REQUIRE_THROWS_AS(
+            driver.runWithSyncByte(input, '\n', {}), fsm::Error);
+    }
+
+    SECTION("Run with sync byte gives the same result as sequential run")
+    {
+        auto&& driver = fsm::ParallelDriver(machine, 5u);
+        auto&& blackboards = driver.runWithSyncByte(input, '\n', {});
+
+        REQUIRE(mergeFields(blackboards) == expected.fields);
+        for (size_t i = 0; i + 1 < blackboards.size(); ++i)
+            REQUIRE(blackboards[i].fields.back() == "x");
+    }
+}
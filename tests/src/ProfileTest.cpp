@@ -0,0 +1,286 @@
+#include "Blackboard.hpp"
+#include "CsvParser.hpp"
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <fsm/Profile.hpp>
+#include <fsm/detail/Layout.hpp>
+#include <fsm/logging/ProfilingLogger.hpp>
+#include <sstream>
+
+TEST_CASE("[Profile]")
+{
+    auto&& profile = fsm::Profile {};
+
+    SECTION("Can be saved and loaded")
+    {
+        profile.recordTick("__main__:Start");
+        profile.recordTick("__main__:Start");
+        profile.recordTick("Sub machine:State with spaces");
+        profile.recordTransition("__main__:Start", "__main__:End");
+
+        auto&& stream = std::stringstream();
+        profile.save(stream);
+        auto&& loaded = fsm::Profile::load(stream);
+
+        REQUIRE(loaded.getTickCounts() == profile.getTickCounts());
+        REQUIRE(loaded.getTransitionCounts() == profile.getTransitionCounts());
+        REQUIRE(loaded.getTickCount("__main__:Start") == 2u);
+        REQUIRE(loaded.getTickCount("Sub machine:State with spaces") == 1u);
+        REQUIRE(loaded.getTransitionCount("__main__:Start", "__main__:End")
+                == 1u);
+        REQUIRE(loaded.getTransitionCount("__main__:End", "__main__:Start")
+                == 0u);
+    }
+
+    SECTION("Throws on malformed input")
+    {
+        auto&& stream = std::stringstream("tick\t__main__:Start\tmany\n");
+        REQUIRE_THROWS_AS(fsm::Profile::load(stream), fsm::Error);
+    }
+
+    SECTION("Merges counts")
+    {
+        profile.recordTick("A");
+        auto&& other = fsm::Profile {};
+        other.recordTick("A");
+        other.recordTransition("A", "B");
+
+        profile.merge(other);
+
+        REQUIRE(profile.getTickCount("A") == 2u);
+        REQUIRE(profile.getTransitionCount("A", "B") == 1u);
+    }
+
+    SECTION("ProfilingLogger collects ticks and transitions")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<Blackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Start")
+                    .when(isEof).goToState("End")
+                    .otherwiseExec(advanceChar).andLoop()
+                .withState("End")
+                    .exec(nothing).andFinish()
+                .done()
+            .build();
+        // clang-format on
+
+        auto&& logger = fsm::ProfilingLogger();
+        machine.setLogger(logger);
+
+        Blackboard bb;
+        bb.data = "ab";
+        while (!machine.isFinished(bb))
+            machine.tick(bb);
+
+        const auto& collected = logger.getProfile();
+        REQUIRE(collected.getTickCount("__main__:Start") == 3u);
+        REQUIRE(collected.getTickCount("__main__:End") == 1u);
+        REQUIRE(
+            collected.getTransitionCount("__main__:Start", "__main__:Start")
+            == 2u);
+        REQUIRE(
+            collected.getTransitionCount("__main__:Start", "__main__:End")
+            == 1u);
+        REQUIRE(collected.getTransitionCounts().size() == 2u);
+    }
+
+    SECTION("Layout keeps entry and error block in place")
+    {
+        auto&& index = fsm::detail::StateIndex();
+        index.addNameToIndex("__main__:Start");
+        index.addNameToIndex("__error__:A");
+        index.addNameToIndex("__error__:B");
+        index.addNameToIndex("M:W");
+        index.addNameToIndex("M:X");
+        index.addNameToIndex("M:Y");
+        index.addNameToIndex("M:Z");
+
+        profile.recordTick("__error__:B");
+        for (unsigned i = 0; i < 10; ++i)
+        {
+            profile.recordTick("M:Z");
+            profile.recordTick("M:Z");
+            profile.recordTick("M:W");
+            profile.recordTransition("M:Z", "M:X");
+            profile.recordTransition("__main__:Start", "M:Z");
+        }
+        profile.recordTransition("M:Z", "M:W");
+
+        auto&& names =
+            fsm::detail::reorderStateIndexByProfile(index, 2u, profile)
+                .getIndexedStateNames();
+
+        REQUIRE(
+            names
+            == std::vector<std::string> { "__main__:Start",
+                                          "__error__:B",
+                                          "__error__:A",
+                                          "M:Z",
+                                          "M:X",
+                                          "M:W",
+                                          "M:Y" });
+    }
+
+    SECTION("FSM built with profile behaves the same")
+    {
+        auto&& build = [](const fsm::Profile* layout)
+        {
+            // clang-format off
+            auto&& builder = fsm::Builder<Blackboard>()
+                .withErrorMachine()
+                    .noGlobalEntryCondition()
+                    .withEntryState("Start")
+                        .exec(nothing).andLoop()
+                    .done()
+                .withMainMachine()
+                    .withEntryState("Start")
+                        .exec(startLine).andGoToState("A")
+                    .withState("A")
+                        .when(isEof).goToState("Z")
+                        .orWhen(isExclamationMark).error()
+                        .otherwiseExec(advanceChar).andLoop()
+                    .withState("Z")
+                        .exec(storeWord).andFinish()
+                    .done();
+            // clang-format on
+
+            if (layout) builder.withProfile(*layout);
+            return builder.build();
+        };
+
+        profile.recordTick("__main__:Z");
+        profile.recordTick("__main__:Z");
+        profile.recordTick("__main__:A");
+
+        auto&& reference = build(nullptr);
+        auto&& optimized = build(&profile);
+
+        Blackboard bb1, bb2;
+        bb1.data = bb2.data = "word";
+        while (!reference.isFinished(bb1))
+        {
+            reference.tick(bb1);
+            optimized.tick(bb2);
+        }
+
+        REQUIRE(optimized.isFinished(bb2));
+        REQUIRE(bb1.csv == bb2.csv);
+
+        // Error states must still be recognized after the renumbering
+        bb2 = Blackboard {};
+        bb2.data = "!";
+        optimized.tick(bb2);
+        optimized.tick(bb2);
+        REQUIRE(optimized.isErrored(bb2));
+    }
+
+    SECTION("Exclusive conditions are reordered by hit count")
+    {
+        size_t evaluations = 0;
+        auto&& isChar = [&evaluations](char c)
+        {
+            return [&evaluations, c](const Blackboard& bb)
+            {
+                ++evaluations;
+                return bb.data[bb.charIdx] == c;
+            };
+        };
+
+        for (unsigned i = 0; i < 5; ++i)
+            profile.recordConditionHit("__main__:Dispatch", 2u);
+        profile.recordConditionHit("__main__:Dispatch", 1u);
+
+        auto&& logger = TestableLogger();
+        Blackboard bb;
+        bb.data = "c";
+        bb.__stateIdxs = { 1u }; // Dispatch
+
+        SECTION("Not exclusive")
+        {
+            // clang-format off
+            auto&& machine = fsm::Builder<Blackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                    .withEntryState("Start")
+                        .exec(nothing).andGoToState("Dispatch")
+                    .withState("Dispatch")
+                        .when(isChar('a')).goToState("Start")
+                        .orWhen(isChar('b')).goToState("Start")
+                        .orWhen(isChar('c')).goToState("Start")
+                        .otherwiseExec(advanceChar).andLoop()
+                    .done()
+                .withProfile(profile)
+                .build();
+            // clang-format on
+
+            machine.setLogger(logger);
+            machine.tick(bb);
+            REQUIRE(evaluations == 3u);
+        }
+
+        SECTION("Exclusive")
+        {
+            // clang-format off
+            auto&& machine = fsm::Builder<Blackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                    .withEntryState("Start")
+                        .exec(nothing).andGoToState("Dispatch")
+                    .withState("Dispatch")
+                        .withMutuallyExclusiveConditions()
+                        .when(isChar('a')).goToState("Start")
+                        .orWhen(isChar('b')).goToState("Start")
+                        .orWhen(isChar('c')).goToState("Start")
+                        .otherwiseExec(advanceChar).andLoop()
+                    .done()
+                .withProfile(profile)
+                .build();
+            // clang-format on
+
+            machine.setLogger(logger);
+            machine.tick(bb);
+            REQUIRE(evaluations == 1u);
+        }
+
+        REQUIRE(logger.lastLogMessage == "Condition 2 hit");
+        REQUIRE(logger.lastLogTargetState == "__main__:Start");
+    }
+
+    SECTION("ProfilingLogger records condition hits by declaration index")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<Blackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Start")
+                    .when(isEof).finish()
+                    .orWhen(isExclamationMark).goToState("Bang")
+                    .otherwiseExec(advanceChar).andLoop()
+                .withState("Bang")
+                    .exec(advanceChar).andGoToState("Start")
+                .done()
+            .build();
+        // clang-format on
+
+        auto&& logger = fsm::ProfilingLogger();
+        machine.setLogger(logger);
+
+        Blackboard bb;
+        bb.data = "!a!";
+        while (!machine.isFinished(bb))
+            machine.tick(bb);
+
+        const auto& collected = logger.getProfile();
+        REQUIRE(collected.getConditionHitCount("__main__:Start", 0u) == 1u);
+        REQUIRE(collected.getConditionHitCount("__main__:Start", 1u) == 2u);
+
+        auto&& stream = std::stringstream();
+        collected.save(stream);
+        REQUIRE(
+            fsm::Profile::load(stream).getConditionHitCounts()
+            == collected.getConditionHitCounts());
+    }
+}
@@ -0,0 +1,160 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <sstream>
+
+struct ScoutBlackboard : fsm::BlackboardBase
+{
+    bool threatened = false;
+    bool cornered = false;
+    size_t steps = 0;
+    size_t hides = 0;
+};
+
+static bool isThreatened(const ScoutBlackboard& bb)
+{
+    return bb.threatened;
+}
+
+static bool isSafe(const ScoutBlackboard& bb)
+{
+    return !bb.threatened;
+}
+
+static bool isCornered(const ScoutBlackboard& bb)
+{
+    return bb.cornered;
+}
+
+static void step(ScoutBlackboard& bb)
+{
+    ++bb.steps;
+}
+
+static void hide(ScoutBlackboard& bb)
+{
+    ++bb.hides;
+}
+
+TEST_CASE("[SharedSubmachine]")
+{
+    auto&& logger = TestableLogger();
+
+    // clang-format off
+    auto&& flee = fsm::Builder<ScoutBlackboard>()
+        .withNoErrorMachine()
+        .withMainMachine()
+            .interruptWhen(isCornered).goToState("Hide")
+            .withEntryState("Run")
+                .when(isSafe).finish()
+                .otherwiseExec(step).andLoop()
+            .withState("Hide")
+                .exec(hide).andFinish()
+            .done()
+        .buildSubmachine();
+
+    auto&& scout = fsm::Builder<ScoutBlackboard>()
+        .withNoErrorMachine()
+        .withSharedSubmachine("Flee", flee)
+        .withMainMachine()
+            .withEntryState("Explore")
+                .when(isThreatened).goToMachine("Flee").thenGoToState("Rest")
+                .otherwiseExec(step).andLoop()
+            .withState("Rest")
+                .exec(fsm::doNothing).andGoToState("Explore")
+            .done()
+        .build();
+
+    auto&& sentry = fsm::Builder<ScoutBlackboard>()
+        .withNoErrorMachine()
+        .withSubmachine("Alert")
+            .withEntryState("Shout")
+                .exec(fsm::doNothing).andFinish()
+            .done()
+        .withSharedSubmachine("Escape", flee)
+        .withMainMachine()
+            .withEntryState("Watch")
+                .when(isThreatened).goToMachine("Escape").thenGoToState("Report")
+                .otherwiseExec(fsm::doNothing).andLoop()
+            .withState("Report")
+                .exec(fsm::doNothing).andGoToState("Watch")
+            .withState("Idle")
+                .exec(fsm::doNothing).andGoToState("Watch")
+            .done()
+        .build();
+    // clang-format on
+
+    scout.setLogger(logger);
+    sentry.setLogger(logger);
+
+    SECTION("Models refer to the same submachine")
+    {
+        REQUIRE(flee.use_count() == 3);
+    }
+
+    SECTION("Shared states are entered and left in each model")
+    {
+        ScoutBlackboard bb;
+        bb.threatened = true;
+        scout.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "Flee:Run");
+
+        scout.tick(bb);
+        REQUIRE(bb.steps == 1u);
+        REQUIRE(logger.lastLogTargetState == "Flee:Run");
+
+        bb.threatened = false;
+        scout.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "__main__:Rest");
+
+        ScoutBlackboard sentryBb;
+        sentryBb.threatened = true;
+        sentry.tick(sentryBb);
+        REQUIRE(logger.lastLogTargetState == "Escape:Run");
+
+        sentryBb.threatened = false;
+        sentry.tick(sentryBb);
+        REQUIRE(logger.lastLogTargetState == "__main__:Report");
+    }
+
+    SECTION("Interrupt of the shared submachine is relocated")
+    {
+        ScoutBlackboard bb;
+        bb.threatened = true;
+        sentry.tick(bb);
+
+        bb.cornered = true;
+        sentry.tick(bb);
+        REQUIRE(logger.lastLogTargetState == "Escape:Hide");
+
+        bb.cornered = false;
+        sentry.tick(bb);
+        REQUIRE(bb.hides == 1u);
+        REQUIRE(logger.lastLogTargetState == "__main__:Report");
+    }
+
+    SECTION("Model with a shared submachine cannot be saved")
+    {
+        auto&& sink = std::ostringstream();
+        REQUIRE_THROWS_AS(scout.saveModel(sink), fsm::Error);
+    }
+
+    SECTION("Submachine can only be built from the main machine")
+    {
+        // clang-format off
+        REQUIRE_THROWS_AS(
+            fsm::Builder<ScoutBlackboard>()
+                .withNoErrorMachine()
+                .withSubmachine("Other")
+                    .withEntryState("A")
+                        .exec(step).andFinish()
+                    .done()
+                .withMainMachine()
+                    .withEntryState("B")
+                        .exec(step).andLoop()
+                    .done()
+                .buildSubmachine(),
+            fsm::Error);
+        // clang-format on
+    }
+}
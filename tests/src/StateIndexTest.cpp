@@ -1,5 +1,7 @@
 #include "catch_amalgamated.hpp"
+#include <cstdint>
 #include <fsm/detail/StateIndex.hpp>
+#include <string>
 
 TEST_CASE("[StateIndex]")
 {
@@ -17,6 +19,16 @@ TEST_CASE("[StateIndex]")
         REQUIRE_THROWS(index.addNameToIndex("name"));
     }
 
+    SECTION("Throws exception when state index width is exceeded")
+    {
+        if constexpr (sizeof(fsm::StateIdx) <= sizeof(std::uint16_t))
+        {
+            for (size_t idx = 0; idx < fsm::NO_STATE_IDX; ++idx)
+                index.addNameToIndex(std::to_string(idx));
+            REQUIRE_THROWS_AS(index.addNameToIndex("overflow"), fsm::Error);
+        }
+    }
+
     SECTION("Returns indices according to order of insertion")
     {
         index.addNameToIndex("helo");
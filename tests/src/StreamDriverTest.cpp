@@ -0,0 +1,94 @@
+#include "catch_amalgamated.hpp"
+#include <filesystem>
+#include <fsm/ByteBuilder.hpp>
+#include <fsm/StreamDriver.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+struct WordBlackboard : fsm::ByteBlackboardBase
+{
+    std::vector<std::string> words;
+};
+
+static void storeWord(WordBlackboard& bb, std::string_view word)
+{
+    bb.words.emplace_back(word);
+}
+
+TEST_CASE("[StreamDriver]")
+{
+    // clang-format off
+    auto&& machine = fsm::ByteBuilder<WordBlackboard>()
+        .withEntryState("Word")
+            .onAnyOf(" \n").exec(storeWord).andLoop()
+            .on('!').error()
+            .atEndOfInputExec(storeWord)
+            .otherwiseConsume()
+        .build();
+    // clang-format on
+
+    const auto input = std::string("lorem ipsum dolor\nsit amet consectetur");
+    const auto expectedWords = std::vector<std::string> {
+        "lorem", "ipsum", "dolor", "sit", "amet", "consectetur"
+    };
+
+    WordBlackboard bb;
+
+    SECTION("Carries tokens over chunk boundaries of a stream")
+    {
+        auto&& stream = std::istringstream(input);
+        auto&& driver = fsm::StreamDriver(machine, 4u);
+
+        REQUIRE(driver.run(bb, stream) == input.size());
+        REQUIRE(bb.words == expectedWords);
+        REQUIRE(bb.__pendingToken.empty());
+    }
+
+    SECTION("Stops reading on error")
+    {
+        auto&& stream = std::istringstream("ab cd!ef gh");
+        auto&& driver = fsm::StreamDriver(machine, 2u);
+
+        REQUIRE(driver.run(bb, stream) == 6u);
+        REQUIRE(machine.isErrored(bb));
+        REQUIRE(bb.words == std::vector<std::string> { "ab" });
+    }
+
+    SECTION("Processes in-memory input")
+    {
+        auto&& driver = fsm::StreamDriver(machine);
+
+        REQUIRE(driver.run(bb, std::span(input)) == input.size());
+        REQUIRE(bb.words == expectedWords);
+    }
+
+#ifndef _WIN32
+    SECTION("Reads from file descriptor")
+    {
+        const auto path =
+            std::filesystem::temp_directory_path() / "fsm-stream-test.txt";
+        {
+            auto&& save = std::ofstream(path, std::ios::binary);
+            save << input;
+        }
+
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        REQUIRE(fd >= 0);
+
+        auto&& driver = fsm::StreamDriver(machine, 5u);
+        const auto consumed = driver.runFromFileDescriptor(bb, fd);
+        ::close(fd);
+        std::filesystem::remove(path);
+
+        REQUIRE(consumed == input.size());
+        REQUIRE(bb.words == expectedWords);
+    }
+#endif
+}
@@ -0,0 +1,150 @@
+#include "TestableLogger.hpp"
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <limits>
+
+enum class Stimulus
+{
+    None,
+    Noise,
+    Sight,
+    Touch,
+};
+
+struct StimulusBlackboard : fsm::BlackboardBase
+{
+    Stimulus stimulus = Stimulus::None;
+    int priority = 0;
+    size_t idleTicks = 0;
+};
+
+static void idle(StimulusBlackboard& bb)
+{
+    ++bb.idleTicks;
+}
+
+TEST_CASE("[Switch]")
+{
+    auto&& logger = TestableLogger();
+    StimulusBlackboard bb;
+
+    SECTION("Dispatches on enum field")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<StimulusBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Idle")
+                    .switchOn(&StimulusBlackboard::stimulus)
+                    .caseOf(Stimulus::Noise).goToState("Investigate")
+                    .caseOf(Stimulus::Touch).goToState("Flee")
+                    .orWhen([](const StimulusBlackboard& bb)
+                        { return bb.stimulus == Stimulus::Sight; })
+                        .goToState("Attack")
+                    .otherwiseExec(idle).andLoop()
+                .withState("Investigate")
+                    .exec(idle).andGoToState("Idle")
+                .withState("Flee")
+                    .exec(idle).andGoToState("Idle")
+                .withState("Attack")
+                    .exec(idle).andGoToState("Idle")
+                .done()
+            .build();
+        // clang-format on
+
+        machine.setLogger(logger);
+
+        machine.tick(bb);
+        REQUIRE(bb.idleTicks == 1u);
+
+        bb.stimulus = Stimulus::Touch;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Condition 1 hit");
+        REQUIRE(logger.lastLogTargetState == "__main__:Flee");
+
+        machine.tick(bb);
+        bb.stimulus = Stimulus::Noise;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Condition 0 hit");
+        REQUIRE(logger.lastLogTargetState == "__main__:Investigate");
+
+        machine.tick(bb);
+        bb.stimulus = Stimulus::Sight;
+        machine.tick(bb);
+        REQUIRE(logger.lastLogMessage == "Condition 2 hit");
+        REQUIRE(logger.lastLogTargetState == "__main__:Attack");
+    }
+
+    SECTION("Values outside of the table are not matched")
+    {
+        // clang-format off
+        auto&& machine = fsm::Builder<StimulusBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Idle")
+                    .switchOn(&StimulusBlackboard::priority)
+                    .caseOf(-1).finish()
+                    .caseOf(2).finish()
+                    .otherwiseExec(idle).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        for (int priority : { -2, 0, 1, 3, std::numeric_limits<int>::min() })
+        {
+            bb.priority = priority;
+            machine.tick(bb);
+        }
+        REQUIRE(bb.idleTicks == 5u);
+
+        bb.priority = -1;
+        machine.tick(bb);
+        REQUIRE(machine.isFinished(bb));
+    }
+
+    SECTION("Throws when case does not follow switchOn")
+    {
+        REQUIRE_THROWS_AS(
+            fsm::Builder<StimulusBlackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                .withEntryState("Idle")
+                .when([](const StimulusBlackboard&) { return false; })
+                .finish()
+                .caseOf(Stimulus::Noise),
+            fsm::Error);
+    }
+
+    SECTION("Throws on duplicate case")
+    {
+        REQUIRE_THROWS_AS(
+            fsm::Builder<StimulusBlackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                .withEntryState("Idle")
+                .switchOn(&StimulusBlackboard::stimulus)
+                .caseOf(Stimulus::Noise)
+                .finish()
+                .caseOf(Stimulus::Noise),
+            fsm::Error);
+    }
+
+    SECTION("Throws when cases span too many values")
+    {
+        REQUIRE_THROWS_AS(
+            fsm::Builder<StimulusBlackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                .withEntryState("Idle")
+                .switchOn(&StimulusBlackboard::priority)
+                .caseOf(0)
+                .finish()
+                .caseOf(1'000'000)
+                .finish()
+                .otherwiseExec(idle)
+                .andLoop()
+                .done()
+                .build(),
+            fsm::Error);
+    }
+}
@@ -0,0 +1,150 @@
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <fsm/TickContext.hpp>
+#include <vector>
+
+struct FarmhandBlackboard : fsm::BlackboardBase
+{
+    int energy = 10;
+    int harvested = 0;
+    int slept = 0;
+};
+
+struct Village
+{
+    bool isRaining = false;
+    bool isNight = false;
+    int cropsPerHour = 0;
+};
+
+static bool
+isRainingOrTired(const FarmhandBlackboard& bb, const Village& world)
+{
+    return world.isRaining || bb.energy <= 0;
+}
+
+static void harvest(FarmhandBlackboard& bb, const Village& world)
+{
+    bb.harvested += world.cropsPerHour;
+    --bb.energy;
+}
+
+static void nap(FarmhandBlackboard& bb)
+{
+    ++bb.slept;
+}
+
+static bool isNight(const Village& world)
+{
+    return world.isNight;
+}
+
+TEST_CASE("[TickContext]")
+{
+    // clang-format off
+    auto&& machine = fsm::Builder<FarmhandBlackboard>()
+        .withNoErrorMachine()
+        .withSubmachine("Night")
+            .withEntryState("Sleep")
+                .exec(nap).andFinish()
+            .done()
+        .withMainMachine()
+            .withEntryState("Harvest")
+                .when(fsm::withContext<Village>(isRainingOrTired))
+                    .goToState("Rest")
+                .otherwiseExec(fsm::withContext<Village>(harvest)).andLoop()
+            .withState("Rest")
+                .exec(fsm::doNothing).andGoToState("Harvest")
+            .done()
+        .withWorldInterrupt(fsm::withContext<Village>(isNight))
+            .goToMachine("Night").thenRestart()
+        .build();
+    // clang-format on
+
+    auto&& world = Village { .cropsPerHour = 3 };
+
+    SECTION("Conditions and actions receive the context of the tick")
+    {
+        FarmhandBlackboard bb;
+        machine.tick(bb, world);
+        REQUIRE(bb.harvested == 3);
+
+        world.cropsPerHour = 5;
+        machine.tick(bb, world);
+        REQUIRE(bb.harvested == 8);
+
+        world.isRaining = true;
+        machine.tick(bb, world);
+        REQUIRE(bb.harvested == 8);
+        REQUIRE(bb.__stateIdxs.back() != 0u);
+    }
+
+    SECTION("Batch shares one context")
+    {
+        auto&& agents = std::vector<FarmhandBlackboard>(3);
+        agents[1].energy = 0;
+
+        REQUIRE(machine.tickAll(agents, world) == 3u);
+        REQUIRE(agents[0].harvested == 3);
+        REQUIRE(agents[1].harvested == 0);
+        REQUIRE(agents[2].harvested == 3);
+
+        auto&& cursor = fsm::BatchCursor {};
+        world.isNight = true;
+        REQUIRE(
+            machine.tickWithBudget(
+                agents, std::chrono::seconds(1), cursor, world)
+            == 3u);
+        REQUIRE(agents[0].__stateIdxs.size() == 2u);
+    }
+
+    SECTION("Tick without the required context throws")
+    {
+        FarmhandBlackboard bb;
+        REQUIRE_THROWS_AS(machine.tick(bb), fsm::Error);
+
+        auto&& agents = std::vector<FarmhandBlackboard>(2);
+        REQUIRE_THROWS_AS(machine.tickAll(agents, 42), fsm::Error);
+        REQUIRE(agents[0].harvested == 0);
+    }
+
+    SECTION("Blackboard is left intact by a tick without the context")
+    {
+        FarmhandBlackboard bb;
+        machine.tick(bb, world);
+        const auto stateIdxs = bb.__stateIdxs;
+
+        REQUIRE_THROWS_AS(machine.tick(bb), fsm::Error);
+        REQUIRE(bb.__stateIdxs == stateIdxs);
+
+        machine.tick(bb, world);
+        REQUIRE(bb.harvested == 6);
+        REQUIRE(bb.__stateIdxs == stateIdxs);
+    }
+
+    SECTION("Nested tick restores the outer context")
+    {
+        auto&& other = Village { .cropsPerHour = 7 };
+        FarmhandBlackboard outerBb;
+        FarmhandBlackboard innerBb;
+
+        // clang-format off
+        auto&& outer = fsm::Builder<FarmhandBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Delegate")
+                    .exec(fsm::withContext<Village>(
+                        [&](FarmhandBlackboard& bb, const Village& context)
+                        {
+                            machine.tick(innerBb, other);
+                            harvest(bb, context);
+                        })).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        outer.tick(outerBb, world);
+        REQUIRE(innerBb.harvested == 7);
+        REQUIRE(outerBb.harvested == 3);
+    }
+}
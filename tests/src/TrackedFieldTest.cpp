@@ -0,0 +1,106 @@
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <fsm/TrackedField.hpp>
+
+struct SoldierBlackboard
+    : fsm::BlackboardBase
+    , fsm::TrackedBlackboard
+{
+    fsm::TrackedField<int, 1u << 0> health = 100;
+    fsm::TrackedField<bool, 1u << 1> enemyVisible = false;
+    size_t healthChecks = 0;
+    size_t enemyChecks = 0;
+    size_t untrackedChecks = 0;
+};
+
+static bool isWounded(const SoldierBlackboard& bb)
+{
+    ++const_cast<SoldierBlackboard&>(bb).healthChecks;
+    return bb.health < 50;
+}
+
+static bool isEnemyVisible(const SoldierBlackboard& bb)
+{
+    ++const_cast<SoldierBlackboard&>(bb).enemyChecks;
+    return bb.enemyVisible;
+}
+
+static bool isNever(const SoldierBlackboard& bb)
+{
+    ++const_cast<SoldierBlackboard&>(bb).untrackedChecks;
+    return false;
+}
+
+static void idle(SoldierBlackboard&) {}
+
+TEST_CASE("[TrackedField]")
+{
+    // clang-format off
+    auto&& machine = fsm::Builder<SoldierBlackboard>()
+        .withNoErrorMachine()
+        .withMainMachine()
+            .withEntryState("Patrol")
+                .when(isWounded, decltype(SoldierBlackboard::health)::MASK)
+                    .goToState("Retreat")
+                .orWhen(
+                    isEnemyVisible,
+                    decltype(SoldierBlackboard::enemyVisible)::MASK)
+                    .goToState("Attack")
+                .orWhen(isNever).goToState("Attack")
+                .otherwiseExec(idle).andLoop()
+            .withState("Retreat")
+                .exec(idle).andLoop()
+            .withState("Attack")
+                .exec(idle).andGoToState("Patrol")
+            .done()
+        .build();
+    // clang-format on
+
+    SoldierBlackboard bb;
+
+    SECTION("Conditions with clean dependencies are not re-evaluated")
+    {
+        for (size_t i = 0; i < 10; ++i)
+            machine.tick(bb);
+
+        REQUIRE(bb.healthChecks == 1u);
+        REQUIRE(bb.enemyChecks == 1u);
+        REQUIRE(bb.untrackedChecks == 10u);
+    }
+
+    SECTION("Writing a field re-evaluates conditions depending on it")
+    {
+        machine.tick(bb);
+
+        bb.health.set(bb, 80);
+        machine.tick(bb);
+        REQUIRE(bb.healthChecks == 2u);
+        REQUIRE(bb.enemyChecks == 1u);
+        REQUIRE(bb.__stateIdxs.back() == 0u);
+
+        // Writing the same value does not mark the field dirty
+        bb.health.set(bb, 80);
+        machine.tick(bb);
+        REQUIRE(bb.healthChecks == 2u);
+
+        bb.health.modify(bb) -= 40;
+        machine.tick(bb);
+        REQUIRE(bb.healthChecks == 3u);
+        REQUIRE(bb.__stateIdxs.back() != 0u);
+    }
+
+    SECTION("Re-entered state evaluates all conditions")
+    {
+        machine.tick(bb);
+
+        bb.enemyVisible.set(bb, true);
+        machine.tick(bb);
+        REQUIRE(bb.enemyChecks == 2u);
+
+        bb.enemyVisible.set(bb, false);
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(bb.healthChecks == 2u);
+        REQUIRE(bb.enemyChecks == 3u);
+    }
+}
@@ -0,0 +1,177 @@
+#include "catch_amalgamated.hpp"
+#include <fsm/Builder.hpp>
+#include <type_traits>
+#include <vector>
+
+struct GateBlackboard
+    : fsm::BlackboardBase
+    , fsm::TrackedBlackboard
+{
+    static constexpr fsm::FieldMask DOOR = 1u << 0;
+    static constexpr fsm::FieldMask NOISE = 1u << 1;
+
+    bool doorOpen = false;
+    bool noise = false;
+    size_t doorChecks = 0;
+    size_t passes = 0;
+};
+
+// Without fsm::TrackedBlackboard, the condition is polled on every tick
+struct PollingGateBlackboard : fsm::BlackboardBase
+{
+    bool doorOpen = false;
+    size_t doorChecks = 0;
+};
+
+static_assert(std::is_empty_v<fsm::detail::BlackboardCore>);
+
+template<class BbT>
+static bool isDoorOpen(const BbT& bb)
+{
+    ++const_cast<BbT&>(bb).doorChecks;
+    return bb.doorOpen;
+}
+
+static void pass(GateBlackboard& bb)
+{
+    ++bb.passes;
+}
+
+template<class BbT>
+static void idle(BbT&)
+{
+}
+
+TEST_CASE("[WaitUntil]")
+{
+    // clang-format off
+    auto&& machine = fsm::Builder<GateBlackboard>()
+        .withNoErrorMachine()
+        .withMainMachine()
+            .withEntryState("Gate")
+                .waitUntil(isDoorOpen<GateBlackboard>, GateBlackboard::DOOR)
+                .exec(pass).andGoToState("Inside")
+            .withState("Inside")
+                .exec(idle<GateBlackboard>).andLoop()
+            .done()
+        .build();
+    // clang-format on
+
+    SECTION("Condition is only re-checked after its dependency is dirty")
+    {
+        GateBlackboard bb;
+
+        machine.tick(bb);
+        machine.tick(bb);
+        REQUIRE(bb.doorChecks == 1u);
+        REQUIRE(bb.__stateIdxs.back() == 0u);
+
+        bb.noise = true;
+        fsm::markDirty(bb, GateBlackboard::NOISE);
+        machine.tick(bb);
+        REQUIRE(bb.doorChecks == 1u);
+
+        fsm::markDirty(bb, GateBlackboard::DOOR);
+        machine.tick(bb);
+        REQUIRE(bb.doorChecks == 2u);
+        REQUIRE(bb.passes == 0u);
+
+        bb.doorOpen = true;
+        fsm::markDirty(bb, GateBlackboard::DOOR);
+        machine.tick(bb);
+        REQUIRE(bb.doorChecks == 3u);
+        REQUIRE(bb.passes == 1u);
+        REQUIRE(bb.__stateIdxs.back() != 0u);
+    }
+
+    SECTION("tickAll skips clean waiting agents")
+    {
+        auto&& agents = std::vector<GateBlackboard>(4);
+        agents[1].doorOpen = true;
+
+        REQUIRE(machine.tickAll(agents) == 4u);
+        REQUIRE(machine.tickAll(agents) == 1u);
+
+        agents[2].doorOpen = true;
+        fsm::markDirty(agents[2], GateBlackboard::DOOR);
+        REQUIRE(machine.tickAll(agents) == 2u);
+        REQUIRE(agents[2].passes == 1u);
+        REQUIRE(agents[0].doorChecks == 1u);
+    }
+
+    SECTION("Interrupt preempts a waiting agent")
+    {
+        // clang-format off
+        auto&& interruptible = fsm::Builder<GateBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .interruptWhen([](const GateBlackboard& bb) { return bb.noise; })
+                    .goToState("Inside")
+                .withEntryState("Gate")
+                    .waitUntil(isDoorOpen<GateBlackboard>, GateBlackboard::DOOR)
+                    .exec(pass).andGoToState("Inside")
+                .withState("Inside")
+                    .exec(idle<GateBlackboard>).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        auto&& agents = std::vector<GateBlackboard>(2);
+        REQUIRE(interruptible.tickAll(agents) == 2u);
+        REQUIRE(interruptible.tickAll(agents) == 2u);
+        REQUIRE(agents[0].doorChecks == 1u);
+
+        agents[0].noise = true;
+        interruptible.tickAll(agents);
+        REQUIRE(agents[0].__stateIdxs.back() != 0u);
+        REQUIRE(agents[0].__waitedFields == 0u);
+        REQUIRE(agents[1].__stateIdxs.back() == 0u);
+        REQUIRE(agents[1].doorChecks == 1u);
+    }
+
+    SECTION("Untracked blackboard re-checks the condition on every tick")
+    {
+        // clang-format off
+        auto&& polling = fsm::Builder<PollingGateBlackboard>()
+            .withNoErrorMachine()
+            .withMainMachine()
+                .withEntryState("Gate")
+                    .waitUntil(isDoorOpen<PollingGateBlackboard>, 1u)
+                    .exec(idle<PollingGateBlackboard>).andGoToState("Inside")
+                .withState("Inside")
+                    .exec(idle<PollingGateBlackboard>).andLoop()
+                .done()
+            .build();
+        // clang-format on
+
+        PollingGateBlackboard bb;
+        polling.tick(bb);
+        polling.tick(bb);
+        REQUIRE(bb.doorChecks == 2u);
+        REQUIRE(bb.__stateIdxs.back() == 0u);
+
+        bb.doorOpen = true;
+        polling.tick(bb);
+        REQUIRE(bb.doorChecks == 3u);
+        REQUIRE(bb.__stateIdxs.back() != 0u);
+    }
+
+    SECTION("Waiting without dependencies is rejected")
+    {
+        auto&& build = []
+        {
+            // clang-format off
+            return fsm::Builder<GateBlackboard>()
+                .withNoErrorMachine()
+                .withMainMachine()
+                    .withEntryState("Gate")
+                        .waitUntil(isDoorOpen<GateBlackboard>, 0)
+                        .exec(idle<GateBlackboard>).andLoop()
+                    .done()
+                .build();
+            // clang-format on
+        };
+
+        REQUIRE_THROWS_AS(build(), fsm::Error);
+    }
+}